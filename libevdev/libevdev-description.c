@@ -0,0 +1,811 @@
+/*
+ * Copyright © 2026 The libevdev contributors
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided that
+ * the above copyright notice appear in all copies and that both that copyright
+ * notice and this permission notice appear in supporting documentation, and
+ * that the name of the copyright holders not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  The copyright holders make no representations
+ * about the suitability of this software for any purpose.  It is provided "as
+ * is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN NO
+ * EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+ * TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE
+ * OF THIS SOFTWARE.
+ */
+
+#include <config.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libevdev.h"
+#include "libevdev-int.h"
+#include "libevdev-util.h"
+
+/*
+ * Binary format: a header followed by a sequence of records. All integers
+ * are little-endian.
+ *
+ * header: "LEVD" u8 version, u8[3] reserved
+ * record: u8 tag, u8 reserved, u16 length, u8[length] payload
+ *
+ * Readers skip records with an unknown tag. Bitmaps are stored one bit per
+ * code, code N is bit N % 8 of byte N / 8, trailing zero bytes are omitted.
+ */
+#define BINARY_MAGIC "LEVD"
+#define BINARY_VERSION 1
+#define BINARY_HEADER_SIZE 8
+#define RECORD_HEADER_SIZE 4
+
+enum record_tag {
+	TAG_NAME = 1,		/* string, no terminating null byte */
+	TAG_PHYS,		/* string */
+	TAG_UNIQ,		/* string */
+	TAG_ID,			/* u16 bustype, vendor, product, version */
+	TAG_DRIVER_VERSION,	/* u32 */
+	TAG_PROPS,		/* bitmap */
+	TAG_BITS,		/* u8 type (0 for the types), bitmap */
+	TAG_ABSINFO,		/* u16 code, s32 value, min, max, fuzz, flat, resolution */
+	TAG_REP,		/* s32 delay, period */
+};
+
+/* sanity limit on the number of slots, ABS_MT_SLOT comes from the
+ * caller and determines an allocation */
+#define MAX_SLOTS 1024
+
+#define TEXT_HEADER "# libevdev device description"
+#define TEXT_VERSION 1
+
+struct writer {
+	char *buf;
+	size_t len;
+	size_t pos;
+};
+
+static void
+put(struct writer *w, const void *data, size_t n)
+{
+	if (w->pos + n <= w->len)
+		memcpy(w->buf + w->pos, data, n);
+	w->pos += n;
+}
+
+static void
+put_u8(struct writer *w, uint8_t v)
+{
+	put(w, &v, 1);
+}
+
+static void
+put_u16(struct writer *w, uint16_t v)
+{
+	uint8_t b[2] = { v & 0xff, v >> 8 };
+
+	put(w, b, sizeof(b));
+}
+
+static void
+put_u32(struct writer *w, uint32_t v)
+{
+	uint8_t b[4] = { v & 0xff, (v >> 8) & 0xff, (v >> 16) & 0xff, v >> 24 };
+
+	put(w, b, sizeof(b));
+}
+
+static void
+put_record_header(struct writer *w, enum record_tag tag, size_t length)
+{
+	put_u8(w, tag);
+	put_u8(w, 0);
+	put_u16(w, length);
+}
+
+static void LIBEVDEV_ATTRIBUTE_PRINTF(2, 3)
+put_text(struct writer *w, const char *format, ...)
+{
+	va_list args;
+	size_t avail = w->pos < w->len ? w->len - w->pos : 0;
+	int n;
+
+	va_start(args, format);
+	n = vsnprintf(avail ? w->buf + w->pos : NULL, avail, format, args);
+	va_end(args);
+
+	if (n > 0)
+		w->pos += n;
+}
+
+static void
+describe(const struct libevdev *dev, struct device_description *desc)
+{
+	const char *str;
+	unsigned int code;
+
+	memset(desc, 0, sizeof(*desc));
+
+	if ((str = libevdev_get_name(dev)))
+		snprintf(desc->name, sizeof(desc->name), "%s", str);
+	if ((str = libevdev_get_phys(dev))) {
+		snprintf(desc->phys, sizeof(desc->phys), "%s", str);
+		desc->has_phys = true;
+	}
+	if ((str = libevdev_get_uniq(dev))) {
+		snprintf(desc->uniq, sizeof(desc->uniq), "%s", str);
+		desc->has_uniq = true;
+	}
+
+	desc->ids = dev->ids;
+	desc->driver_version = dev->driver_version;
+	desc->caps = *dev->caps;
+
+	for (code = 0; code < ABS_CNT; code++) {
+		const struct input_absinfo *abs = libevdev_get_abs_info(dev, code);
+		if (abs)
+			desc->abs_info[code] = *abs;
+	}
+
+	memcpy(desc->rep_values, dev->rep_values, sizeof(desc->rep_values));
+}
+
+/**
+ * @return the number of bytes needed to store the bits up to max
+ * without trailing zero bytes
+ */
+static size_t
+bitmap_bytes(const unsigned long *bits, int max)
+{
+	int code;
+
+	for (code = max; code >= 0; code--) {
+		if (bit_is_set(bits, code))
+			return code / 8 + 1;
+	}
+
+	return 0;
+}
+
+static void
+put_bitmap(struct writer *w, const unsigned long *bits, size_t nbytes)
+{
+	size_t i;
+	int j;
+
+	for (i = 0; i < nbytes; i++) {
+		uint8_t byte = 0;
+
+		for (j = 0; j < 8; j++) {
+			if (bit_is_set(bits, i * 8 + j))
+				byte |= 1 << j;
+		}
+		put_u8(w, byte);
+	}
+}
+
+static void
+put_string_record(struct writer *w, enum record_tag tag, const char *str)
+{
+	size_t len = strlen(str);
+
+	put_record_header(w, tag, len);
+	put(w, str, len);
+}
+
+static void
+serialize_binary(struct writer *w, struct device_description *desc)
+{
+	unsigned long *mask;
+	unsigned int type, code;
+	size_t nbytes;
+	int i;
+
+	put(w, BINARY_MAGIC, 4);
+	put_u8(w, BINARY_VERSION);
+	put(w, "\0\0\0", 3);
+
+	put_string_record(w, TAG_NAME, desc->name);
+	if (desc->has_phys)
+		put_string_record(w, TAG_PHYS, desc->phys);
+	if (desc->has_uniq)
+		put_string_record(w, TAG_UNIQ, desc->uniq);
+
+	put_record_header(w, TAG_ID, 8);
+	put_u16(w, desc->ids.bustype);
+	put_u16(w, desc->ids.vendor);
+	put_u16(w, desc->ids.product);
+	put_u16(w, desc->ids.version);
+
+	put_record_header(w, TAG_DRIVER_VERSION, 4);
+	put_u32(w, desc->driver_version);
+
+	nbytes = bitmap_bytes(desc->caps.props, INPUT_PROP_MAX);
+	put_record_header(w, TAG_PROPS, nbytes);
+	put_bitmap(w, desc->caps.props, nbytes);
+
+	nbytes = bitmap_bytes(desc->caps.bits, EV_MAX);
+	put_record_header(w, TAG_BITS, 1 + nbytes);
+	put_u8(w, 0);
+	put_bitmap(w, desc->caps.bits, nbytes);
+
+	for (type = 1; type < EV_CNT; type++) {
+		int max = caps_type_to_mask(&desc->caps, type, &mask);
+
+		if (max == -1 || !bit_is_set(desc->caps.bits, type))
+			continue;
+
+		nbytes = bitmap_bytes(mask, max);
+		put_record_header(w, TAG_BITS, 1 + nbytes);
+		put_u8(w, type);
+		put_bitmap(w, mask, nbytes);
+	}
+
+	if (bit_is_set(desc->caps.bits, EV_ABS)) {
+		for (code = 0; code < ABS_CNT; code++) {
+			const struct input_absinfo *abs = &desc->abs_info[code];
+
+			if (!bit_is_set(desc->caps.abs_bits, code))
+				continue;
+
+			put_record_header(w, TAG_ABSINFO, 2 + 6 * 4);
+			put_u16(w, code);
+			put_u32(w, abs->value);
+			put_u32(w, abs->minimum);
+			put_u32(w, abs->maximum);
+			put_u32(w, abs->fuzz);
+			put_u32(w, abs->flat);
+			put_u32(w, abs->resolution);
+		}
+	}
+
+	if (bit_is_set(desc->caps.bits, EV_REP)) {
+		put_record_header(w, TAG_REP, REP_CNT * 4);
+		for (i = 0; i < REP_CNT; i++)
+			put_u32(w, desc->rep_values[i]);
+	}
+}
+
+static void
+put_text_name(struct writer *w, const char *name, unsigned int value)
+{
+	if (name)
+		put_text(w, " %s", name);
+	else
+		put_text(w, " %u", value);
+}
+
+static int
+serialize_text(struct writer *w, struct device_description *desc)
+{
+	unsigned long *mask;
+	unsigned int type, code;
+
+	if (strchr(desc->name, '\n') ||
+	    strchr(desc->phys, '\n') ||
+	    strchr(desc->uniq, '\n'))
+		return -EINVAL;
+
+	put_text(w, TEXT_HEADER "\n");
+	put_text(w, "version: %d\n", TEXT_VERSION);
+	put_text(w, "name: %s\n", desc->name);
+	if (desc->has_phys)
+		put_text(w, "phys: %s\n", desc->phys);
+	if (desc->has_uniq)
+		put_text(w, "uniq: %s\n", desc->uniq);
+	put_text(w, "id: 0x%04x 0x%04x 0x%04x 0x%04x\n",
+		 desc->ids.bustype, desc->ids.vendor,
+		 desc->ids.product, desc->ids.version);
+	put_text(w, "driver: 0x%x\n", desc->driver_version);
+
+	for (code = 0; code < INPUT_PROP_CNT; code++) {
+		if (!bit_is_set(desc->caps.props, code))
+			continue;
+
+		put_text(w, "property:");
+		put_text_name(w, libevdev_property_get_name(code), code);
+		put_text(w, "\n");
+	}
+
+	for (type = 0; type < EV_CNT; type++) {
+		int max;
+
+		if (!bit_is_set(desc->caps.bits, type))
+			continue;
+
+		put_text(w, "event:");
+		put_text_name(w, libevdev_event_type_get_name(type), type);
+		put_text(w, "\n");
+
+		max = caps_type_to_mask(&desc->caps, type, &mask);
+		for (code = 0; max != -1 && code <= (unsigned int)max; code++) {
+			if (!bit_is_set(mask, code))
+				continue;
+
+			put_text(w, "event:");
+			put_text_name(w, libevdev_event_type_get_name(type), type);
+			put_text_name(w, libevdev_event_code_get_name(type, code), code);
+
+			if (type == EV_ABS) {
+				const struct input_absinfo *abs = &desc->abs_info[code];
+
+				put_text(w, " %d %d %d %d %d %d",
+					 abs->value, abs->minimum, abs->maximum,
+					 abs->fuzz, abs->flat, abs->resolution);
+			} else if (type == EV_REP) {
+				put_text(w, " %d", desc->rep_values[code]);
+			}
+			put_text(w, "\n");
+		}
+	}
+
+	return 0;
+}
+
+static int
+serialize(const struct libevdev *dev,
+	  enum libevdev_description_format format,
+	  bool with_values,
+	  void *buf, size_t len)
+{
+	struct writer w = {
+		.buf = buf,
+		.len = buf ? len : 0,
+		.pos = 0,
+	};
+	struct device_description *desc;
+	unsigned int code;
+	int rc = 0;
+
+	desc = malloc(sizeof(*desc));
+	if (!desc)
+		return -ENOMEM;
+
+	describe(dev, desc);
+	if (!with_values) {
+		for (code = 0; code < ABS_CNT; code++)
+			desc->abs_info[code].value = 0;
+	}
+
+	if (format == LIBEVDEV_DESCRIPTION_BINARY)
+		serialize_binary(&w, desc);
+	else
+		rc = serialize_text(&w, desc);
+
+	free(desc);
+
+	if (rc == 0 && w.pos > INT_MAX)
+		rc = -EOVERFLOW;
+
+	return rc < 0 ? rc : (int)w.pos;
+}
+
+LIBEVDEV_EXPORT int
+libevdev_serialize_description(const struct libevdev *dev,
+			       enum libevdev_description_format format,
+			       void *buf, size_t len)
+{
+	if (format != LIBEVDEV_DESCRIPTION_BINARY &&
+	    format != LIBEVDEV_DESCRIPTION_TEXT) {
+		log_bug(dev, "invalid description format %d\n", format);
+		return -EINVAL;
+	}
+
+	return serialize(dev, format, true, buf, len);
+}
+
+int
+_libevdev_serialize_capabilities(const struct libevdev *dev,
+				 void *buf, size_t len)
+{
+	return serialize(dev, LIBEVDEV_DESCRIPTION_BINARY, false, buf, len);
+}
+
+static uint16_t
+get_u16(const uint8_t *p)
+{
+	return p[0] | p[1] << 8;
+}
+
+static uint32_t
+get_u32(const uint8_t *p)
+{
+	return (uint32_t)p[0] | (uint32_t)p[1] << 8 |
+	       (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+/**
+ * Set the bits from a serialized bitmap, bits beyond max are ignored.
+ */
+static void
+get_bitmap(unsigned long *bits, int max, const uint8_t *p, size_t nbytes)
+{
+	size_t i;
+	int j;
+
+	for (i = 0; i < nbytes; i++) {
+		for (j = 0; j < 8; j++) {
+			size_t code = i * 8 + j;
+
+			if ((p[i] & (1 << j)) && code <= (size_t)max)
+				set_bit(bits, code);
+		}
+	}
+}
+
+static int
+get_string(char *dest, const uint8_t *p, size_t length)
+{
+	if (length >= MAX_NAME || memchr(p, '\0', length))
+		return -EINVAL;
+
+	memcpy(dest, p, length);
+	dest[length] = '\0';
+
+	return 0;
+}
+
+static int
+parse_binary(struct device_description *desc, const uint8_t *data, size_t len)
+{
+	size_t pos = BINARY_HEADER_SIZE;
+	unsigned long *mask;
+	unsigned int code;
+	int max;
+	int i;
+
+	if (data[4] != BINARY_VERSION)
+		return -EINVAL;
+
+	while (pos < len) {
+		const uint8_t *p;
+		size_t length;
+
+		if (len - pos < RECORD_HEADER_SIZE)
+			return -EINVAL;
+
+		length = get_u16(&data[pos + 2]);
+		if (len - pos - RECORD_HEADER_SIZE < length)
+			return -EINVAL;
+
+		p = &data[pos + RECORD_HEADER_SIZE];
+
+		switch (data[pos]) {
+		case TAG_NAME:
+			if (get_string(desc->name, p, length) < 0)
+				return -EINVAL;
+			break;
+		case TAG_PHYS:
+			if (get_string(desc->phys, p, length) < 0)
+				return -EINVAL;
+			desc->has_phys = true;
+			break;
+		case TAG_UNIQ:
+			if (get_string(desc->uniq, p, length) < 0)
+				return -EINVAL;
+			desc->has_uniq = true;
+			break;
+		case TAG_ID:
+			if (length < 8)
+				return -EINVAL;
+			desc->ids.bustype = get_u16(p);
+			desc->ids.vendor = get_u16(p + 2);
+			desc->ids.product = get_u16(p + 4);
+			desc->ids.version = get_u16(p + 6);
+			break;
+		case TAG_DRIVER_VERSION:
+			if (length < 4)
+				return -EINVAL;
+			desc->driver_version = get_u32(p);
+			break;
+		case TAG_PROPS:
+			get_bitmap(desc->caps.props, INPUT_PROP_MAX, p, length);
+			break;
+		case TAG_BITS:
+			if (length < 1)
+				return -EINVAL;
+			if (p[0] == 0) {
+				get_bitmap(desc->caps.bits, EV_MAX, p + 1, length - 1);
+			} else {
+				max = caps_type_to_mask(&desc->caps, p[0], &mask);
+				if (max == -1)
+					return -EINVAL;
+				get_bitmap(mask, max, p + 1, length - 1);
+			}
+			break;
+		case TAG_ABSINFO:
+			if (length < 2 + 6 * 4)
+				return -EINVAL;
+			code = get_u16(p);
+			if (code > ABS_MAX)
+				break;
+			desc->abs_info[code].value = (int32_t)get_u32(p + 2);
+			desc->abs_info[code].minimum = (int32_t)get_u32(p + 6);
+			desc->abs_info[code].maximum = (int32_t)get_u32(p + 10);
+			desc->abs_info[code].fuzz = (int32_t)get_u32(p + 14);
+			desc->abs_info[code].flat = (int32_t)get_u32(p + 18);
+			desc->abs_info[code].resolution = (int32_t)get_u32(p + 22);
+			break;
+		case TAG_REP:
+			if (length < REP_CNT * 4)
+				return -EINVAL;
+			for (i = 0; i < REP_CNT; i++)
+				desc->rep_values[i] = (int32_t)get_u32(p + i * 4);
+			break;
+		default:
+			/* unknown record, skip */
+			break;
+		}
+
+		pos += RECORD_HEADER_SIZE + length;
+	}
+
+	return 0;
+}
+
+/**
+ * Parse a name or a number into value.
+ *
+ * @param from_name The lookup function for names, returning -1 if the
+ * name is unknown
+ * @return 0 on success or -EINVAL
+ */
+static int
+parse_value(const char *token, int from_name, unsigned int *value)
+{
+	char *end;
+	unsigned long v;
+
+	if (from_name >= 0) {
+		*value = from_name;
+		return 0;
+	}
+
+	errno = 0;
+	v = strtoul(token, &end, 0);
+	if (errno != 0 || *token == '\0' || *end != '\0' || v > UINT_MAX)
+		return -EINVAL;
+
+	*value = v;
+
+	return 0;
+}
+
+static int
+parse_ints(char *str, int *values, size_t n)
+{
+	char *saveptr = NULL;
+	char *token;
+	size_t i;
+
+	for (i = 0; i < n; i++) {
+		char *end;
+		long v;
+
+		token = strtok_r(i == 0 ? str : NULL, " \t", &saveptr);
+		if (!token)
+			return -EINVAL;
+
+		errno = 0;
+		v = strtol(token, &end, 0);
+		if (errno != 0 || *end != '\0' || v < INT_MIN || v > INT_MAX)
+			return -EINVAL;
+		values[i] = v;
+	}
+
+	return strtok_r(NULL, " \t", &saveptr) ? -EINVAL : 0;
+}
+
+static int
+parse_event_line(struct device_description *desc, char *str)
+{
+	char *saveptr = NULL;
+	char *token;
+	unsigned int type, code;
+	unsigned long *mask;
+	int max;
+
+	token = strtok_r(str, " \t", &saveptr);
+	if (!token ||
+	    parse_value(token, libevdev_event_type_from_name(token), &type) < 0 ||
+	    type > EV_MAX)
+		return -EINVAL;
+
+	set_bit(desc->caps.bits, type);
+
+	token = strtok_r(NULL, " \t", &saveptr);
+	if (!token)
+		return 0;
+
+	max = caps_type_to_mask(&desc->caps, type, &mask);
+	if (max == -1 ||
+	    parse_value(token, libevdev_event_code_from_name(type, token), &code) < 0 ||
+	    code > (unsigned int)max)
+		return -EINVAL;
+
+	set_bit(mask, code);
+
+	/* the rest of the line, if any */
+	str = strtok_r(NULL, "", &saveptr);
+
+	if (type == EV_ABS) {
+		int v[6];
+
+		if (!str || parse_ints(str, v, 6) < 0)
+			return -EINVAL;
+
+		desc->abs_info[code].value = v[0];
+		desc->abs_info[code].minimum = v[1];
+		desc->abs_info[code].maximum = v[2];
+		desc->abs_info[code].fuzz = v[3];
+		desc->abs_info[code].flat = v[4];
+		desc->abs_info[code].resolution = v[5];
+	} else if (type == EV_REP) {
+		if (!str || parse_ints(str, &desc->rep_values[code], 1) < 0)
+			return -EINVAL;
+	} else if (str) {
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+static int
+parse_text_line(struct device_description *desc, char *line)
+{
+	char *value;
+	unsigned int prop;
+	int ids[4];
+
+	value = strstr(line, ": ");
+	if (!value) {
+		/* a key with an empty value, e.g. "uniq:" */
+		size_t len = strlen(line);
+
+		if (len == 0 || line[len - 1] != ':')
+			return -EINVAL;
+		line[len - 1] = '\0';
+		value = &line[len];
+	} else {
+		*value = '\0';
+		value += 2;
+	}
+
+	if (strcmp(line, "version") == 0) {
+		if (parse_ints(value, ids, 1) < 0 || ids[0] != TEXT_VERSION)
+			return -EINVAL;
+	} else if (strcmp(line, "name") == 0) {
+		return get_string(desc->name, (const uint8_t*)value, strlen(value));
+	} else if (strcmp(line, "phys") == 0) {
+		desc->has_phys = true;
+		return get_string(desc->phys, (const uint8_t*)value, strlen(value));
+	} else if (strcmp(line, "uniq") == 0) {
+		desc->has_uniq = true;
+		return get_string(desc->uniq, (const uint8_t*)value, strlen(value));
+	} else if (strcmp(line, "id") == 0) {
+		if (parse_ints(value, ids, 4) < 0)
+			return -EINVAL;
+		desc->ids.bustype = ids[0];
+		desc->ids.vendor = ids[1];
+		desc->ids.product = ids[2];
+		desc->ids.version = ids[3];
+	} else if (strcmp(line, "driver") == 0) {
+		if (parse_ints(value, &desc->driver_version, 1) < 0)
+			return -EINVAL;
+	} else if (strcmp(line, "property") == 0) {
+		if (parse_value(value, libevdev_property_from_name(value), &prop) < 0 ||
+		    prop > INPUT_PROP_MAX)
+			return -EINVAL;
+		set_bit(desc->caps.props, prop);
+	} else if (strcmp(line, "event") == 0) {
+		return parse_event_line(desc, value);
+	}
+	/* unknown keys are skipped */
+
+	return 0;
+}
+
+static int
+parse_text(struct device_description *desc, const char *data, size_t len)
+{
+	char *text, *line, *next;
+	int rc = 0;
+
+	text = malloc(len + 1);
+	if (!text)
+		return -ENOMEM;
+
+	memcpy(text, data, len);
+	text[len] = '\0';
+
+	/* the buffer from libevdev_serialize_description() may include
+	 * the terminating null byte */
+	if (strlen(text) != len && strlen(text) != len - 1) {
+		rc = -EINVAL;
+		goto out;
+	}
+
+	for (line = text; line && rc == 0; line = next) {
+		size_t n;
+
+		next = strchr(line, '\n');
+		if (next)
+			*next++ = '\0';
+
+		n = strlen(line);
+		if (n > 0 && line[n - 1] == '\r')
+			line[n - 1] = '\0';
+
+		if (line[0] == '\0' || line[0] == '#')
+			continue;
+
+		rc = parse_text_line(desc, line);
+	}
+
+out:
+	free(text);
+	return rc;
+}
+
+static int
+validate(const struct device_description *desc)
+{
+	const struct input_absinfo *slot = &desc->abs_info[ABS_MT_SLOT];
+
+	if (bit_is_set(desc->caps.abs_bits, ABS_MT_SLOT) &&
+	    !bit_is_set(desc->caps.abs_bits, ABS_MT_SLOT - 1) &&
+	    (slot->minimum != 0 || slot->maximum < 0 ||
+	     slot->maximum >= MAX_SLOTS ||
+	     slot->value < 0 || slot->value > slot->maximum))
+		return -EINVAL;
+
+	return 0;
+}
+
+LIBEVDEV_EXPORT int
+libevdev_new_from_description(const void *data, size_t len, struct libevdev **dev)
+{
+	struct device_description *desc;
+	struct libevdev *d;
+	int rc;
+
+	if (!data)
+		return -EINVAL;
+
+	desc = calloc(1, sizeof(*desc));
+	if (!desc)
+		return -ENOMEM;
+
+	if (len >= BINARY_HEADER_SIZE && memcmp(data, BINARY_MAGIC, 4) == 0)
+		rc = parse_binary(desc, data, len);
+	else
+		rc = parse_text(desc, data, len);
+
+	if (rc == 0)
+		rc = validate(desc);
+	if (rc < 0)
+		goto out;
+
+	d = libevdev_new();
+	if (!d) {
+		rc = -ENOMEM;
+		goto out;
+	}
+
+	rc = _libevdev_init_from_description(d, desc);
+	if (rc < 0)
+		libevdev_free(d);
+	else
+		*dev = d;
+
+out:
+	free(desc);
+	return rc;
+}
@@ -0,0 +1,358 @@
+/*
+ * Copyright © 2026 The libevdev contributors
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided that
+ * the above copyright notice appear in all copies and that both that copyright
+ * notice and this permission notice appear in supporting documentation, and
+ * that the name of the copyright holders not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  The copyright holders make no representations
+ * about the suitability of this software for any purpose.  It is provided "as
+ * is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN NO
+ * EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+ * TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE
+ * OF THIS SOFTWARE.
+ */
+
+#include <config.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libevdev.h"
+#include "libevdev-int.h"
+#include "libevdev-device-set.h"
+#include "libevdev-util.h"
+
+#define NO_ROW ((size_t)-1)
+
+struct member {
+	struct libevdev *dev;
+	uint64_t fingerprint[2]; /**< at the time the member was indexed */
+};
+
+/**
+ * The index is a matrix of bits, one row per event type, per event code
+ * and per property, one column per member. Rows are nwords longs each,
+ * stored back to back. Columns of removed members are reused, their
+ * stale bits are cleared when the column is reused and masked out by
+ * the live bitmap until then.
+ */
+struct libevdev_device_set {
+	size_t row_base[EV_CNT]; /**< first code row of a type or NO_ROW */
+	size_t prop_base;        /**< first property row */
+	size_t nrows;
+
+	size_t nwords;           /**< longs per row */
+	unsigned long *index;    /**< nrows * nwords */
+	unsigned long *live;     /**< columns in use, nwords */
+	struct member *members;  /**< nwords * LONG_BITS */
+	int nmembers;
+};
+
+static inline unsigned long *
+row(const struct libevdev_device_set *set, size_t r)
+{
+	return &set->index[r * set->nwords];
+}
+
+LIBEVDEV_EXPORT int
+libevdev_device_set_new(struct libevdev_device_set **set_out)
+{
+	struct libevdev_device_set *set;
+	unsigned int type;
+	size_t r;
+
+	set = calloc(1, sizeof(*set));
+	if (!set)
+		return -ENOMEM;
+
+	r = EV_CNT;
+	for (type = 0; type < EV_CNT; type++) {
+		struct capabilities caps;
+		unsigned long *mask;
+		int max = caps_type_to_mask(&caps, type, &mask);
+
+		if (max == -1) {
+			set->row_base[type] = NO_ROW;
+			continue;
+		}
+		set->row_base[type] = r;
+		r += max + 1;
+	}
+	set->prop_base = r;
+	set->nrows = r + INPUT_PROP_CNT;
+
+	*set_out = set;
+	return 0;
+}
+
+LIBEVDEV_EXPORT void
+libevdev_device_set_free(struct libevdev_device_set *set)
+{
+	if (!set)
+		return;
+
+	free(set->index);
+	free(set->live);
+	free(set->members);
+	free(set);
+}
+
+static int
+grow(struct libevdev_device_set *set)
+{
+	size_t nwords = max(set->nwords * 2, (size_t)1);
+	unsigned long *index, *live;
+	struct member *members;
+	size_t r;
+
+	index = calloc(set->nrows * nwords, sizeof(*index));
+	live = calloc(nwords, sizeof(*live));
+	members = calloc(nwords * LONG_BITS, sizeof(*members));
+	if (!index || !live || !members) {
+		free(index);
+		free(live);
+		free(members);
+		return -ENOMEM;
+	}
+
+	for (r = 0; set->nwords > 0 && r < set->nrows; r++)
+		memcpy(&index[r * nwords], row(set, r),
+		       set->nwords * sizeof(*index));
+	if (set->nwords > 0) {
+		memcpy(live, set->live, set->nwords * sizeof(*live));
+		memcpy(members, set->members,
+		       set->nwords * LONG_BITS * sizeof(*members));
+	}
+
+	free(set->index);
+	free(set->live);
+	free(set->members);
+	set->index = index;
+	set->live = live;
+	set->members = members;
+	set->nwords = nwords;
+
+	return 0;
+}
+
+static int
+find_member(const struct libevdev_device_set *set, const struct libevdev *dev)
+{
+	size_t i;
+
+	for (i = 0; i < set->nwords * LONG_BITS; i++) {
+		if (set->members[i].dev == dev && bit_is_set(set->live, i))
+			return i;
+	}
+
+	return -1;
+}
+
+static void
+set_rows(struct libevdev_device_set *set, size_t base,
+	 const unsigned long *bits, size_t nlongs, int col)
+{
+	size_t w;
+
+	for (w = 0; w < nlongs; w++) {
+		unsigned long b = bits[w];
+
+		while (b) {
+			size_t bit = w * LONG_BITS + __builtin_ctzl(b);
+
+			set_bit(row(set, base + bit), col);
+			b &= b - 1;
+		}
+	}
+}
+
+static void
+index_member(struct libevdev_device_set *set, int col)
+{
+	struct member *m = &set->members[col];
+	struct capabilities *caps = m->dev->caps;
+	unsigned int type;
+	size_t r;
+
+	for (r = 0; r < set->nrows; r++)
+		clear_bit(row(set, r), col);
+
+	set_rows(set, 0, caps->bits, NLONGS(EV_CNT), col);
+	set_bit(row(set, EV_SYN), col);
+
+	for (type = 0; type < EV_CNT; type++) {
+		unsigned long *mask;
+		int max;
+
+		if (set->row_base[type] == NO_ROW ||
+		    !bit_is_set(caps->bits, type))
+			continue;
+
+		max = caps_type_to_mask(caps, type, &mask);
+		set_rows(set, set->row_base[type], mask, NLONGS(max + 1), col);
+	}
+
+	set_rows(set, set->prop_base, caps->props, NLONGS(INPUT_PROP_CNT), col);
+
+	libevdev_get_fingerprint(m->dev, m->fingerprint);
+}
+
+LIBEVDEV_EXPORT int
+libevdev_device_set_add(struct libevdev_device_set *set, struct libevdev *dev)
+{
+	size_t w;
+	int col = -1;
+
+	if (find_member(set, dev) != -1)
+		return -EEXIST;
+
+	for (w = 0; w < set->nwords; w++) {
+		if (~set->live[w]) {
+			col = w * LONG_BITS + __builtin_ctzl(~set->live[w]);
+			break;
+		}
+	}
+
+	if (col == -1) {
+		int rc;
+
+		col = set->nwords * LONG_BITS;
+		rc = grow(set);
+		if (rc < 0)
+			return rc;
+	}
+
+	set->members[col].dev = dev;
+	index_member(set, col);
+	set_bit(set->live, col);
+	set->nmembers++;
+
+	return 0;
+}
+
+LIBEVDEV_EXPORT int
+libevdev_device_set_remove(struct libevdev_device_set *set, struct libevdev *dev)
+{
+	int col = find_member(set, dev);
+
+	if (col == -1)
+		return -ENOENT;
+
+	clear_bit(set->live, col);
+	set->members[col].dev = NULL;
+	set->nmembers--;
+
+	return 0;
+}
+
+LIBEVDEV_EXPORT int
+libevdev_device_set_update(struct libevdev_device_set *set, struct libevdev *dev)
+{
+	uint64_t fingerprint[2];
+	int col = find_member(set, dev);
+
+	if (col == -1)
+		return -ENOENT;
+
+	libevdev_get_fingerprint(dev, fingerprint);
+	if (memcmp(fingerprint, set->members[col].fingerprint,
+		   sizeof(fingerprint)) != 0)
+		index_member(set, col);
+
+	return 0;
+}
+
+LIBEVDEV_EXPORT int
+libevdev_device_set_get_num_devices(const struct libevdev_device_set *set)
+{
+	return set->nmembers;
+}
+
+static inline void
+and_row(unsigned long *result, const unsigned long *r, size_t nwords)
+{
+	size_t w;
+
+	for (w = 0; w < nwords; w++)
+		result[w] &= r[w];
+}
+
+LIBEVDEV_EXPORT int
+libevdev_device_set_query(const struct libevdev_device_set *set,
+			  const unsigned int *codes, size_t ncodes,
+			  const unsigned int *props, size_t nprops,
+			  struct libevdev **matches, size_t nmatches)
+{
+	unsigned long stack_result[16];
+	unsigned long *result = stack_result;
+	size_t i, w;
+	int count = 0;
+
+	for (i = 0; i < ncodes; i++) {
+		unsigned int type = codes[2 * i],
+			     code = codes[2 * i + 1];
+
+		if (type > EV_MAX)
+			return -EINVAL;
+
+		if (code != LIBEVDEV_DEVICE_SET_ANY_CODE && type != EV_SYN &&
+		    (set->row_base[type] == NO_ROW ||
+		     (int)code > libevdev_event_type_get_max(type)))
+			return -EINVAL;
+	}
+
+	for (i = 0; i < nprops; i++) {
+		if (props[i] > INPUT_PROP_MAX)
+			return -EINVAL;
+	}
+
+	if (set->nmembers == 0)
+		return 0;
+
+	if (set->nwords > ARRAY_LENGTH(stack_result)) {
+		result = malloc(set->nwords * sizeof(*result));
+		if (!result)
+			return -ENOMEM;
+	}
+	memcpy(result, set->live, set->nwords * sizeof(*result));
+
+	for (i = 0; i < ncodes; i++) {
+		unsigned int type = codes[2 * i],
+			     code = codes[2 * i + 1];
+
+		if (code == LIBEVDEV_DEVICE_SET_ANY_CODE || type == EV_SYN)
+			and_row(result, row(set, type), set->nwords);
+		else
+			and_row(result, row(set, set->row_base[type] + code),
+				set->nwords);
+	}
+
+	for (i = 0; i < nprops; i++)
+		and_row(result, row(set, set->prop_base + props[i]),
+			set->nwords);
+
+	for (w = 0; w < set->nwords; w++) {
+		unsigned long b = result[w];
+
+		while (b) {
+			if ((size_t)count < nmatches)
+				matches[count] = set->members[w * LONG_BITS +
+							      __builtin_ctzl(b)].dev;
+			count++;
+			b &= b - 1;
+		}
+	}
+
+	if (result != stack_result)
+		free(result);
+
+	return count;
+}
@@ -0,0 +1,167 @@
+/*
+ * Copyright © 2026 The libevdev contributors
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided that
+ * the above copyright notice appear in all copies and that both that copyright
+ * notice and this permission notice appear in supporting documentation, and
+ * that the name of the copyright holders not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  The copyright holders make no representations
+ * about the suitability of this software for any purpose.  It is provided "as
+ * is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN NO
+ * EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+ * TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE
+ * OF THIS SOFTWARE.
+ */
+
+#ifndef LIBEVDEV_DEVICE_SET_H
+#define LIBEVDEV_DEVICE_SET_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <libevdev/libevdev.h>
+
+struct libevdev_device_set;
+
+/**
+ * @defgroup devset Querying the capabilities of many devices
+ *
+ * A device set indexes the capabilities of its member devices, so that a
+ * question like "which devices have ABS_MT_POSITION_X and
+ * INPUT_PROP_DIRECT" is answered without looking at each device.
+ *
+ * For every event type, event code and property the set keeps a bitmap
+ * of the members that support it. A query is the bitwise AND of the
+ * bitmaps of all requirements.
+ *
+ * @code
+ * const unsigned int codes[] = { EV_ABS, ABS_MT_POSITION_X,
+ *                                EV_KEY, LIBEVDEV_DEVICE_SET_ANY_CODE };
+ * const unsigned int props[] = { INPUT_PROP_DIRECT };
+ * struct libevdev *matches[16];
+ * int n;
+ *
+ * n = libevdev_device_set_query(set, codes, 2, props, 1, matches, 16);
+ * @endcode
+ *
+ * The set does not own its members and does not notice when a member's
+ * capabilities change, call libevdev_device_set_update() after
+ * enabling or disabling types, codes or properties on a member.
+ */
+
+/**
+ * @ingroup devset
+ *
+ * Use as the code in a query to require only the event type.
+ */
+#define LIBEVDEV_DEVICE_SET_ANY_CODE (~0U)
+
+/**
+ * @ingroup devset
+ *
+ * Create a new, empty device set.
+ *
+ * @param[out] set The newly allocated device set
+ *
+ * @return 0 on success or -ENOMEM
+ */
+int libevdev_device_set_new(struct libevdev_device_set **set);
+
+/**
+ * @ingroup devset
+ *
+ * Free the device set. The member devices are not freed.
+ *
+ * @param set The device set, may be NULL
+ */
+void libevdev_device_set_free(struct libevdev_device_set *set);
+
+/**
+ * @ingroup devset
+ *
+ * Add a device to the set and index its capabilities.
+ *
+ * @param set The device set
+ * @param dev The device to add
+ *
+ * @return 0 on success, -EEXIST if the device is already a member or
+ * -ENOMEM
+ */
+int libevdev_device_set_add(struct libevdev_device_set *set, struct libevdev *dev);
+
+/**
+ * @ingroup devset
+ *
+ * Remove a device from the set.
+ *
+ * @param set The device set
+ * @param dev The device to remove
+ *
+ * @return 0 on success or -ENOENT if the device is not a member
+ */
+int libevdev_device_set_remove(struct libevdev_device_set *set, struct libevdev *dev);
+
+/**
+ * @ingroup devset
+ *
+ * Re-index the capabilities of a member device after they changed. If the
+ * capabilities did not change, see libevdev_get_fingerprint(), this
+ * function does nothing.
+ *
+ * @param set The device set
+ * @param dev The device to update
+ *
+ * @return 0 on success or -ENOENT if the device is not a member
+ */
+int libevdev_device_set_update(struct libevdev_device_set *set, struct libevdev *dev);
+
+/**
+ * @ingroup devset
+ *
+ * @param set The device set
+ *
+ * @return The number of devices in the set
+ */
+int libevdev_device_set_get_num_devices(const struct libevdev_device_set *set);
+
+/**
+ * @ingroup devset
+ *
+ * Find all member devices that support all of the given event codes and
+ * properties. An empty query matches all members.
+ *
+ * Up to nmatches matching devices are returned in no particular order.
+ * The return value is the total number of matches and may exceed
+ * nmatches.
+ *
+ * @param set The device set
+ * @param codes ncodes pairs of event type and event code. A code of @ref
+ * LIBEVDEV_DEVICE_SET_ANY_CODE only requires the event type.
+ * @param ncodes The number of type and code pairs in codes
+ * @param props The required properties
+ * @param nprops The number of properties in props
+ * @param[out] matches Set to the matching devices, may be NULL if
+ * nmatches is 0
+ * @param nmatches The number of elements in matches
+ *
+ * @return The number of matching devices, -EINVAL if a type, code or
+ * property is invalid or -ENOMEM
+ */
+int libevdev_device_set_query(const struct libevdev_device_set *set,
+			      const unsigned int *codes, size_t ncodes,
+			      const unsigned int *props, size_t nprops,
+			      struct libevdev **matches, size_t nmatches);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LIBEVDEV_DEVICE_SET_H */
@@ -0,0 +1,522 @@
+/*
+ * Copyright © 2026 The libevdev contributors
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided that
+ * the above copyright notice appear in all copies and that both that copyright
+ * notice and this permission notice appear in supporting documentation, and
+ * that the name of the copyright holders not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  The copyright holders make no representations
+ * about the suitability of this software for any purpose.  It is provided "as
+ * is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN NO
+ * EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+ * TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE
+ * OF THIS SOFTWARE.
+ */
+
+#include <config.h>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+
+#include "libevdev.h"
+#include "libevdev-int.h"
+#include "libevdev-enumerate.h"
+#include "libevdev-util.h"
+
+#define DEV_INPUT_DIR "/dev/input"
+
+struct pending_node {
+	enum libevdev_enumerate_status status;
+	char name[NAME_MAX + 1];
+};
+
+struct libevdev_enumerate {
+	char *directory;
+	int open_flags;
+	int inotify_fd;
+
+	/** required types, codes and properties, the refcount is unused */
+	struct capabilities required;
+
+	struct pending_node *pending; /**< nodes to be processed */
+	size_t pending_first;
+	size_t npending;
+	size_t pending_sz;
+
+	char **added; /**< names of nodes returned as added */
+	size_t nadded;
+
+	char devnode[PATH_MAX];
+};
+
+static bool
+is_event_node(const char *name)
+{
+	const char *p;
+
+	if (strncmp(name, "event", 5) != 0 || name[5] == '\0')
+		return false;
+
+	for (p = &name[5]; *p; p++) {
+		if (*p < '0' || *p > '9')
+			return false;
+	}
+
+	return true;
+}
+
+static int
+queue_node(struct libevdev_enumerate *e,
+	   enum libevdev_enumerate_status status,
+	   const char *name)
+{
+	struct pending_node *node;
+
+	if (!is_event_node(name) || strlen(name) > NAME_MAX)
+		return 0;
+
+	if (e->pending_first == e->npending)
+		e->pending_first = e->npending = 0;
+
+	if (e->npending == e->pending_sz) {
+		size_t sz = max(e->pending_sz * 2, (size_t)16);
+		struct pending_node *p = realloc(e->pending, sz * sizeof(*p));
+
+		if (!p)
+			return -ENOMEM;
+		e->pending = p;
+		e->pending_sz = sz;
+	}
+
+	node = &e->pending[e->npending++];
+	node->status = status;
+	strcpy(node->name, name);
+
+	return 0;
+}
+
+static ssize_t
+find_added(const struct libevdev_enumerate *e, const char *name)
+{
+	size_t i;
+
+	for (i = 0; i < e->nadded; i++) {
+		if (strcmp(e->added[i], name) == 0)
+			return i;
+	}
+
+	return -1;
+}
+
+LIBEVDEV_EXPORT int
+libevdev_enumerate_new(struct libevdev_enumerate **enumerate)
+{
+	struct libevdev_enumerate *e;
+
+	e = calloc(1, sizeof(*e));
+	if (!e)
+		return -ENOMEM;
+
+	e->directory = strdup(DEV_INPUT_DIR);
+	if (!e->directory) {
+		free(e);
+		return -ENOMEM;
+	}
+
+	e->open_flags = O_RDONLY|O_NONBLOCK|O_CLOEXEC;
+	e->inotify_fd = -1;
+	*enumerate = e;
+
+	return 0;
+}
+
+LIBEVDEV_EXPORT void
+libevdev_enumerate_free(struct libevdev_enumerate *e)
+{
+	size_t i;
+
+	if (!e)
+		return;
+
+	if (e->inotify_fd != -1)
+		close(e->inotify_fd);
+
+	for (i = 0; i < e->nadded; i++)
+		free(e->added[i]);
+	free(e->added);
+	free(e->pending);
+	free(e->directory);
+	free(e);
+}
+
+LIBEVDEV_EXPORT int
+libevdev_enumerate_set_directory(struct libevdev_enumerate *e,
+				 const char *directory)
+{
+	char *dir;
+
+	if (e->inotify_fd != -1) {
+		log_bug(NULL, "directory must be set before scanning\n");
+		return -EINVAL;
+	}
+
+	dir = strdup(directory);
+	if (!dir)
+		return -ENOMEM;
+
+	free(e->directory);
+	e->directory = dir;
+
+	return 0;
+}
+
+LIBEVDEV_EXPORT void
+libevdev_enumerate_set_open_flags(struct libevdev_enumerate *e, int flags)
+{
+	e->open_flags = flags;
+}
+
+LIBEVDEV_EXPORT int
+libevdev_enumerate_require_event_type(struct libevdev_enumerate *e,
+				      unsigned int type)
+{
+	if (type > EV_MAX)
+		return -EINVAL;
+
+	set_bit(e->required.bits, type);
+
+	return 0;
+}
+
+LIBEVDEV_EXPORT int
+libevdev_enumerate_require_event_code(struct libevdev_enumerate *e,
+				      unsigned int type,
+				      unsigned int code)
+{
+	unsigned long *mask;
+	int max;
+
+	if (type > EV_MAX)
+		return -EINVAL;
+
+	max = caps_type_to_mask(&e->required, type, &mask);
+	/* the rep bits don't come from the kernel */
+	if (max == -1 || type == EV_REP || code > (unsigned int)max)
+		return -EINVAL;
+
+	set_bit(e->required.bits, type);
+	set_bit(mask, code);
+
+	return 0;
+}
+
+LIBEVDEV_EXPORT int
+libevdev_enumerate_require_property(struct libevdev_enumerate *e,
+				    unsigned int prop)
+{
+	if (prop > INPUT_PROP_MAX)
+		return -EINVAL;
+
+	set_bit(e->required.props, prop);
+
+	return 0;
+}
+
+static bool
+is_subset(const unsigned long *required, const unsigned long *bits, size_t nlongs)
+{
+	size_t i;
+
+	for (i = 0; i < nlongs; i++) {
+		if ((required[i] & bits[i]) != required[i])
+			return false;
+	}
+
+	return true;
+}
+
+static bool
+is_empty(const unsigned long *bits, size_t nlongs)
+{
+	size_t i;
+
+	for (i = 0; i < nlongs; i++) {
+		if (bits[i])
+			return false;
+	}
+
+	return true;
+}
+
+/**
+ * Check the device against the requirements, cheapest check first: the
+ * event types, then the properties, then one bitmap per type with
+ * required codes.
+ *
+ * @return true if the device has all required capabilities
+ */
+static bool
+probe(struct libevdev_enumerate *e, int fd)
+{
+	unsigned long bits[NLONGS(KEY_CNT)];
+	unsigned int type;
+
+	if (!is_empty(e->required.bits, NLONGS(EV_CNT))) {
+		memset(bits, 0, sizeof(bits));
+		if (ioctl(fd, EVIOCGBIT(0, NLONGS(EV_CNT) * sizeof(long)), bits) < 0 ||
+		    !is_subset(e->required.bits, bits, NLONGS(EV_CNT)))
+			return false;
+	}
+
+	if (!is_empty(e->required.props, NLONGS(INPUT_PROP_CNT))) {
+		memset(bits, 0, sizeof(bits));
+		if (ioctl(fd, EVIOCGPROP(NLONGS(INPUT_PROP_CNT) * sizeof(long)), bits) < 0 ||
+		    !is_subset(e->required.props, bits, NLONGS(INPUT_PROP_CNT)))
+			return false;
+	}
+
+	for (type = EV_KEY; type <= EV_MAX; type++) {
+		unsigned long *mask;
+		size_t nlongs;
+		int max;
+
+		max = caps_type_to_mask(&e->required, type, &mask);
+		if (max == -1)
+			continue;
+
+		nlongs = NLONGS(max + 1);
+		if (is_empty(mask, nlongs))
+			continue;
+
+		memset(bits, 0, sizeof(bits));
+		if (ioctl(fd, EVIOCGBIT(type, nlongs * sizeof(long)), bits) < 0 ||
+		    !is_subset(mask, bits, nlongs))
+			return false;
+	}
+
+	return true;
+}
+
+/**
+ * Queue all nodes in the directory as added and all nodes returned as
+ * added that are no longer in the directory as removed.
+ *
+ * @return 0 on success or a negative errno
+ */
+static int
+scan_directory(struct libevdev_enumerate *e)
+{
+	struct dirent **namelist;
+	size_t i;
+	int rc = 0;
+	int n, j;
+
+	n = scandir(e->directory, &namelist, NULL, versionsort);
+	if (n < 0)
+		return -errno;
+
+	for (i = 0; rc == 0 && i < e->nadded; i++) {
+		for (j = 0; j < n; j++) {
+			if (strcmp(e->added[i], namelist[j]->d_name) == 0)
+				break;
+		}
+		if (j == n)
+			rc = queue_node(e, LIBEVDEV_ENUMERATE_DEVICE_REMOVED,
+					e->added[i]);
+	}
+
+	for (j = 0; j < n; j++) {
+		if (rc == 0)
+			rc = queue_node(e, LIBEVDEV_ENUMERATE_DEVICE_ADDED,
+					namelist[j]->d_name);
+		free(namelist[j]);
+	}
+	free(namelist);
+
+	return rc;
+}
+
+LIBEVDEV_EXPORT int
+libevdev_enumerate_scan(struct libevdev_enumerate *e)
+{
+	int rc;
+
+	/* watch first so we can't miss a device added during the scan */
+	if (e->inotify_fd == -1) {
+		e->inotify_fd = inotify_init1(IN_NONBLOCK|IN_CLOEXEC);
+		if (e->inotify_fd < 0) {
+			e->inotify_fd = -1;
+			return -errno;
+		}
+
+		if (inotify_add_watch(e->inotify_fd, e->directory,
+				      IN_CREATE|IN_ATTRIB|IN_MOVED_TO|
+				      IN_DELETE|IN_MOVED_FROM) < 0) {
+			rc = -errno;
+			close(e->inotify_fd);
+			e->inotify_fd = -1;
+			return rc;
+		}
+	}
+
+	return scan_directory(e);
+}
+
+LIBEVDEV_EXPORT int
+libevdev_enumerate_get_fd(const struct libevdev_enumerate *e)
+{
+	return e->inotify_fd;
+}
+
+static int
+read_inotify(struct libevdev_enumerate *e)
+{
+	char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+	ssize_t len;
+	char *p;
+	int rc;
+
+	len = read(e->inotify_fd, buf, sizeof(buf));
+	if (len < 0)
+		return -errno;
+
+	for (p = buf; p < buf + len; p += sizeof(struct inotify_event) + ((struct inotify_event*)p)->len) {
+		const struct inotify_event *event = (const struct inotify_event*)p;
+		enum libevdev_enumerate_status status;
+
+		/* we lost events, find out what changed */
+		if (event->mask & IN_Q_OVERFLOW) {
+			rc = scan_directory(e);
+			if (rc < 0)
+				return rc;
+			continue;
+		}
+
+		if (event->len == 0)
+			continue;
+
+		if (event->mask & (IN_DELETE|IN_MOVED_FROM))
+			status = LIBEVDEV_ENUMERATE_DEVICE_REMOVED;
+		else
+			status = LIBEVDEV_ENUMERATE_DEVICE_ADDED;
+
+		rc = queue_node(e, status, event->name);
+		if (rc < 0)
+			return rc;
+	}
+
+	return 0;
+}
+
+/**
+ * Open and probe the node, the fd is only kept if it matches.
+ *
+ * @return 1 if the device was added, 0 if it was skipped or a negative
+ * errno
+ */
+static int
+add_node(struct libevdev_enumerate *e, const char *name, struct libevdev **dev)
+{
+	char **added;
+	char *n;
+	int fd;
+	int rc;
+
+	if (find_added(e, name) != -1)
+		return 0;
+
+	/* Failure to open is not an error, the node may have gone
+	 * already, or its permissions have not been set yet. In the
+	 * latter case we'll get an IN_ATTRIB later. */
+	fd = open(e->devnode, e->open_flags);
+	if (fd < 0)
+		return 0;
+
+	if (!probe(e, fd)) {
+		close(fd);
+		return 0;
+	}
+
+	n = strdup(name);
+	added = realloc(e->added, (e->nadded + 1) * sizeof(*added));
+	if (!n || !added) {
+		free(n);
+		if (added)
+			e->added = added;
+		close(fd);
+		return -ENOMEM;
+	}
+	e->added = added;
+
+	rc = libevdev_new_from_fd(fd, dev);
+	if (rc < 0) {
+		free(n);
+		close(fd);
+		return rc == -ENOMEM ? rc : 0;
+	}
+
+	e->added[e->nadded++] = n;
+
+	return 1;
+}
+
+LIBEVDEV_EXPORT int
+libevdev_enumerate_next(struct libevdev_enumerate *e,
+			struct libevdev **dev,
+			const char **devnode)
+{
+	int rc;
+
+	*dev = NULL;
+	*devnode = NULL;
+
+	while (true) {
+		const struct pending_node *node;
+		ssize_t idx;
+
+		if (e->pending_first == e->npending) {
+			if (e->inotify_fd == -1)
+				return -EAGAIN;
+
+			rc = read_inotify(e);
+			if (rc < 0)
+				return rc;
+			continue;
+		}
+
+		node = &e->pending[e->pending_first++];
+		snprintf(e->devnode, sizeof(e->devnode), "%s/%s",
+			 e->directory, node->name);
+
+		if (node->status == LIBEVDEV_ENUMERATE_DEVICE_REMOVED) {
+			idx = find_added(e, node->name);
+			if (idx == -1)
+				continue;
+
+			free(e->added[idx]);
+			e->added[idx] = e->added[--e->nadded];
+			*devnode = e->devnode;
+			return LIBEVDEV_ENUMERATE_DEVICE_REMOVED;
+		}
+
+		rc = add_node(e, node->name, dev);
+		if (rc < 0)
+			return rc;
+		if (rc == 1) {
+			*devnode = e->devnode;
+			return LIBEVDEV_ENUMERATE_DEVICE_ADDED;
+		}
+	}
+}
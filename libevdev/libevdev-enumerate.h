@@ -0,0 +1,248 @@
+/*
+ * Copyright © 2026 The libevdev contributors
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided that
+ * the above copyright notice appear in all copies and that both that copyright
+ * notice and this permission notice appear in supporting documentation, and
+ * that the name of the copyright holders not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  The copyright holders make no representations
+ * about the suitability of this software for any purpose.  It is provided "as
+ * is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN NO
+ * EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+ * TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE
+ * OF THIS SOFTWARE.
+ */
+
+#ifndef LIBEVDEV_ENUMERATE_H
+#define LIBEVDEV_ENUMERATE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <libevdev/libevdev.h>
+
+struct libevdev_enumerate;
+
+/**
+ * @defgroup enumerate Device discovery and hotplug
+ *
+ * Discovery of evdev devices with a given set of capabilities. An
+ * enumerator scans a directory (/dev/input by default) for event nodes,
+ * watches it for devices being added and removed and returns a
+ * initialized struct libevdev for each device that matches the required
+ * event types, codes and properties.
+ *
+ * Devices are matched with the fewest ioctls possible, a device that does
+ * not have one of the required event types is rejected after a single
+ * ioctl and never initialized.
+ *
+ * @code
+ * struct libevdev_enumerate *e;
+ * struct libevdev *dev;
+ * const char *devnode;
+ * int rc;
+ *
+ * rc = libevdev_enumerate_new(&e);
+ * if (rc < 0)
+ *     return rc;
+ *
+ * libevdev_enumerate_require_event_code(e, EV_ABS, ABS_MT_POSITION_X);
+ * libevdev_enumerate_require_property(e, INPUT_PROP_DIRECT);
+ *
+ * rc = libevdev_enumerate_scan(e);
+ * if (rc < 0)
+ *     return rc;
+ *
+ * do {
+ *     while ((rc = libevdev_enumerate_next(e, &dev, &devnode)) >= 0) {
+ *         if (rc == LIBEVDEV_ENUMERATE_DEVICE_ADDED)
+ *             add_touchscreen(devnode, dev);
+ *         else
+ *             remove_touchscreen(devnode);
+ *     }
+ *
+ *     // wait for hotplug events
+ *     poll(&(struct pollfd){ libevdev_enumerate_get_fd(e), POLLIN }, 1, -1);
+ * } while (rc == -EAGAIN);
+ * @endcode
+ */
+
+/**
+ * @ingroup enumerate
+ */
+enum libevdev_enumerate_status {
+	/**
+	 * A matching device was found, either during the initial scan or
+	 * because it was plugged in.
+	 */
+	LIBEVDEV_ENUMERATE_DEVICE_ADDED = 1,
+	/**
+	 * A device previously returned as added was removed.
+	 */
+	LIBEVDEV_ENUMERATE_DEVICE_REMOVED = 2
+};
+
+/**
+ * @ingroup enumerate
+ *
+ * Create a new enumerator for /dev/input. The enumerator does not look
+ * at any device until libevdev_enumerate_scan() is called.
+ *
+ * @param[out] enumerate The newly allocated enumerator
+ *
+ * @return 0 on success or a negative errno on failure
+ *
+ * @see libevdev_enumerate_free
+ */
+int libevdev_enumerate_new(struct libevdev_enumerate **enumerate);
+
+/**
+ * @ingroup enumerate
+ *
+ * Free the enumerator. Devices previously returned by
+ * libevdev_enumerate_next() are not affected and must be freed by the
+ * caller.
+ *
+ * @param enumerate The enumerator, may be NULL
+ */
+void libevdev_enumerate_free(struct libevdev_enumerate *enumerate);
+
+/**
+ * @ingroup enumerate
+ *
+ * Scan the given directory instead of /dev/input. Only files named
+ * event followed by a number are considered. This function must be called
+ * before libevdev_enumerate_scan().
+ *
+ * @param enumerate The enumerator
+ * @param directory The directory to scan
+ *
+ * @return 0 on success or a negative errno on failure
+ */
+int libevdev_enumerate_set_directory(struct libevdev_enumerate *enumerate,
+				     const char *directory);
+
+/**
+ * @ingroup enumerate
+ *
+ * Set the flags used to open matching devices. The default is O_RDONLY |
+ * O_NONBLOCK | O_CLOEXEC. Devices are always probed with O_RDONLY, the
+ * flags only apply to the fd of the device returned by
+ * libevdev_enumerate_next().
+ *
+ * @param enumerate The enumerator
+ * @param flags The flags as passed to open(2)
+ */
+void libevdev_enumerate_set_open_flags(struct libevdev_enumerate *enumerate,
+				       int flags);
+
+/**
+ * @ingroup enumerate
+ *
+ * Only return devices that support the given event type.
+ *
+ * @param enumerate The enumerator
+ * @param type The event type, e.g. EV_ABS
+ *
+ * @return 0 on success or -EINVAL if the type is invalid
+ */
+int libevdev_enumerate_require_event_type(struct libevdev_enumerate *enumerate,
+					  unsigned int type);
+
+/**
+ * @ingroup enumerate
+ *
+ * Only return devices that support the given event code. The event
+ * type is required implicitly.
+ *
+ * @param enumerate The enumerator
+ * @param type The event type, e.g. EV_ABS
+ * @param code The event code, e.g. ABS_X
+ *
+ * @return 0 on success or -EINVAL if the type or code is invalid
+ */
+int libevdev_enumerate_require_event_code(struct libevdev_enumerate *enumerate,
+					  unsigned int type,
+					  unsigned int code);
+
+/**
+ * @ingroup enumerate
+ *
+ * Only return devices that have the given property.
+ *
+ * @param enumerate The enumerator
+ * @param prop The property, e.g. INPUT_PROP_DIRECT
+ *
+ * @return 0 on success or -EINVAL if the property is invalid
+ */
+int libevdev_enumerate_require_property(struct libevdev_enumerate *enumerate,
+					unsigned int prop);
+
+/**
+ * @ingroup enumerate
+ *
+ * Start watching the directory for new and removed devices and queue all
+ * existing devices for libevdev_enumerate_next(). Devices are probed
+ * lazily when they are returned by libevdev_enumerate_next().
+ *
+ * Calling this function again rescans the directory, devices that were
+ * already returned as added are not returned again and devices that have
+ * disappeared since are returned as removed. The directory is rescanned
+ * the same way if the kernel drops change notifications.
+ *
+ * @param enumerate The enumerator
+ *
+ * @return 0 on success or a negative errno on failure
+ */
+int libevdev_enumerate_scan(struct libevdev_enumerate *enumerate);
+
+/**
+ * @ingroup enumerate
+ *
+ * @param enumerate The enumerator
+ *
+ * @return A file descriptor that becomes readable when devices are added
+ * to or removed from the directory, or -1 if libevdev_enumerate_scan()
+ * was not called yet. The fd must not be read from by the caller.
+ */
+int libevdev_enumerate_get_fd(const struct libevdev_enumerate *enumerate);
+
+/**
+ * @ingroup enumerate
+ *
+ * Get the next added or removed device. Added devices are probed and
+ * only returned if they match all requirements.
+ *
+ * For @ref LIBEVDEV_ENUMERATE_DEVICE_ADDED, dev is set to a newly
+ * initialized device. The caller owns both the device and its fd and
+ * must close libevdev_get_fd() and libevdev_free() the device. For
+ * @ref LIBEVDEV_ENUMERATE_DEVICE_REMOVED, dev is set to NULL and devnode
+ * is the node of a device previously returned as added.
+ *
+ * devnode is valid until the next call to libevdev_enumerate_next() or
+ * libevdev_enumerate_free().
+ *
+ * @param enumerate The enumerator
+ * @param[out] dev The added device or NULL
+ * @param[out] devnode The path of the device node
+ *
+ * @return One of @ref libevdev_enumerate_status, -EAGAIN if no more
+ * devices are pending, or another negative errno on failure
+ */
+int libevdev_enumerate_next(struct libevdev_enumerate *enumerate,
+			    struct libevdev **dev,
+			    const char **devnode);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LIBEVDEV_ENUMERATE_H */
@@ -27,6 +27,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <errno.h>
 #include "libevdev.h"
 #include "libevdev-util.h"
@@ -74,14 +75,18 @@ struct logdata {
 	void *userdata;					/** user-defined data pointer */
 };
 
-struct libevdev {
-	int fd;
-	bool initialized;
-	char *name;
-	char *phys;
-	char *uniq;
-	struct input_id ids;
-	int driver_version;
+/**
+ * Internal only: the capability bitmaps of a device. A block may be
+ * shared between several devices with identical capabilities, see
+ * libevdev_share_capabilities(). A shared block (refcount > 1) is
+ * immutable, a device that modifies its capabilities splits off a
+ * private copy first.
+ *
+ * A refcount of -1 marks the static block every device starts with, it
+ * is never modified or freed.
+ */
+struct capabilities {
+	int refcount;
 	unsigned long bits[NLONGS(EV_CNT)];
 	unsigned long props[NLONGS(INPUT_PROP_CNT)];
 	unsigned long key_bits[NLONGS(KEY_CNT)];
@@ -93,12 +98,81 @@ struct libevdev {
 	unsigned long rep_bits[NLONGS(REP_CNT)]; /* convenience, always 1 */
 	unsigned long ff_bits[NLONGS(FF_CNT)];
 	unsigned long snd_bits[NLONGS(SND_CNT)];
+};
+
+/**
+ * Internal only: the identity and capabilities of a device, everything
+ * that is needed to set up a struct libevdev. Filled in from the kernel
+ * by libevdev_set_fd() or parsed from a serialized description, see
+ * libevdev-description.c.
+ */
+struct device_description {
+	char name[MAX_NAME];
+	char phys[MAX_NAME];
+	char uniq[MAX_NAME];
+	bool has_phys;
+	bool has_uniq;
+	struct input_id ids;
+	int driver_version;
+	struct capabilities caps; /**< refcount is ignored */
+	struct input_absinfo abs_info[ABS_CNT]; /**< dense, by code */
+	int rep_values[REP_CNT];
+};
+
+/**
+ * @return the bitmap for the given type in caps and the maximum code for
+ * that type, or -1 if the type has no bitmap
+ */
+static inline int
+caps_type_to_mask(struct capabilities *caps, unsigned int type, unsigned long **mask)
+{
+	switch (type) {
+		case EV_KEY: *mask = caps->key_bits; break;
+		case EV_REL: *mask = caps->rel_bits; break;
+		case EV_ABS: *mask = caps->abs_bits; break;
+		case EV_MSC: *mask = caps->msc_bits; break;
+		case EV_SW: *mask = caps->sw_bits; break;
+		case EV_LED: *mask = caps->led_bits; break;
+		case EV_SND: *mask = caps->snd_bits; break;
+		case EV_REP: *mask = caps->rep_bits; break;
+		case EV_FF: *mask = caps->ff_bits; break;
+		default:
+			return -1;
+	}
+
+	return libevdev_event_type_get_max(type);
+}
+
+struct libevdev {
+	int fd;
+	bool initialized;
+	char *name;
+	char *phys;
+	char *uniq;
+	struct input_id ids;
+	int driver_version;
+	struct capabilities *caps; /**< never NULL, may be shared */
+	uint64_t fingerprint[2]; /**< cached, see update_fingerprint() */
+	bool fingerprint_dirty; /**< fingerprint is out of date */
 	unsigned long key_values[NLONGS(KEY_CNT)];
 	unsigned long led_values[NLONGS(LED_CNT)];
 	unsigned long sw_values[NLONGS(SW_CNT)];
-	struct input_absinfo abs_info[ABS_CNT];
-	int *mt_slot_vals; /* [num_slots * ABS_MT_CNT] */
+	struct input_absinfo *abs_info; /**< [ABS_CNT] by code, NULL without axes, never moved */
+	int *mt_slot_vals; /* [ABS_MT_CNT * num_slots], axis-major */
 	int num_slots; /**< valid slots in mt_slot_vals */
+	unsigned long *mt_active_slots; /**< slots with a tracking ID other than -1 */
+	unsigned long *mt_changes;      /**< AXISBIT()s changed in the current frame */
+	unsigned long *mt_last_changes; /**< AXISBIT()s changed in the last complete frame */
+
+	/** opt-in ring of touch frames, see record_touch_frame() */
+	struct {
+		struct libevdev_touch_frame *frames; /**< [size] */
+		struct libevdev_touch *touches;      /**< [size * num_slots] */
+		unsigned int size;
+		unsigned int count;                  /**< frames recorded, at most size */
+		unsigned int next;                   /**< frame to write next */
+	} touch_history;
+	struct mt_converter *mt_converter; /**< protocol A devices only, may be NULL */
 	int current_slot;
 	int rep_values[REP_CNT];
 
@@ -122,8 +196,40 @@ struct libevdev {
 	} mt_sync;
 
 	struct logdata log;
+
+	/**
+	 * Single allocation for the buffers whose size is known once
+	 * the device is initialized: name, phys, uniq, abs_info, the
+	 * multitouch state and the event queue. Buffers that are
+	 * resized or replaced later move out to the heap.
+	 */
+	void *arena;
+	size_t arena_sz;
 };
 
+/**
+ * @return true if ptr points into the arena of the device and thus must
+ * not be passed to free()
+ */
+static inline bool
+in_arena(const struct libevdev *dev, const void *ptr)
+{
+	uintptr_t p = (uintptr_t)ptr;
+	uintptr_t start = (uintptr_t)dev->arena;
+
+	return dev->arena && p >= start && p < start + dev->arena_sz;
+}
+
+/**
+ * free() the pointer unless it points into the arena of the device.
+ */
+static inline void
+arena_free(const struct libevdev *dev, void *ptr)
+{
+	if (!in_arena(dev, ptr))
+		free(ptr);
+}
+
 #define log_msg_cond(dev, priority, ...) \
 	do { \
 		if (_libevdev_log_priority(dev) >= priority) \
@@ -143,6 +249,65 @@ _libevdev_log_msg(const struct libevdev *dev,
 extern enum libevdev_log_priority
 _libevdev_log_priority(const struct libevdev *dev);
 
+/**
+ * Set up a freshly reset device from the description. The device is not
+ * bound to an fd and has no event queue.
+ *
+ * @return 0 on success or a negative errno on failure
+ */
+extern int
+_libevdev_init_from_description(struct libevdev *dev,
+				const struct device_description *desc);
+
+/**
+ * Serialize the binary description of the device with all axis values
+ * set to 0, i.e. only what the device is, not the state it is in.
+ *
+ * @return the length of the description or a negative errno, see
+ * libevdev_serialize_description()
+ */
+extern int
+_libevdev_serialize_capabilities(const struct libevdev *dev,
+				 void *buf, size_t len);
+
+/**
+ * Internal only: protocol A to protocol B conversion, see
+ * libevdev-mt-convert.c and libevdev_enable_mt_protocol_a_conversion().
+ *
+ * @param max_distance The squared distance beyond which a contact is a
+ * new touch rather than the continuation of a touch
+ */
+extern int
+_libevdev_mt_converter_new(unsigned int nslots, int max_tracking_id,
+			   long long max_distance,
+			   struct mt_converter **conv);
+extern void
+_libevdev_mt_converter_free(struct mt_converter *conv);
+
+/**
+ * Feed an event from the device into the converter.
+ *
+ * @return true if the event was consumed and must not be passed on
+ */
+extern bool
+_libevdev_mt_converter_push(struct mt_converter *conv, const struct input_event *ev);
+
+/**
+ * Take the next converted event.
+ *
+ * @return false if there are no converted events left
+ */
+extern bool
+_libevdev_mt_converter_pop(struct mt_converter *conv, struct input_event *ev);
+extern bool
+_libevdev_mt_converter_has_events(const struct mt_converter *conv);
+
+/**
+ * Drop the contacts of the current, incomplete frame.
+ */
+extern void
+_libevdev_mt_converter_discard_frame(struct mt_converter *conv);
+
 /**
  * @return a pointer to the next element in the queue, or NULL if the queue
  * is full.
@@ -240,7 +405,7 @@ queue_alloc(struct libevdev *dev, size_t size)
 static inline void
 queue_free(struct libevdev *dev)
 {
-	free(dev->queue);
+	arena_free(dev, dev->queue);
 	dev->queue_size = 0;
 	dev->queue_next = 0;
 }
@@ -286,9 +451,21 @@ queue_set_num_elements(struct libevdev *dev, size_t nelem)
 	return 0;
 }
 
+/**
+ * @return true if the next libevdev_next_event() returns an event without
+ * reading from the fd
+ */
+static inline bool
+has_buffered_events(struct libevdev *dev)
+{
+	return queue_num_elements(dev) > 0 ||
+	       (dev->mt_converter &&
+		_libevdev_mt_converter_has_events(dev->mt_converter));
+}
+
 #define max_mask(uc, lc) \
 	case EV_##uc: \
-			*mask = dev->lc##_bits; \
+			*mask = dev->caps->lc##_bits; \
 			max = libevdev_event_type_get_max(type); \
 		break;
 
@@ -315,6 +492,10 @@ type_to_mask_const(const struct libevdev *dev, unsigned int type, const unsigned
 	return max;
 }
 
+/**
+ * The capabilities must be private to dev before the mask is modified,
+ * see caps_make_private().
+ */
 static inline int
 type_to_mask(struct libevdev *dev, unsigned int type, unsigned long **mask)
 {
@@ -0,0 +1,374 @@
+/*
+ * Copyright © 2026 The libevdev contributors
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided that
+ * the above copyright notice appear in all copies and that both that copyright
+ * notice and this permission notice appear in supporting documentation, and
+ * that the name of the copyright holders not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  The copyright holders make no representations
+ * about the suitability of this software for any purpose.  It is provided "as
+ * is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN NO
+ * EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+ * TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE
+ * OF THIS SOFTWARE.
+ */
+
+/*
+ * Conversion of MT protocol A (anonymous contacts separated by
+ * SYN_MT_REPORT) into protocol B (slots with tracking IDs).
+ *
+ * The contacts of a frame are collected until its SYN_REPORT, then matched
+ * to the contacts of the previous frame: by the device's tracking ID if it
+ * sends one, otherwise by picking the closest pair of position until no
+ * pairs closer than max_distance are left. The protocol B events for the
+ * differences are then returned one by one, followed by the SYN_REPORT.
+ */
+
+#include <config.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libevdev.h"
+#include "libevdev-int.h"
+#include "libevdev-util.h"
+
+#define AXIS(_code) ((_code) - ABS_MT_MIN)
+#define HAS_AXIS(_c, _code) ((_c)->present & (1U << AXIS(_code)))
+
+struct contact {
+	uint32_t present; /**< bit per axis that has a value */
+	int values[ABS_MT_CNT];
+};
+
+struct converted_slot {
+	bool active;
+	int tracking_id;
+	struct contact last; /**< the values emitted for this slot */
+};
+
+struct mt_converter {
+	unsigned int nslots;
+	int max_tracking_id;
+	int next_tracking_id;
+	long long max_distance; /**< squared, further contacts are new touches */
+
+	struct contact *contacts; /**< [nslots + 1], the last one is scratch */
+	unsigned int ncontacts;
+
+	struct converted_slot *slots; /**< [nslots] */
+
+	/* scratch space of convert_frame(), all [nslots] */
+	int *match;
+	bool *taken;
+	bool *continued;
+
+	struct input_event *out; /**< [max_out] */
+	size_t max_out;
+	size_t nout;
+	size_t out_next;
+};
+
+int
+_libevdev_mt_converter_new(unsigned int nslots, int max_tracking_id,
+			   long long max_distance,
+			   struct mt_converter **conv_out)
+{
+	struct mt_converter *conv;
+
+	conv = calloc(1, sizeof(*conv));
+	if (!conv)
+		return -ENOMEM;
+
+	conv->nslots = nslots;
+	conv->max_tracking_id = max(max_tracking_id, 1);
+	conv->max_distance = max_distance;
+	/* per slot: slot, tracking ID twice, every axis; plus SYN_REPORT */
+	conv->max_out = nslots * (ABS_MT_CNT + 3) + 1;
+
+	conv->contacts = calloc(nslots + 1, sizeof(*conv->contacts));
+	conv->slots = calloc(nslots, sizeof(*conv->slots));
+	conv->out = calloc(conv->max_out, sizeof(*conv->out));
+	conv->match = calloc(nslots, sizeof(*conv->match));
+	conv->taken = calloc(nslots, sizeof(*conv->taken));
+	conv->continued = calloc(nslots, sizeof(*conv->continued));
+	if (!conv->contacts || !conv->slots || !conv->out ||
+	    !conv->match || !conv->taken || !conv->continued) {
+		_libevdev_mt_converter_free(conv);
+		return -ENOMEM;
+	}
+
+	*conv_out = conv;
+	return 0;
+}
+
+void
+_libevdev_mt_converter_free(struct mt_converter *conv)
+{
+	if (!conv)
+		return;
+
+	free(conv->contacts);
+	free(conv->slots);
+	free(conv->out);
+	free(conv->match);
+	free(conv->taken);
+	free(conv->continued);
+	free(conv);
+}
+
+void
+_libevdev_mt_converter_discard_frame(struct mt_converter *conv)
+{
+	conv->ncontacts = 0;
+	memset(&conv->contacts[0], 0, sizeof(conv->contacts[0]));
+}
+
+bool
+_libevdev_mt_converter_has_events(const struct mt_converter *conv)
+{
+	return conv->out_next < conv->nout;
+}
+
+bool
+_libevdev_mt_converter_pop(struct mt_converter *conv, struct input_event *ev)
+{
+	if (conv->out_next >= conv->nout)
+		return false;
+
+	*ev = conv->out[conv->out_next++];
+	return true;
+}
+
+static void
+emit(struct mt_converter *conv, const struct input_event *frame,
+     unsigned int code, int value)
+{
+	struct input_event *ev = &conv->out[conv->nout++];
+
+	*ev = *frame;
+	ev->type = EV_ABS;
+	ev->code = code;
+	ev->value = value;
+}
+
+static void
+end_contact(struct mt_converter *conv)
+{
+	struct contact *c = &conv->contacts[conv->ncontacts];
+
+	if (c->present == 0)
+		return;
+
+	/* extra contacts reuse the scratch contact and are dropped */
+	if (conv->ncontacts < conv->nslots)
+		conv->ncontacts++;
+	memset(&conv->contacts[conv->ncontacts], 0, sizeof(*c));
+}
+
+static long long
+distance(const struct contact *a, const struct contact *b)
+{
+	long long dx = (long long)a->values[AXIS(ABS_MT_POSITION_X)] -
+		       b->values[AXIS(ABS_MT_POSITION_X)];
+	long long dy = (long long)a->values[AXIS(ABS_MT_POSITION_Y)] -
+		       b->values[AXIS(ABS_MT_POSITION_Y)];
+
+	return dx * dx + dy * dy;
+}
+
+/**
+ * Fill match[contact] with the slot of the previous frame that continues
+ * the contact, or -1 for a new contact.
+ */
+static void
+match_contacts(struct mt_converter *conv, int *match)
+{
+	bool *taken = conv->taken;
+	unsigned int i, s;
+
+	memset(taken, 0, conv->nslots * sizeof(*taken));
+	for (i = 0; i < conv->ncontacts; i++)
+		match[i] = -1;
+
+	/* the device's own tracking IDs are authoritative */
+	for (i = 0; i < conv->ncontacts; i++) {
+		const struct contact *c = &conv->contacts[i];
+
+		if (!HAS_AXIS(c, ABS_MT_TRACKING_ID))
+			continue;
+
+		for (s = 0; s < conv->nslots; s++) {
+			const struct converted_slot *slot = &conv->slots[s];
+
+			if (slot->active && !taken[s] &&
+			    HAS_AXIS(&slot->last, ABS_MT_TRACKING_ID) &&
+			    slot->last.values[AXIS(ABS_MT_TRACKING_ID)] ==
+			    c->values[AXIS(ABS_MT_TRACKING_ID)]) {
+				match[i] = s;
+				taken[s] = true;
+				break;
+			}
+		}
+	}
+
+	/* then the closest remaining pairs */
+	while (true) {
+		long long best = -1;
+		int best_contact = -1, best_slot = -1;
+
+		for (i = 0; i < conv->ncontacts; i++) {
+			const struct contact *c = &conv->contacts[i];
+
+			if (match[i] != -1 || HAS_AXIS(c, ABS_MT_TRACKING_ID))
+				continue;
+
+			for (s = 0; s < conv->nslots; s++) {
+				long long d;
+
+				if (!conv->slots[s].active || taken[s])
+					continue;
+
+				d = distance(c, &conv->slots[s].last);
+				if (d <= conv->max_distance && (best == -1 || d < best)) {
+					best = d;
+					best_contact = i;
+					best_slot = s;
+				}
+			}
+		}
+
+		if (best == -1)
+			break;
+
+		match[best_contact] = best_slot;
+		taken[best_slot] = true;
+	}
+}
+
+static void
+convert_frame(struct mt_converter *conv, const struct input_event *syn)
+{
+	int *match = conv->match;
+	bool *continued = conv->continued;
+	unsigned int i, s;
+
+	end_contact(conv);
+	match_contacts(conv, match);
+
+	memset(continued, 0, conv->nslots * sizeof(*continued));
+	for (i = 0; i < conv->ncontacts; i++) {
+		if (match[i] != -1)
+			continued[match[i]] = true;
+	}
+
+	conv->nout = 0;
+	conv->out_next = 0;
+
+	for (s = 0; s < conv->nslots; s++) {
+		struct converted_slot *slot = &conv->slots[s];
+		const struct contact *c = NULL;
+		bool slot_sent = false;
+		unsigned int code;
+
+		/* a touch that ended */
+		if (slot->active && !continued[s]) {
+			emit(conv, syn, ABS_MT_SLOT, s);
+			emit(conv, syn, ABS_MT_TRACKING_ID, -1);
+			slot->active = false;
+			slot_sent = true;
+		}
+
+		for (i = 0; i < conv->ncontacts; i++) {
+			if (match[i] == (int)s) {
+				c = &conv->contacts[i];
+				break;
+			}
+		}
+
+		/* a new touch, take the first free slot */
+		if (!c && !slot->active) {
+			for (i = 0; i < conv->ncontacts; i++) {
+				if (match[i] == -1) {
+					match[i] = s;
+					c = &conv->contacts[i];
+					break;
+				}
+			}
+			if (!c)
+				continue;
+
+			if (!slot_sent)
+				emit(conv, syn, ABS_MT_SLOT, s);
+			slot_sent = true;
+			slot->active = true;
+			slot->tracking_id = conv->next_tracking_id;
+			if (conv->next_tracking_id == conv->max_tracking_id)
+				conv->next_tracking_id = 0;
+			else
+				conv->next_tracking_id++;
+			emit(conv, syn, ABS_MT_TRACKING_ID, slot->tracking_id);
+			memset(&slot->last, 0, sizeof(slot->last));
+		}
+
+		if (!c)
+			continue;
+
+		for (code = ABS_MT_SLOT + 1; code <= ABS_MT_MAX; code++) {
+			if (!HAS_AXIS(c, code))
+				continue;
+
+			/* the device's tracking ID is only used for matching */
+			if (code != ABS_MT_TRACKING_ID &&
+			    (!HAS_AXIS(&slot->last, code) ||
+			     slot->last.values[AXIS(code)] != c->values[AXIS(code)])) {
+				if (!slot_sent)
+					emit(conv, syn, ABS_MT_SLOT, s);
+				slot_sent = true;
+				emit(conv, syn, code, c->values[AXIS(code)]);
+			}
+		}
+
+		slot->last = *c;
+	}
+
+	conv->out[conv->nout++] = *syn;
+
+	_libevdev_mt_converter_discard_frame(conv);
+}
+
+bool
+_libevdev_mt_converter_push(struct mt_converter *conv, const struct input_event *ev)
+{
+	struct contact *c = &conv->contacts[conv->ncontacts];
+
+	if (ev->type == EV_ABS && ev->code > ABS_MT_SLOT && ev->code <= ABS_MT_MAX) {
+		c->values[AXIS(ev->code)] = ev->value;
+		c->present |= 1U << AXIS(ev->code);
+		return true;
+	}
+
+	if (ev->type != EV_SYN)
+		return false;
+
+	switch (ev->code) {
+	case SYN_MT_REPORT:
+		end_contact(conv);
+		return true;
+	case SYN_REPORT:
+		convert_frame(conv, ev);
+		return true;
+	case SYN_DROPPED:
+		_libevdev_mt_converter_discard_frame(conv);
+		return false;
+	default:
+		return false;
+	}
+}
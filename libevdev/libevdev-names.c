@@ -31,39 +31,54 @@
 #include "libevdev-util.h"
 #include "event-names.h"
 
-struct name_lookup {
-	const char *name;
-	size_t len;
-};
-
-static int cmp_entry(const void *vlookup, const void *ventry)
+/**
+ * FNV-1a, see make-event-names.py for how the hash is used.
+ */
+static inline uint64_t
+name_hash(const char *name, size_t len)
 {
-	const struct name_lookup *lookup = vlookup;
-	const struct name_entry *entry = ventry;
-	int r;
-
-	r = strncmp(lookup->name, entry->name, lookup->len);
-	if (!r) {
-		if (entry->name[lookup->len])
-			r = -1;
-		else
-			r = 0;
+	uint64_t h = 0xcbf29ce484222325ULL;
+	size_t i;
+
+	for (i = 0; i < len; i++) {
+		h ^= (unsigned char)name[i];
+		h *= 0x100000001b3ULL;
 	}
 
-	return r;
+	return h;
+}
+
+static inline uint32_t
+fmix32(uint32_t h)
+{
+	h ^= h >> 16;
+	h *= 0x85ebca6b;
+	h ^= h >> 13;
+	h *= 0xc2b2ae35;
+	h ^= h >> 16;
+
+	return h;
 }
 
-static const struct name_entry*
-lookup_name(const struct name_entry *array, size_t asize,
-	    struct name_lookup *lookup)
+/**
+ * @return the value of name if it is a name of the given type (EV_* or
+ * NAME_TYPE_*), or -1
+ */
+static int
+lookup_name(const char *name, size_t len, int type)
 {
 	const struct name_entry *entry;
+	uint64_t h = name_hash(name, len);
+	unsigned short d;
+
+	d = name_hash_displacements[(h >> 32) & (NAME_HASH_BUCKETS - 1)];
+	entry = &name_hash_table[fmix32((uint32_t)h ^ d) & (NAME_HASH_SIZE - 1)];
 
-	entry = bsearch(lookup, array, asize, sizeof(*array), cmp_entry);
-	if (!entry)
-		return NULL;
+	if (!entry->name || entry->len != len || entry->type != type ||
+	    memcmp(entry->name, name, len) != 0)
+		return -1;
 
-	return entry;
+	return entry->value;
 }
 
 LIBEVDEV_EXPORT int
@@ -75,89 +90,203 @@ libevdev_event_type_from_name(const char *name)
 LIBEVDEV_EXPORT int
 libevdev_event_type_from_name_n(const char *name, size_t len)
 {
-	struct name_lookup lookup;
-	const struct name_entry *entry;
+	return lookup_name(name, len, NAME_TYPE_EVENT_TYPE);
+}
 
-	lookup.name = name;
-	lookup.len = len;
+LIBEVDEV_EXPORT int
+libevdev_event_code_from_name(unsigned int type, const char *name)
+{
+	return libevdev_event_code_from_name_n(type, name, strlen(name));
+}
 
-	entry = lookup_name(ev_names, ARRAY_LENGTH(ev_names), &lookup);
+LIBEVDEV_EXPORT int
+libevdev_event_code_from_name_n(unsigned int type, const char *name, size_t len)
+{
+	/* the table knows the type of each code name, see name_type() in
+	   make-event-names.py */
+	if (type > EV_MAX)
+		return -1;
 
-	return entry ? (int)entry->value : -1;
+	return lookup_name(name, len, type);
 }
 
-static int type_from_prefix(const char *name, ssize_t len)
+LIBEVDEV_EXPORT int
+libevdev_property_from_name(const char *name)
 {
-	const char *e;
-	size_t i;
-	ssize_t l;
+	return libevdev_property_from_name_n(name, strlen(name));
+}
 
-	/* MAX_ is not allowed, even though EV_MAX exists */
-	if (startswith(name, len, "MAX_", 4))
-		return -1;
-	/* BTN_ is special as there is no EV_BTN type */
-	if (startswith(name, len, "BTN_", 4))
-		return EV_KEY;
-	/* FF_STATUS_ is special as FF_ is a prefix of it, so test it first */
-	if (startswith(name, len, "FF_STATUS_", 10))
-		return EV_FF_STATUS;
-
-	for (i = 0; i < ARRAY_LENGTH(ev_names); ++i) {
-		/* skip EV_ prefix so @e is suffix of [EV_]XYZ */
-		e = &ev_names[i].name[3];
-		l = strlen(e);
-
-		/* compare prefix and test for trailing _ */
-		if (len > l && startswith(name, len, e, l) && name[l] == '_')
-			return ev_names[i].value;
+LIBEVDEV_EXPORT int
+libevdev_property_from_name_n(const char *name, size_t len)
+{
+	return lookup_name(name, len, NAME_TYPE_PROPERTY);
+}
+
+/* seconds, '.', microseconds, three separators, value, '\n' */
+#define FORMAT_MAX_LEN (20 + 1 + 6 + 1 + EVENT_NAME_MAX_LEN + 1 + \
+			EVENT_NAME_MAX_LEN + 1 + 11 + 1)
+
+static const unsigned long long powers_of_10[] = {
+	1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL,
+	10000000ULL, 100000000ULL, 1000000000ULL, 10000000000ULL,
+	100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+	100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+	100000000000000000ULL, 1000000000000000000ULL,
+	10000000000000000000ULL,
+};
+
+static const char digit_pairs[] =
+	"00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+	"40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+	"8081828384858687888990919293949596979899";
+
+/**
+ * Write the decimal digits of v to the end of the buffer ending at end,
+ * two digits per division.
+ *
+ * @return a pointer to the first digit
+ */
+static inline char *
+format_uint(char *end, unsigned long long v)
+{
+	while (v >= 100) {
+		const char *pair = &digit_pairs[(v % 100) * 2];
+
+		v /= 100;
+		*--end = pair[1];
+		*--end = pair[0];
+	}
+
+	if (v >= 10) {
+		*--end = digit_pairs[v * 2 + 1];
+		*--end = digit_pairs[v * 2];
+	} else {
+		*--end = '0' + v;
 	}
 
-	return -1;
+	return end;
 }
 
-LIBEVDEV_EXPORT int
-libevdev_event_code_from_name(unsigned int type, const char *name)
+static inline char *
+append_int(char *p, long long v)
 {
-	return libevdev_event_code_from_name_n(type, name, strlen(name));
+	unsigned long long u = v;
+	unsigned int ndigits = 1;
+
+	if (v < 0) {
+		*p++ = '-';
+		u = -u;
+	}
+
+	/* digits are written in place, back to front */
+	while (ndigits < ARRAY_LENGTH(powers_of_10) && u >= powers_of_10[ndigits])
+		ndigits++;
+	format_uint(p + ndigits, u);
+
+	return p + ndigits;
 }
 
-LIBEVDEV_EXPORT int
-libevdev_event_code_from_name_n(unsigned int type, const char *name, size_t len)
+static inline char *
+append_name(char *p, const char *name, unsigned int len, unsigned int value)
 {
-	struct name_lookup lookup;
-	const struct name_entry *entry;
-	int real_type;
+	if (!name)
+		return append_int(p, value);
 
-	/* verify that @name is really of type @type */
-	real_type = type_from_prefix(name, len);
-	if (real_type < 0 || (unsigned int)real_type != type)
-		return -1;
+	while (len--)
+		*p++ = *name++;
+	return p;
+}
 
-	/* now look up the name @name and return the constant */
-	lookup.name = name;
-	lookup.len = len;
+/**
+ * Format ev into p, which must have room for FORMAT_MAX_LEN bytes.
+ *
+ * @return a pointer to the byte after the newline
+ */
+static char *
+format_event(char *p, const struct input_event *ev)
+{
+	const char *name = NULL;
+	unsigned int len = 0;
+	unsigned int usec = (unsigned long)ev->input_event_usec % 1000000;
+
+	p = append_int(p, ev->input_event_sec);
+	*p++ = '.';
+	memcpy(p, &digit_pairs[(usec / 10000) * 2], 2);
+	memcpy(p + 2, &digit_pairs[(usec / 100 % 100) * 2], 2);
+	memcpy(p + 4, &digit_pairs[(usec % 100) * 2], 2);
+	p += 6;
+	*p++ = ' ';
+
+	if (ev->type <= EV_MAX) {
+		name = ev_map[ev->type];
+		len = ev_len_map[ev->type];
+	}
+	p = append_name(p, name, len, ev->type);
+	*p++ = ' ';
+
+	name = NULL;
+	if (ev->type <= EV_MAX && event_type_map[ev->type] &&
+	    ev->code <= ev_max[ev->type]) {
+		name = event_type_map[ev->type][ev->code];
+		len = event_type_len_map[ev->type][ev->code];
+	}
+	p = append_name(p, name, len, ev->code);
+	*p++ = ' ';
 
-	entry = lookup_name(code_names, ARRAY_LENGTH(code_names), &lookup);
+	p = append_int(p, ev->value);
+	*p++ = '\n';
 
-	return entry ? (int)entry->value : -1;
+	return p;
 }
 
 LIBEVDEV_EXPORT int
-libevdev_property_from_name(const char *name)
+libevdev_event_format(const struct input_event *ev, char *buf, size_t size)
 {
-	return libevdev_property_from_name_n(name, strlen(name));
+	char line[FORMAT_MAX_LEN];
+	size_t len;
+
+	if (size > FORMAT_MAX_LEN)
+		len = format_event(buf, ev) - buf;
+	else {
+		len = format_event(line, ev) - line;
+		if (len >= size)
+			return -ENOSPC;
+		memcpy(buf, line, len);
+	}
+
+	buf[len] = '\0';
+
+	return len;
 }
 
 LIBEVDEV_EXPORT int
-libevdev_property_from_name_n(const char *name, size_t len)
+libevdev_events_format(const struct input_event *events, size_t nevents,
+		       char *buf, size_t size, size_t *len_out)
 {
-	struct name_lookup lookup;
-	const struct name_entry *entry;
+	size_t len = 0;
+	size_t i;
+
+	for (i = 0; i < nevents; i++) {
+		char line[FORMAT_MAX_LEN];
+		size_t n;
 
-	lookup.name = name;
-	lookup.len = len;
+		/* format in place as long as the longest line fits */
+		if (size - len > FORMAT_MAX_LEN) {
+			len += format_event(buf + len, &events[i]) - (buf + len);
+			continue;
+		}
+
+		n = format_event(line, &events[i]) - line;
+		if (n >= size - len)
+			break;
+		memcpy(buf + len, line, n);
+		len += n;
+	}
 
-	entry = lookup_name(prop_names, ARRAY_LENGTH(prop_names), &lookup);
+	if (size > 0)
+		buf[len] = '\0';
+	if (len_out)
+		*len_out = len;
 
-	return entry ? (int)entry->value : -1;
+	return i;
 }
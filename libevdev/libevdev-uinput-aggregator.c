@@ -0,0 +1,485 @@
+/*
+ * Copyright © 2026 The libevdev contributors
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided that
+ * the above copyright notice appear in all copies and that both that copyright
+ * notice and this permission notice appear in supporting documentation, and
+ * that the name of the copyright holders not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  The copyright holders make no representations
+ * about the suitability of this software for any purpose.  It is provided "as
+ * is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN NO
+ * EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+ * TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE
+ * OF THIS SOFTWARE.
+ */
+
+/*
+ * An aggregator merges several source devices into one uinput device
+ * with the union of their capabilities. The complete frames read from
+ * all sources are sorted by their timestamp and posted with a single
+ * write(). A key is pressed on the uinput device while at least one
+ * source holds it down, so a key held on two sources is only released
+ * once both released it.
+ */
+
+#include <config.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libevdev.h"
+#include "libevdev-int.h"
+#include "libevdev-uinput.h"
+#include "libevdev-util.h"
+
+struct aggregated_source {
+	struct libevdev *dev;
+	unsigned long keys_down[NLONGS(KEY_CNT)]; /**< as forwarded */
+	unsigned long keys_read[NLONGS(KEY_CNT)]; /**< after the queued frames */
+	size_t frame_start; /**< index of the incomplete frame in events */
+	size_t nframe; /**< events in the incomplete frame */
+	bool syncing;
+	struct input_event sync_time; /**< the SYN_DROPPED */
+};
+
+struct merged_frame {
+	unsigned int source;
+	size_t first;
+	size_t nevents;
+	int64_t time; /**< us, of the SYN_REPORT */
+};
+
+/* an array that grows as needed */
+#define ensure_space(_array, _size, _needed) \
+	({ int _rc = 0; \
+	   if ((_needed) > (_size)) { \
+		size_t _s = max((_size) * 2, (size_t)(_needed)); \
+		void *_a = realloc((_array), _s * sizeof(*(_array))); \
+		if (_a) { (_array) = _a; (_size) = _s; } else { _rc = -ENOMEM; } \
+	   } \
+	   _rc; })
+
+struct libevdev_uinput_aggregator {
+	struct libevdev_uinput *sink;
+	struct aggregated_source *sources;
+	unsigned int nsources;
+
+	unsigned short key_holders[KEY_CNT]; /**< sources holding each key */
+
+	/* complete frames of all sources, then the incomplete ones */
+	struct input_event *events;
+	size_t nevents;
+	size_t events_size;
+
+	struct merged_frame *frames;
+	size_t nframes;
+	size_t frames_size;
+
+	struct input_event *out;
+	size_t out_size;
+};
+
+static int
+merge_capabilities(struct libevdev *merged, struct libevdev * const *sources,
+		   unsigned int nsources)
+{
+	unsigned int i, type, code;
+
+	for (i = 0; i < nsources; i++) {
+		const struct libevdev *src = sources[i];
+
+		for (code = 0; code <= INPUT_PROP_MAX; code++) {
+			if (libevdev_has_property(src, code))
+				libevdev_enable_property(merged, code);
+		}
+
+		for (type = 0; type <= EV_MAX; type++) {
+			int max = libevdev_event_type_get_max(type);
+
+			if (!libevdev_has_event_type(src, type) || max == -1)
+				continue;
+
+			libevdev_enable_event_type(merged, type);
+
+			for (code = 0; code <= (unsigned int)max; code++) {
+				const void *data = NULL;
+				int value;
+
+				/* the first source with a code wins */
+				if (!libevdev_has_event_code(src, type, code) ||
+				    libevdev_has_event_code(merged, type, code))
+					continue;
+
+				if (type == EV_ABS) {
+					data = libevdev_get_abs_info(src, code);
+				} else if (type == EV_REP) {
+					value = libevdev_get_event_value(src, type, code);
+					data = &value;
+				}
+
+				if (libevdev_enable_event_code(merged, type, code, data) != 0)
+					return -ENOMEM;
+			}
+		}
+	}
+
+	return 0;
+}
+
+LIBEVDEV_EXPORT int
+libevdev_uinput_aggregator_new(struct libevdev * const *sources,
+			       unsigned int nsources,
+			       const char *name,
+			       int uinput_fd,
+			       struct libevdev_uinput_aggregator **aggregator_out)
+{
+	struct libevdev_uinput_aggregator *agg;
+	struct libevdev *merged;
+	unsigned int i;
+	int rc;
+
+	if (nsources == 0)
+		return -EINVAL;
+
+	agg = calloc(1, sizeof(*agg));
+	if (!agg)
+		return -ENOMEM;
+
+	agg->sources = calloc(nsources, sizeof(*agg->sources));
+	if (!agg->sources) {
+		free(agg);
+		return -ENOMEM;
+	}
+
+	merged = libevdev_new();
+	if (!merged) {
+		rc = -ENOMEM;
+		goto error;
+	}
+
+	libevdev_set_name(merged, name ? name : libevdev_get_name(sources[0]));
+	libevdev_set_id_bustype(merged, libevdev_get_id_bustype(sources[0]));
+	libevdev_set_id_vendor(merged, libevdev_get_id_vendor(sources[0]));
+	libevdev_set_id_product(merged, libevdev_get_id_product(sources[0]));
+	libevdev_set_id_version(merged, libevdev_get_id_version(sources[0]));
+
+	rc = merge_capabilities(merged, sources, nsources);
+	if (rc == 0)
+		rc = libevdev_uinput_create_from_device(merged, uinput_fd, &agg->sink);
+	libevdev_free(merged);
+	if (rc != 0)
+		goto error;
+
+	for (i = 0; i < nsources; i++) {
+		struct aggregated_source *s = &agg->sources[i];
+
+		/* keys down before now are up on the new uinput device, so
+		   they start as up here too and their release is dropped */
+		s->dev = sources[i];
+
+		rc = libevdev_grab(s->dev, LIBEVDEV_GRAB);
+		if (rc != 0)
+			goto error;
+		agg->nsources++;
+	}
+
+	*aggregator_out = agg;
+	return 0;
+
+error:
+	libevdev_uinput_aggregator_free(agg);
+	return rc;
+}
+
+LIBEVDEV_EXPORT void
+libevdev_uinput_aggregator_free(struct libevdev_uinput_aggregator *agg)
+{
+	unsigned int i;
+
+	if (!agg)
+		return;
+
+	for (i = 0; i < agg->nsources; i++)
+		libevdev_grab(agg->sources[i].dev, LIBEVDEV_UNGRAB);
+	libevdev_uinput_destroy(agg->sink);
+	free(agg->sources);
+	free(agg->events);
+	free(agg->frames);
+	free(agg->out);
+	free(agg);
+}
+
+LIBEVDEV_EXPORT struct libevdev_uinput *
+libevdev_uinput_aggregator_get_uinput(const struct libevdev_uinput_aggregator *agg)
+{
+	return agg->sink;
+}
+
+/**
+ * Update the source's key state and the number of sources holding the
+ * key.
+ *
+ * @return true if the merged key state changed
+ */
+static bool
+update_key(struct libevdev_uinput_aggregator *agg,
+	   struct aggregated_source *s, unsigned int code, int value)
+{
+	bool down = value != 0;
+
+	if (bit_is_set(s->keys_down, code) == down)
+		return false;
+
+	set_bit_state(s->keys_down, code, down);
+	if (down)
+		return agg->key_holders[code]++ == 0;
+	else
+		return --agg->key_holders[code] == 0;
+}
+
+static int
+add_frame(struct libevdev_uinput_aggregator *agg, unsigned int source,
+	  size_t first, size_t nevents)
+{
+	const struct input_event *syn = &agg->events[first + nevents - 1];
+	struct merged_frame *frame;
+
+	if (ensure_space(agg->frames, agg->frames_size, agg->nframes + 1) != 0)
+		return -ENOMEM;
+
+	frame = &agg->frames[agg->nframes++];
+	frame->source = source;
+	frame->first = first;
+	frame->nevents = nevents;
+	frame->time = (int64_t)syn->input_event_sec * 1000000 +
+		      syn->input_event_usec;
+
+	return 0;
+}
+
+/**
+ * Apply the key events of a complete frame to keys_read.
+ */
+static void
+read_keys(struct aggregated_source *s, const struct input_event *events,
+	  size_t nevents)
+{
+	size_t i;
+
+	for (i = 0; i < nevents; i++) {
+		if (events[i].type == EV_KEY && events[i].value != 2)
+			set_bit_state(s->keys_read, events[i].code,
+				      events[i].value != 0);
+	}
+}
+
+/**
+ * After a SYN_DROPPED, the source's sync events are forwarded as one
+ * frame. Key events are replaced by the difference between the key state
+ * after the frames queued so far and the device's state: libevdev's sync
+ * events don't include the keys of the discarded incomplete frame, and
+ * frames read before the SYN_DROPPED are not forwarded yet.
+ */
+static int
+finish_sync(struct libevdev_uinput_aggregator *agg, unsigned int source)
+{
+	struct aggregated_source *s = &agg->sources[source];
+	struct input_event *ev;
+	unsigned int code;
+
+	for (code = 0; code <= KEY_MAX; code++) {
+		int value = libevdev_get_event_value(s->dev, EV_KEY, code);
+
+		if (bit_is_set(s->keys_read, code) == !!value)
+			continue;
+
+		if (ensure_space(agg->events, agg->events_size, agg->nevents + 1) != 0)
+			return -ENOMEM;
+
+		ev = &agg->events[agg->nevents++];
+		*ev = s->sync_time;
+		ev->type = EV_KEY;
+		ev->code = code;
+		ev->value = value;
+		s->nframe++;
+		set_bit_state(s->keys_read, code, value != 0);
+	}
+
+	if (s->nframe == 0)
+		return 0;
+
+	if (ensure_space(agg->events, agg->events_size, agg->nevents + 1) != 0)
+		return -ENOMEM;
+
+	ev = &agg->events[agg->nevents++];
+	*ev = s->sync_time;
+	ev->type = EV_SYN;
+	ev->code = SYN_REPORT;
+	ev->value = 0;
+	s->nframe++;
+
+	return add_frame(agg, source, s->frame_start, s->nframe);
+}
+
+static int
+read_source(struct libevdev_uinput_aggregator *agg, unsigned int source)
+{
+	struct aggregated_source *s = &agg->sources[source];
+
+	/* move the incomplete frame from the last dispatch to the end */
+	if (s->nframe > 0) {
+		if (ensure_space(agg->events, agg->events_size,
+				 agg->nevents + s->nframe) != 0)
+			return -ENOMEM;
+		memmove(&agg->events[agg->nevents], &agg->events[s->frame_start],
+			s->nframe * sizeof(*agg->events));
+	}
+	s->frame_start = agg->nevents;
+	agg->nevents += s->nframe;
+
+	while (true) {
+		unsigned int flags = s->syncing ? LIBEVDEV_READ_FLAG_SYNC :
+						  LIBEVDEV_READ_FLAG_NORMAL;
+		struct input_event *ev;
+		int rc;
+
+		if (ensure_space(agg->events, agg->events_size, agg->nevents + 1) != 0)
+			return -ENOMEM;
+
+		ev = &agg->events[agg->nevents];
+		rc = libevdev_next_event(s->dev, flags, ev);
+		if (rc == -EAGAIN) {
+			if (!s->syncing)
+				return 0;
+
+			s->syncing = false;
+			rc = finish_sync(agg, source);
+			if (rc != 0)
+				return rc;
+			s->frame_start = agg->nevents;
+			s->nframe = 0;
+			continue;
+		} else if (rc < 0) {
+			return rc;
+		}
+
+		if (rc == LIBEVDEV_READ_STATUS_SYNC && !s->syncing) {
+			/* drop the incomplete frame */
+			agg->nevents = s->frame_start;
+			s->nframe = 0;
+			s->syncing = true;
+			s->sync_time = *ev;
+			continue;
+		}
+
+		/* keys are compared in finish_sync(), which also adds the
+		   SYN_REPORT */
+		if (s->syncing &&
+		    (ev->type == EV_KEY ||
+		     (ev->type == EV_SYN && ev->code == SYN_REPORT)))
+			continue;
+
+		agg->nevents++;
+		s->nframe++;
+
+		if (ev->type == EV_SYN && ev->code == SYN_REPORT) {
+			read_keys(s, &agg->events[s->frame_start], s->nframe);
+			rc = add_frame(agg, source, s->frame_start, s->nframe);
+			if (rc != 0)
+				return rc;
+			s->frame_start = agg->nevents;
+			s->nframe = 0;
+		}
+	}
+}
+
+static int
+cmp_frames(const void *a, const void *b)
+{
+	const struct merged_frame *fa = a, *fb = b;
+
+	if (fa->time != fb->time)
+		return fa->time < fb->time ? -1 : 1;
+
+	/* keep the read order for identical timestamps */
+	return fa->first < fb->first ? -1 : fa->first > fb->first;
+}
+
+LIBEVDEV_EXPORT int
+libevdev_uinput_aggregator_dispatch(struct libevdev_uinput_aggregator *agg)
+{
+	size_t nout = 0, i, j, nincomplete = 0;
+	unsigned int source;
+	int rc = 0;
+
+	/* the incomplete frames of the last dispatch are at the start */
+	for (source = 0; source < agg->nsources; source++)
+		nincomplete += agg->sources[source].nframe;
+	agg->nevents = nincomplete;
+	agg->nframes = 0;
+
+	/* a failing source doesn't hold up the others */
+	for (source = 0; source < agg->nsources; source++) {
+		int src_rc = read_source(agg, source);
+		if (rc == 0)
+			rc = src_rc;
+	}
+
+	qsort(agg->frames, agg->nframes, sizeof(*agg->frames), cmp_frames);
+
+	if (ensure_space(agg->out, agg->out_size, agg->nevents) != 0) {
+		rc = -ENOMEM;
+		agg->nframes = 0;
+	}
+
+	for (i = 0; i < agg->nframes; i++) {
+		const struct merged_frame *frame = &agg->frames[i];
+		struct aggregated_source *s = &agg->sources[frame->source];
+		size_t frame_start = nout;
+
+		for (j = 0; j < frame->nevents; j++) {
+			const struct input_event *ev = &agg->events[frame->first + j];
+
+			if (ev->type == EV_KEY && ev->value != 2 &&
+			    !update_key(agg, s, ev->code, ev->value))
+				continue;
+			/* a repeat only while this source holds the key */
+			if (ev->type == EV_KEY && ev->value == 2 &&
+			    !bit_is_set(s->keys_down, ev->code))
+				continue;
+
+			agg->out[nout++] = *ev;
+		}
+
+		/* nothing left but the SYN_REPORT */
+		if (nout - frame_start == 1)
+			nout = frame_start;
+	}
+
+	/* keep the incomplete frames for the next dispatch */
+	for (source = 0, nincomplete = 0; source < agg->nsources; source++) {
+		struct aggregated_source *s = &agg->sources[source];
+
+		if (s->nframe == 0)
+			continue;
+		memmove(&agg->events[nincomplete], &agg->events[s->frame_start],
+			s->nframe * sizeof(*agg->events));
+		s->frame_start = nincomplete;
+		nincomplete += s->nframe;
+	}
+
+	if (nout > 0) {
+		int wrc = libevdev_uinput_write_events(agg->sink, agg->out, nout);
+		if (rc == 0)
+			rc = wrc;
+	}
+
+	return rc;
+}
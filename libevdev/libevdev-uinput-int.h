@@ -20,11 +20,20 @@
  * OF THIS SOFTWARE.
  */
 
+struct uinput_frame;
+
 struct libevdev_uinput {
 	int fd; /**< file descriptor to uinput */
 	int fd_is_managed; /**< do we need to close it? */
 	char *name; /**< device name */
 	char *syspath; /**< /sys path */
 	char *devnode; /**< device node */
+	int syspath_fetched; /**< syspath and devnode were looked up */
 	time_t ctime[2]; /**< before/after UI_DEV_CREATE */
+	int num_slots; /**< ABS_MT_SLOT maximum + 1, -1 without slots */
+	unsigned long abs_fuzzed[NLONGS(ABS_CNT)]; /**< axes with a fuzz */
+	struct uinput_frame *frame; /**< NULL until the frame builder is used */
 };
+
+extern void
+_libevdev_uinput_discard_frame(struct libevdev_uinput *uinput_dev);
@@ -0,0 +1,358 @@
+/*
+ * Copyright © 2026 The libevdev contributors
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided that
+ * the above copyright notice appear in all copies and that both that copyright
+ * notice and this permission notice appear in supporting documentation, and
+ * that the name of the copyright holders not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  The copyright holders make no representations
+ * about the suitability of this software for any purpose.  It is provided "as
+ * is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN NO
+ * EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+ * TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE
+ * OF THIS SOFTWARE.
+ */
+
+/*
+ * A pool of uinput devices, keyed by the binary description of the device
+ * they were created from without its axis values. Released devices are
+ * reset and handed out again for the same description, so UI_DEV_CREATE
+ * and UI_DEV_DESTROY are only needed once per shape.
+ */
+
+#include <config.h>
+#include <errno.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/uinput.h>
+
+#include "libevdev.h"
+#include "libevdev-int.h"
+#include "libevdev-uinput.h"
+#include "libevdev-uinput-int.h"
+#include "libevdev-util.h"
+
+struct pool_entry {
+	struct libevdev_uinput *uinput_dev;
+	struct libevdev *desc; /**< the device as described, for the reset */
+	void *key; /**< the binary description, without the axis values */
+	size_t keylen;
+	uint64_t hash;
+	bool in_use;
+};
+
+struct libevdev_uinput_pool {
+	struct pool_entry *entries;
+	size_t nentries;
+	size_t size;
+};
+
+static int
+reset_state(struct libevdev_uinput *uinput_dev, const struct libevdev *desc);
+
+static uint64_t
+hash_key(const void *key, size_t len)
+{
+	const unsigned char *p = key;
+	uint64_t h = 0xcbf29ce484222325ULL;
+	size_t i;
+
+	for (i = 0; i < len; i++) {
+		h ^= p[i];
+		h *= 0x100000001b3ULL;
+	}
+
+	return h;
+}
+
+static void
+entry_destroy(struct pool_entry *entry)
+{
+	libevdev_uinput_destroy(entry->uinput_dev);
+	libevdev_free(entry->desc);
+	free(entry->key);
+}
+
+LIBEVDEV_EXPORT int
+libevdev_uinput_pool_new(struct libevdev_uinput_pool **pool_out)
+{
+	struct libevdev_uinput_pool *pool;
+
+	pool = calloc(1, sizeof(*pool));
+	if (!pool)
+		return -ENOMEM;
+
+	*pool_out = pool;
+	return 0;
+}
+
+LIBEVDEV_EXPORT void
+libevdev_uinput_pool_free(struct libevdev_uinput_pool *pool)
+{
+	size_t i;
+
+	if (!pool)
+		return;
+
+	for (i = 0; i < pool->nentries; i++)
+		entry_destroy(&pool->entries[i]);
+	free(pool->entries);
+	free(pool);
+}
+
+/**
+ * Take over the axis values of dev, they are not part of the key.
+ */
+static void
+copy_abs_values(struct libevdev *desc, const struct libevdev *dev)
+{
+	unsigned int code;
+
+	for (code = 0; code <= ABS_MAX; code++) {
+		if (code >= ABS_MT_MIN && code <= ABS_MT_MAX)
+			continue;
+		if (libevdev_has_event_code(desc, EV_ABS, code))
+			libevdev_set_event_value(desc, EV_ABS, code,
+						 libevdev_get_event_value(dev, EV_ABS, code));
+	}
+
+	if (libevdev_get_num_slots(desc) > 0 &&
+	    libevdev_get_current_slot(dev) >= 0)
+		libevdev_set_event_value(desc, EV_ABS, ABS_MT_SLOT,
+					 libevdev_get_current_slot(dev));
+}
+
+LIBEVDEV_EXPORT int
+libevdev_uinput_pool_acquire(struct libevdev_uinput_pool *pool,
+			     const struct libevdev *dev,
+			     struct libevdev_uinput **uinput_dev)
+{
+	struct pool_entry *entry;
+	void *key;
+	int len, rc;
+	uint64_t hash;
+	size_t i;
+
+	/* the axis values are state, not shape: a device that only differs
+	   in them can be reused after posting the new values */
+	len = _libevdev_serialize_capabilities(dev, NULL, 0);
+	if (len < 0)
+		return len;
+
+	key = malloc(len);
+	if (!key)
+		return -ENOMEM;
+	_libevdev_serialize_capabilities(dev, key, len);
+	hash = hash_key(key, len);
+
+	for (i = 0; i < pool->nentries; i++) {
+		entry = &pool->entries[i];
+
+		if (entry->in_use || entry->hash != hash ||
+		    entry->keylen != (size_t)len ||
+		    memcmp(entry->key, key, len) != 0)
+			continue;
+
+		free(key);
+		copy_abs_values(entry->desc, dev);
+		rc = reset_state(entry->uinput_dev, entry->desc);
+		if (rc != 0) {
+			entry_destroy(entry);
+			*entry = pool->entries[--pool->nentries];
+			return rc;
+		}
+
+		entry->in_use = true;
+		*uinput_dev = entry->uinput_dev;
+		return 0;
+	}
+
+	if (pool->nentries == pool->size) {
+		size_t size = max(pool->size * 2, (size_t)8);
+		struct pool_entry *entries;
+
+		entries = realloc(pool->entries, size * sizeof(*entries));
+		if (!entries) {
+			free(key);
+			return -ENOMEM;
+		}
+		pool->entries = entries;
+		pool->size = size;
+	}
+
+	entry = &pool->entries[pool->nentries];
+	memset(entry, 0, sizeof(*entry));
+	entry->key = key;
+	entry->keylen = len;
+	entry->hash = hash;
+
+	rc = libevdev_new_from_description(key, len, &entry->desc);
+	if (rc == 0) {
+		copy_abs_values(entry->desc, dev);
+		rc = libevdev_uinput_create_from_device(dev,
+							LIBEVDEV_UINPUT_OPEN_MANAGED,
+							&entry->uinput_dev);
+	}
+	if (rc != 0) {
+		entry_destroy(entry);
+		return rc;
+	}
+
+	entry->in_use = true;
+	pool->nentries++;
+	*uinput_dev = entry->uinput_dev;
+
+	return 0;
+}
+
+static inline void
+add_event(struct input_event *events, size_t *nevents,
+	  unsigned int type, unsigned int code, int value)
+{
+	struct input_event *ev = &events[(*nevents)++];
+
+	memset(ev, 0, sizeof(*ev));
+	ev->type = type;
+	ev->code = code;
+	ev->value = value;
+}
+
+/**
+ * Post the events that return the device to the state it was created
+ * with: keys, switches, LEDs and sounds off, axes at their initial value
+ * and no touches. The kernel drops the ones that don't change anything.
+ */
+static int
+reset_state(struct libevdev_uinput *uinput_dev, const struct libevdev *desc)
+{
+	static const unsigned int bool_types[] = { EV_KEY, EV_SW, EV_LED, EV_SND };
+	struct input_event *events;
+	size_t nevents = 0;
+	int nslots = libevdev_get_num_slots(desc);
+	unsigned int i, code;
+	int slot, rc;
+
+	events = calloc(KEY_CNT + SW_CNT + LED_CNT + SND_CNT + ABS_CNT +
+			2 * max(nslots, 0) + 2, sizeof(*events));
+	if (!events)
+		return -ENOMEM;
+
+	for (i = 0; i < ARRAY_LENGTH(bool_types); i++) {
+		unsigned int type = bool_types[i];
+		int max = libevdev_event_type_get_max(type);
+
+		for (code = 0; code <= (unsigned int)max; code++) {
+			if (libevdev_has_event_code(desc, type, code))
+				add_event(events, &nevents, type, code, 0);
+		}
+	}
+
+	for (code = 0; code <= ABS_MAX; code++) {
+		if (code >= ABS_MT_MIN && code <= ABS_MT_MAX)
+			continue;
+		if (libevdev_has_event_code(desc, EV_ABS, code))
+			add_event(events, &nevents, EV_ABS, code,
+				  libevdev_get_event_value(desc, EV_ABS, code));
+	}
+
+	for (slot = 0; slot < nslots; slot++) {
+		add_event(events, &nevents, EV_ABS, ABS_MT_SLOT, slot);
+		add_event(events, &nevents, EV_ABS, ABS_MT_TRACKING_ID, -1);
+	}
+	if (nslots > 0)
+		add_event(events, &nevents, EV_ABS, ABS_MT_SLOT,
+			  libevdev_get_current_slot(desc));
+
+	add_event(events, &nevents, EV_SYN, SYN_REPORT, 0);
+
+	rc = libevdev_uinput_write_events(uinput_dev, events, nevents);
+	free(events);
+
+	return rc;
+}
+
+/**
+ * Discard everything the previous user didn't read from the uinput fd.
+ * Force feedback requests must be answered or the client that issued
+ * them blocks until the kernel's timeout, uploads are refused and
+ * erases succeed.
+ */
+static void
+drain_requests(int fd)
+{
+	struct pollfd pfd = { fd, POLLIN, 0 };
+	struct input_event ev;
+
+	while (poll(&pfd, 1, 0) == 1 && (pfd.revents & POLLIN)) {
+		if (read(fd, &ev, sizeof(ev)) != sizeof(ev))
+			break;
+
+		if (ev.type != EV_UINPUT)
+			continue;
+
+		if (ev.code == UI_FF_UPLOAD) {
+			struct uinput_ff_upload upload;
+
+			memset(&upload, 0, sizeof(upload));
+			upload.request_id = ev.value;
+			if (ioctl(fd, UI_BEGIN_FF_UPLOAD, &upload) == 0) {
+				upload.retval = -ENODEV;
+				(void)ioctl(fd, UI_END_FF_UPLOAD, &upload);
+			}
+		} else if (ev.code == UI_FF_ERASE) {
+			struct uinput_ff_erase erase;
+
+			memset(&erase, 0, sizeof(erase));
+			erase.request_id = ev.value;
+			if (ioctl(fd, UI_BEGIN_FF_ERASE, &erase) == 0) {
+				erase.retval = 0;
+				(void)ioctl(fd, UI_END_FF_ERASE, &erase);
+			}
+		}
+	}
+}
+
+LIBEVDEV_EXPORT void
+libevdev_uinput_pool_release(struct libevdev_uinput_pool *pool,
+			     struct libevdev_uinput *uinput_dev)
+{
+	struct pool_entry *entry = NULL;
+	size_t i;
+
+	for (i = 0; i < pool->nentries; i++) {
+		if (pool->entries[i].uinput_dev == uinput_dev &&
+		    pool->entries[i].in_use) {
+			entry = &pool->entries[i];
+			break;
+		}
+	}
+
+	if (!entry) {
+		log_bug(NULL, "uinput device %p is not in use in this pool\n",
+			uinput_dev);
+		return;
+	}
+
+	_libevdev_uinput_discard_frame(uinput_dev);
+
+	/* LED and sound events go back to the uinput fd, drain afterwards */
+	if (reset_state(uinput_dev, entry->desc) != 0) {
+		entry_destroy(entry);
+		*entry = pool->entries[--pool->nentries];
+		return;
+	}
+
+	drain_requests(uinput_dev->fd);
+
+	entry->in_use = false;
+}
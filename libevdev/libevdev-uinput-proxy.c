@@ -0,0 +1,194 @@
+/*
+ * Copyright © 2026 The libevdev contributors
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided that
+ * the above copyright notice appear in all copies and that both that copyright
+ * notice and this permission notice appear in supporting documentation, and
+ * that the name of the copyright holders not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  The copyright holders make no representations
+ * about the suitability of this software for any purpose.  It is provided "as
+ * is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN NO
+ * EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+ * TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE
+ * OF THIS SOFTWARE.
+ */
+
+/*
+ * A proxy grabs a source device and forwards its events to a uinput clone
+ * of it. The events are collected until the SYN_REPORT and the frame is
+ * posted with a single write(). After a SYN_DROPPED, the incomplete frame
+ * is discarded and the sync events, which bring the clone to the
+ * source's current state, are forwarded as one frame instead.
+ */
+
+#include <config.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libevdev.h"
+#include "libevdev-int.h"
+#include "libevdev-uinput.h"
+#include "libevdev-util.h"
+
+struct libevdev_uinput_proxy {
+	struct libevdev *source;
+	struct libevdev_uinput *sink;
+
+	libevdev_uinput_proxy_filter_func_t filter;
+	void *filter_data;
+
+	struct input_event *events; /**< the frame in progress */
+	unsigned int nevents;
+	unsigned int size;
+	bool syncing;
+};
+
+LIBEVDEV_EXPORT int
+libevdev_uinput_proxy_new(struct libevdev *source, int uinput_fd,
+			  struct libevdev_uinput_proxy **proxy_out)
+{
+	struct libevdev_uinput_proxy *proxy;
+	int rc;
+
+	proxy = calloc(1, sizeof(*proxy));
+	if (!proxy)
+		return -ENOMEM;
+
+	proxy->source = source;
+	proxy->size = 64;
+	proxy->events = calloc(proxy->size, sizeof(*proxy->events));
+	if (!proxy->events) {
+		rc = -ENOMEM;
+		goto error;
+	}
+
+	rc = libevdev_uinput_create_from_device(source, uinput_fd, &proxy->sink);
+	if (rc != 0)
+		goto error;
+
+	rc = libevdev_grab(source, LIBEVDEV_GRAB);
+	if (rc != 0)
+		goto error;
+
+	*proxy_out = proxy;
+	return 0;
+
+error:
+	libevdev_uinput_destroy(proxy->sink);
+	free(proxy->events);
+	free(proxy);
+	return rc;
+}
+
+LIBEVDEV_EXPORT void
+libevdev_uinput_proxy_free(struct libevdev_uinput_proxy *proxy)
+{
+	if (!proxy)
+		return;
+
+	libevdev_grab(proxy->source, LIBEVDEV_UNGRAB);
+	libevdev_uinput_destroy(proxy->sink);
+	free(proxy->events);
+	free(proxy);
+}
+
+LIBEVDEV_EXPORT struct libevdev_uinput *
+libevdev_uinput_proxy_get_uinput(const struct libevdev_uinput_proxy *proxy)
+{
+	return proxy->sink;
+}
+
+LIBEVDEV_EXPORT void
+libevdev_uinput_proxy_set_filter(struct libevdev_uinput_proxy *proxy,
+				 libevdev_uinput_proxy_filter_func_t filter,
+				 void *data)
+{
+	proxy->filter = filter;
+	proxy->filter_data = data;
+}
+
+static int
+forward_frame(struct libevdev_uinput_proxy *proxy)
+{
+	unsigned int nevents = proxy->nevents;
+
+	proxy->nevents = 0;
+
+	if (proxy->filter)
+		nevents = min(proxy->filter(proxy->events, nevents,
+					    proxy->filter_data),
+			      nevents);
+
+	/* the kernel drops a SYN_REPORT on its own anyway */
+	if (nevents == 0 ||
+	    (nevents == 1 && proxy->events[0].type == EV_SYN))
+		return 0;
+
+	return libevdev_uinput_write_events(proxy->sink, proxy->events, nevents);
+}
+
+LIBEVDEV_EXPORT int
+libevdev_uinput_proxy_dispatch(struct libevdev_uinput_proxy *proxy)
+{
+	struct libevdev *source = proxy->source;
+
+	while (true) {
+		unsigned int flags = proxy->syncing ? LIBEVDEV_READ_FLAG_SYNC :
+						      LIBEVDEV_READ_FLAG_NORMAL;
+		struct input_event *ev;
+		int rc;
+
+		if (proxy->nevents == proxy->size) {
+			unsigned int size = proxy->size * 2;
+			struct input_event *events;
+
+			events = realloc(proxy->events, size * sizeof(*events));
+			if (!events)
+				return -ENOMEM;
+
+			proxy->events = events;
+			proxy->size = size;
+		}
+
+		ev = &proxy->events[proxy->nevents];
+		rc = libevdev_next_event(source, flags, ev);
+		if (rc == -EAGAIN) {
+			if (!proxy->syncing)
+				return 0;
+
+			/* the sync is complete, continue normally */
+			proxy->syncing = false;
+			continue;
+		} else if (rc < 0) {
+			return rc;
+		}
+
+		if (rc == LIBEVDEV_READ_STATUS_SYNC && !proxy->syncing) {
+			/* ev is the SYN_DROPPED, the sync events replace
+			   the incomplete frame */
+			proxy->nevents = 0;
+			proxy->syncing = true;
+			continue;
+		}
+
+		proxy->nevents++;
+		if (ev->type != EV_SYN || ev->code != SYN_REPORT)
+			continue;
+
+		rc = forward_frame(proxy);
+		if (rc != 0)
+			return rc;
+
+		/* avoid a read() that only returns -EAGAIN */
+		if (!proxy->syncing && !has_buffered_events(source))
+			return 0;
+	}
+}
@@ -0,0 +1,352 @@
+/*
+ * Copyright © 2026 The libevdev contributors
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided that
+ * the above copyright notice appear in all copies and that both that copyright
+ * notice and this permission notice appear in supporting documentation, and
+ * that the name of the copyright holders not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  The copyright holders make no representations
+ * about the suitability of this software for any purpose.  It is provided "as
+ * is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN NO
+ * EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+ * TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE
+ * OF THIS SOFTWARE.
+ */
+
+/*
+ * Replay of recorded events through a uinput device. The events are split
+ * into frames at each SYN_REPORT, each frame gets an absolute deadline
+ * from its timestamp relative to the first frame, scaled by the speed.
+ * A frame is posted with a single write() once its deadline passed, the
+ * difference between the time of the write and the deadline is recorded
+ * as the frame's timing error.
+ */
+
+#include <config.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/timerfd.h>
+
+#include "libevdev.h"
+#include "libevdev-int.h"
+#include "libevdev-uinput.h"
+#include "libevdev-util.h"
+
+struct replay_frame {
+	size_t first; /**< index of the first event */
+	size_t nevents;
+	uint64_t offset; /**< ns after the first frame, at normal speed */
+};
+
+struct libevdev_uinput_replay {
+	struct libevdev_uinput *uinput_dev;
+	double speed; /**< 0 for as fast as possible */
+
+	struct input_event *events;
+	struct replay_frame *frames;
+	size_t nframes;
+	size_t next_frame;
+
+	bool started;
+	uint64_t start; /**< CLOCK_MONOTONIC of the first deadline */
+	int timerfd;
+
+	int64_t *errors; /**< [nframes], ns late */
+	bool errors_sorted;
+};
+
+static uint64_t
+now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static inline struct timespec
+ns_to_timespec(uint64_t ns)
+{
+	struct timespec ts;
+
+	ts.tv_sec = ns / 1000000000;
+	ts.tv_nsec = ns % 1000000000;
+	return ts;
+}
+
+static inline int64_t
+event_time_ns(const struct input_event *ev)
+{
+	return (int64_t)ev->input_event_sec * 1000000000 +
+	       (int64_t)ev->input_event_usec * 1000;
+}
+
+LIBEVDEV_EXPORT int
+libevdev_uinput_replay_new(struct libevdev_uinput *uinput_dev,
+			   const struct input_event *events,
+			   size_t nevents,
+			   double speed,
+			   struct libevdev_uinput_replay **replay_out)
+{
+	struct libevdev_uinput_replay *replay;
+	int64_t first_time = 0, last_offset = 0;
+	size_t i, first = 0;
+
+	if (!(speed >= 0))
+		return -EINVAL;
+
+	for (i = 0; i < nevents; i++) {
+		int max = libevdev_event_type_get_max(events[i].type);
+
+		if (max == -1 || events[i].code > (unsigned int)max)
+			return -EINVAL;
+	}
+
+	replay = calloc(1, sizeof(*replay));
+	if (!replay)
+		return -ENOMEM;
+
+	replay->uinput_dev = uinput_dev;
+	replay->speed = speed;
+	replay->timerfd = -1;
+	replay->events = calloc(max(nevents, (size_t)1), sizeof(*replay->events));
+	/* at most one frame per event */
+	replay->frames = calloc(max(nevents, (size_t)1), sizeof(*replay->frames));
+	replay->errors = calloc(max(nevents, (size_t)1), sizeof(*replay->errors));
+	if (!replay->events || !replay->frames || !replay->errors) {
+		libevdev_uinput_replay_free(replay);
+		return -ENOMEM;
+	}
+
+	memcpy(replay->events, events, nevents * sizeof(*events));
+
+	for (i = 0; i < nevents; i++) {
+		const struct input_event *ev = &events[i];
+		struct replay_frame *frame;
+		int64_t offset;
+
+		/* trailing events without a SYN_REPORT are a frame too */
+		if (!(ev->type == EV_SYN && ev->code == SYN_REPORT) &&
+		    i < nevents - 1)
+			continue;
+
+		if (replay->nframes == 0)
+			first_time = event_time_ns(ev);
+
+		/* a recording that goes back in time is replayed without
+		   waiting */
+		offset = max(event_time_ns(ev) - first_time, last_offset);
+		last_offset = offset;
+
+		frame = &replay->frames[replay->nframes++];
+		frame->first = first;
+		frame->nevents = i - first + 1;
+		frame->offset = offset;
+		first = i + 1;
+	}
+
+	*replay_out = replay;
+	return 0;
+}
+
+LIBEVDEV_EXPORT void
+libevdev_uinput_replay_free(struct libevdev_uinput_replay *replay)
+{
+	if (!replay)
+		return;
+
+	if (replay->timerfd != -1)
+		close(replay->timerfd);
+	free(replay->events);
+	free(replay->frames);
+	free(replay->errors);
+	free(replay);
+}
+
+static uint64_t
+deadline(const struct libevdev_uinput_replay *replay, size_t frame)
+{
+	if (replay->speed == 0)
+		return replay->start;
+
+	return replay->start +
+	       (uint64_t)(replay->frames[frame].offset / replay->speed);
+}
+
+static void
+start(struct libevdev_uinput_replay *replay)
+{
+	if (replay->started)
+		return;
+
+	replay->started = true;
+	replay->start = now_ns();
+}
+
+static int
+write_frame(struct libevdev_uinput_replay *replay)
+{
+	size_t idx = replay->next_frame;
+	const struct replay_frame *frame = &replay->frames[idx];
+	int rc;
+
+	replay->errors[idx] = replay->speed == 0 ? 0 :
+			      (int64_t)(now_ns() - deadline(replay, idx));
+	replay->errors_sorted = false;
+
+	rc = libevdev_uinput_write_events(replay->uinput_dev,
+					  &replay->events[frame->first],
+					  frame->nevents);
+	if (rc == 0)
+		replay->next_frame++;
+
+	return rc;
+}
+
+LIBEVDEV_EXPORT int
+libevdev_uinput_replay_run(struct libevdev_uinput_replay *replay)
+{
+	start(replay);
+
+	while (replay->next_frame < replay->nframes) {
+		int rc;
+
+		if (replay->speed != 0) {
+			struct timespec ts = ns_to_timespec(deadline(replay, replay->next_frame));
+
+			do {
+				rc = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME,
+						     &ts, NULL);
+			} while (rc == EINTR);
+			if (rc != 0)
+				return -rc;
+		}
+
+		rc = write_frame(replay);
+		if (rc != 0)
+			return rc;
+	}
+
+	return 0;
+}
+
+static int
+arm_timer(struct libevdev_uinput_replay *replay)
+{
+	struct itimerspec its;
+
+	memset(&its, 0, sizeof(its));
+	if (replay->next_frame < replay->nframes) {
+		its.it_value = ns_to_timespec(deadline(replay, replay->next_frame));
+		/* a zero it_value disarms the timer */
+		if (its.it_value.tv_sec == 0 && its.it_value.tv_nsec == 0)
+			its.it_value.tv_nsec = 1;
+	}
+
+	if (timerfd_settime(replay->timerfd, TFD_TIMER_ABSTIME, &its, NULL) < 0)
+		return -errno;
+
+	return 0;
+}
+
+LIBEVDEV_EXPORT int
+libevdev_uinput_replay_get_fd(struct libevdev_uinput_replay *replay)
+{
+	int rc;
+
+	if (replay->timerfd != -1)
+		return replay->timerfd;
+
+	replay->timerfd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC|TFD_NONBLOCK);
+	if (replay->timerfd < 0) {
+		replay->timerfd = -1;
+		return -errno;
+	}
+
+	start(replay);
+
+	rc = arm_timer(replay);
+	if (rc != 0) {
+		close(replay->timerfd);
+		replay->timerfd = -1;
+		return rc;
+	}
+
+	return replay->timerfd;
+}
+
+LIBEVDEV_EXPORT int
+libevdev_uinput_replay_dispatch(struct libevdev_uinput_replay *replay)
+{
+	uint64_t expirations;
+	uint64_t now;
+	int rc;
+
+	if (replay->timerfd != -1)
+		(void)read(replay->timerfd, &expirations, sizeof(expirations));
+
+	start(replay);
+
+	now = now_ns();
+	while (replay->next_frame < replay->nframes &&
+	       deadline(replay, replay->next_frame) <= now) {
+		rc = write_frame(replay);
+		if (rc != 0)
+			return rc;
+	}
+
+	if (replay->timerfd != -1) {
+		rc = arm_timer(replay);
+		if (rc != 0)
+			return rc;
+	}
+
+	return replay->next_frame < replay->nframes ? 1 : 0;
+}
+
+LIBEVDEV_EXPORT unsigned int
+libevdev_uinput_replay_get_num_frames(const struct libevdev_uinput_replay *replay)
+{
+	return replay->nframes;
+}
+
+LIBEVDEV_EXPORT unsigned int
+libevdev_uinput_replay_get_num_frames_written(const struct libevdev_uinput_replay *replay)
+{
+	return replay->next_frame;
+}
+
+static int
+cmp_error(const void *a, const void *b)
+{
+	int64_t ea = *(const int64_t *)a, eb = *(const int64_t *)b;
+
+	return ea < eb ? -1 : ea > eb;
+}
+
+LIBEVDEV_EXPORT int64_t
+libevdev_uinput_replay_get_timing_error(struct libevdev_uinput_replay *replay,
+					unsigned int percentile)
+{
+	size_t n = replay->next_frame;
+
+	if (n == 0 || percentile > 100)
+		return 0;
+
+	if (!replay->errors_sorted) {
+		qsort(replay->errors, n, sizeof(*replay->errors), cmp_error);
+		replay->errors_sorted = true;
+	}
+
+	return replay->errors[(n - 1) * percentile / 100];
+}
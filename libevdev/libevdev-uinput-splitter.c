@@ -0,0 +1,423 @@
+/*
+ * Copyright © 2026 The libevdev contributors
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided that
+ * the above copyright notice appear in all copies and that both that copyright
+ * notice and this permission notice appear in supporting documentation, and
+ * that the name of the copyright holders not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  The copyright holders make no representations
+ * about the suitability of this software for any purpose.  It is provided "as
+ * is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN NO
+ * EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+ * TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE
+ * OF THIS SOFTWARE.
+ */
+
+/*
+ * A splitter grabs a source device and routes its events to several
+ * uinput devices, e.g. the buttons of a drawing tablet to one device and
+ * the pen to another. Each uinput device is created with the source's
+ * codes routed to it. The events of a source frame are partitioned by
+ * their uinput device and each partition is posted with a single write()
+ * once the SYN_REPORT arrives. After a SYN_DROPPED, the incomplete frame
+ * is discarded and the sync events are routed instead.
+ */
+
+#include <config.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <linux/uinput.h>
+
+#include "libevdev.h"
+#include "libevdev-int.h"
+#include "libevdev-uinput.h"
+#include "libevdev-util.h"
+
+struct split_sink {
+	struct libevdev_uinput *uinput;
+	struct input_event *events; /**< the frame in progress */
+	unsigned int nevents;
+	unsigned int size;
+};
+
+struct libevdev_uinput_splitter {
+	struct libevdev *source;
+	struct split_sink *sinks;
+	unsigned int nsinks;
+
+	/** the sink of each code, -1 if the code is dropped */
+	int *routes[EV_CNT];
+	int mt_report_sink; /**< the sink of SYN_MT_REPORT */
+
+	bool syncing;
+};
+
+static int
+set_routes(struct libevdev_uinput_splitter *splitter,
+	   const struct libevdev_uinput_split_rule *rules,
+	   unsigned int nrules)
+{
+	const struct libevdev *source = splitter->source;
+	unsigned int type, code, i;
+
+	for (type = EV_SYN + 1; type <= EV_MAX; type++) {
+		int max = libevdev_event_type_get_max(type);
+
+		if (max == -1)
+			continue;
+
+		splitter->routes[type] = malloc((max + 1) * sizeof(int));
+		if (!splitter->routes[type])
+			return -ENOMEM;
+		for (code = 0; code <= (unsigned int)max; code++)
+			splitter->routes[type][code] = -1;
+	}
+
+	/* the first rule for a code wins */
+	for (i = nrules; i-- > 0; ) {
+		const struct libevdev_uinput_split_rule *rule = &rules[i];
+		int max;
+
+		if (rule->type > EV_MAX || rule->sink >= splitter->nsinks)
+			return -EINVAL;
+
+		max = libevdev_event_type_get_max(rule->type);
+		/* repeat settings follow the keys */
+		if (rule->type == EV_SYN || rule->type == EV_REP || max == -1 ||
+		    rule->code_min > rule->code_max ||
+		    rule->code_max > (unsigned int)max)
+			return -EINVAL;
+
+		for (code = rule->code_min; code <= rule->code_max; code++) {
+			if (libevdev_has_event_code(source, rule->type, code))
+				splitter->routes[rule->type][code] = rule->sink;
+		}
+	}
+
+	/* the slot must go where the MT axes go */
+	if (libevdev_has_event_code(source, EV_ABS, ABS_MT_SLOT)) {
+		int slot_sink = splitter->routes[EV_ABS][ABS_MT_SLOT];
+
+		for (code = ABS_MT_SLOT + 1; code <= ABS_MT_MAX; code++) {
+			int sink = splitter->routes[EV_ABS][code];
+
+			if (sink != -1 && sink != slot_sink)
+				return -EINVAL;
+		}
+	}
+
+	splitter->mt_report_sink = splitter->routes[EV_ABS][ABS_MT_POSITION_X];
+
+	return 0;
+}
+
+static struct libevdev *
+sink_template(const struct libevdev_uinput_splitter *splitter,
+	      unsigned int sink, const char *name)
+{
+	const struct libevdev *source = splitter->source;
+	struct libevdev *dev;
+	unsigned int type, code;
+	bool has_codes = false;
+
+	dev = libevdev_new();
+	if (!dev)
+		return NULL;
+
+	libevdev_set_name(dev, name);
+	libevdev_set_id_bustype(dev, libevdev_get_id_bustype(source));
+	libevdev_set_id_vendor(dev, libevdev_get_id_vendor(source));
+	libevdev_set_id_product(dev, libevdev_get_id_product(source));
+	libevdev_set_id_version(dev, libevdev_get_id_version(source));
+
+	for (type = EV_SYN + 1; type <= EV_MAX; type++) {
+		int max = libevdev_event_type_get_max(type);
+
+		for (code = 0; max != -1 && code <= (unsigned int)max; code++) {
+			const void *data = NULL;
+
+			if (splitter->routes[type][code] != (int)sink)
+				continue;
+
+			if (type == EV_ABS)
+				data = libevdev_get_abs_info(source, code);
+
+			if (libevdev_enable_event_code(dev, type, code, data) != 0)
+				goto error;
+			has_codes = true;
+		}
+	}
+
+	if (!has_codes)
+		goto error;
+
+	/* properties describe the axes, repeat settings the keys */
+	if (libevdev_has_event_type(dev, EV_ABS) ||
+	    libevdev_has_event_type(dev, EV_REL)) {
+		for (code = 0; code <= INPUT_PROP_MAX; code++) {
+			if (libevdev_has_property(source, code))
+				libevdev_enable_property(dev, code);
+		}
+	}
+
+	if (libevdev_has_event_type(dev, EV_KEY) &&
+	    libevdev_has_event_type(source, EV_REP)) {
+		for (code = 0; code <= REP_MAX; code++) {
+			int value = libevdev_get_event_value(source, EV_REP, code);
+
+			libevdev_enable_event_code(dev, EV_REP, code, &value);
+		}
+	}
+
+	return dev;
+
+error:
+	libevdev_free(dev);
+	return NULL;
+}
+
+LIBEVDEV_EXPORT int
+libevdev_uinput_splitter_new(struct libevdev *source,
+			     const struct libevdev_uinput_split_rule *rules,
+			     unsigned int nrules,
+			     const char * const *names,
+			     unsigned int nsinks,
+			     int uinput_fd,
+			     struct libevdev_uinput_splitter **splitter_out)
+{
+	struct libevdev_uinput_splitter *splitter;
+	unsigned int i;
+	int rc;
+
+	if (nsinks == 0)
+		return -EINVAL;
+
+	splitter = calloc(1, sizeof(*splitter));
+	if (!splitter)
+		return -ENOMEM;
+
+	splitter->source = source;
+	splitter->sinks = calloc(nsinks, sizeof(*splitter->sinks));
+	if (!splitter->sinks) {
+		free(splitter);
+		return -ENOMEM;
+	}
+	splitter->nsinks = nsinks;
+
+	rc = set_routes(splitter, rules, nrules);
+	if (rc != 0)
+		goto error;
+
+	for (i = 0; i < nsinks; i++) {
+		struct split_sink *sink = &splitter->sinks[i];
+		struct libevdev *template;
+		char name[UINPUT_MAX_NAME_SIZE];
+
+		if (names && names[i])
+			snprintf(name, sizeof(name), "%s", names[i]);
+		else
+			snprintf(name, sizeof(name), "%s %u",
+				 libevdev_get_name(source), i);
+
+		/* a sink without codes is a mistake in the rules */
+		template = sink_template(splitter, i, name);
+		if (!template) {
+			rc = -EINVAL;
+			goto error;
+		}
+
+		rc = libevdev_uinput_create_from_device(template, uinput_fd,
+							&sink->uinput);
+		libevdev_free(template);
+		if (rc != 0)
+			goto error;
+
+		sink->size = 16;
+		sink->events = calloc(sink->size, sizeof(*sink->events));
+		if (!sink->events) {
+			rc = -ENOMEM;
+			goto error;
+		}
+	}
+
+	rc = libevdev_grab(source, LIBEVDEV_GRAB);
+	if (rc != 0)
+		goto error;
+
+	*splitter_out = splitter;
+	return 0;
+
+error:
+	/* not grabbed yet, don't ungrab in free() */
+	splitter->source = NULL;
+	libevdev_uinput_splitter_free(splitter);
+	return rc;
+}
+
+LIBEVDEV_EXPORT void
+libevdev_uinput_splitter_free(struct libevdev_uinput_splitter *splitter)
+{
+	unsigned int i;
+
+	if (!splitter)
+		return;
+
+	if (splitter->source)
+		libevdev_grab(splitter->source, LIBEVDEV_UNGRAB);
+
+	for (i = 0; i < splitter->nsinks; i++) {
+		libevdev_uinput_destroy(splitter->sinks[i].uinput);
+		free(splitter->sinks[i].events);
+	}
+	for (i = 0; i < EV_CNT; i++)
+		free(splitter->routes[i]);
+	free(splitter->sinks);
+	free(splitter);
+}
+
+LIBEVDEV_EXPORT struct libevdev_uinput *
+libevdev_uinput_splitter_get_uinput(const struct libevdev_uinput_splitter *splitter,
+				    unsigned int sink)
+{
+	if (sink >= splitter->nsinks)
+		return NULL;
+
+	return splitter->sinks[sink].uinput;
+}
+
+static int
+append_event(struct split_sink *sink, const struct input_event *ev)
+{
+	if (sink->nevents == sink->size) {
+		unsigned int size = sink->size * 2;
+		struct input_event *events;
+
+		events = realloc(sink->events, size * sizeof(*events));
+		if (!events)
+			return -ENOMEM;
+
+		sink->events = events;
+		sink->size = size;
+	}
+
+	sink->events[sink->nevents++] = *ev;
+
+	return 0;
+}
+
+static int
+route_event(struct libevdev_uinput_splitter *splitter,
+	    const struct input_event *ev)
+{
+	int sink = -1;
+
+	if (ev->type == EV_SYN) {
+		if (ev->code == SYN_MT_REPORT)
+			sink = splitter->mt_report_sink;
+	} else if (ev->type <= EV_MAX && splitter->routes[ev->type] &&
+		   (int)ev->code <= libevdev_event_type_get_max(ev->type)) {
+		sink = splitter->routes[ev->type][ev->code];
+	}
+
+	if (sink == -1)
+		return 0;
+
+	return append_event(&splitter->sinks[sink], ev);
+}
+
+static void
+discard_frames(struct libevdev_uinput_splitter *splitter)
+{
+	unsigned int i;
+
+	for (i = 0; i < splitter->nsinks; i++)
+		splitter->sinks[i].nevents = 0;
+}
+
+/**
+ * Post the partition of each sink with the SYN_REPORT. A sink without
+ * events in this frame is skipped.
+ */
+static int
+forward_frames(struct libevdev_uinput_splitter *splitter,
+	       const struct input_event *syn)
+{
+	unsigned int i;
+	int rc = 0;
+
+	for (i = 0; i < splitter->nsinks; i++) {
+		struct split_sink *sink = &splitter->sinks[i];
+		int sink_rc;
+
+		if (sink->nevents == 0)
+			continue;
+
+		sink_rc = append_event(sink, syn);
+		if (sink_rc == 0)
+			sink_rc = libevdev_uinput_write_events(sink->uinput,
+							       sink->events,
+							       sink->nevents);
+		sink->nevents = 0;
+		if (rc == 0)
+			rc = sink_rc;
+	}
+
+	return rc;
+}
+
+LIBEVDEV_EXPORT int
+libevdev_uinput_splitter_dispatch(struct libevdev_uinput_splitter *splitter)
+{
+	struct libevdev *source = splitter->source;
+
+	while (true) {
+		unsigned int flags = splitter->syncing ? LIBEVDEV_READ_FLAG_SYNC :
+							 LIBEVDEV_READ_FLAG_NORMAL;
+		struct input_event ev;
+		int rc;
+
+		rc = libevdev_next_event(source, flags, &ev);
+		if (rc == -EAGAIN) {
+			if (!splitter->syncing)
+				return 0;
+
+			/* the sync is complete, continue normally */
+			splitter->syncing = false;
+			continue;
+		} else if (rc < 0) {
+			return rc;
+		}
+
+		if (rc == LIBEVDEV_READ_STATUS_SYNC && !splitter->syncing) {
+			/* ev is the SYN_DROPPED, the sync events replace
+			   the incomplete frame */
+			discard_frames(splitter);
+			splitter->syncing = true;
+			continue;
+		}
+
+		if (ev.type != EV_SYN || ev.code != SYN_REPORT) {
+			rc = route_event(splitter, &ev);
+			if (rc != 0)
+				return rc;
+			continue;
+		}
+
+		rc = forward_frames(splitter, &ev);
+		if (rc != 0)
+			return rc;
+
+		/* avoid a read() that only returns -EAGAIN */
+		if (!splitter->syncing && !has_buffered_events(source))
+			return 0;
+	}
+}
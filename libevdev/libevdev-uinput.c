@@ -48,6 +48,95 @@
 #define UI_SET_PROPBIT _IOW(UINPUT_IOCTL_BASE, 110, int)
 #endif
 
+/**
+ * The state the kernel has for a uinput device as far as we know, used by
+ * the frame builder to drop the events the kernel would ignore. A code is
+ * only filtered once an event for it went through us, the device may have
+ * been written to elsewhere before.
+ */
+struct shadow_bits {
+	unsigned long known[NLONGS(KEY_CNT)];
+	unsigned long state[NLONGS(KEY_CNT)];
+};
+
+struct uinput_frame {
+	struct input_event *events; /**< the frame not yet written */
+	size_t nevents;
+	size_t size;
+
+	struct shadow_bits key, led, snd, sw;
+	unsigned long abs_known[NLONGS(ABS_CNT)];
+	int abs_values[ABS_CNT];
+
+	int kernel_slot; /**< last ABS_MT_SLOT written, -1 if unknown */
+	int next_slot; /**< the slot the caller selected, -1 if none */
+	unsigned long *mt_known; /**< [num_slots * ABS_MT_CNT] bits */
+	int *mt_values; /**< [num_slots * ABS_MT_CNT] */
+};
+
+#define SLOT_AXIS(_slot, _code) ((_slot) * ABS_MT_CNT + (_code) - ABS_MT_MIN)
+
+static inline bool
+is_mt_value(unsigned int code)
+{
+	return code > ABS_MT_SLOT && code <= ABS_MT_MAX;
+}
+
+static void
+frame_free(struct uinput_frame *frame)
+{
+	if (!frame)
+		return;
+
+	free(frame->events);
+	free(frame->mt_known);
+	free(frame->mt_values);
+	free(frame);
+}
+
+static void
+shadow_reset(const struct libevdev_uinput *uinput_dev)
+{
+	struct uinput_frame *frame = uinput_dev->frame;
+	size_t nslots = max(uinput_dev->num_slots, 0);
+
+	memset(&frame->key, 0, sizeof(frame->key));
+	memset(&frame->led, 0, sizeof(frame->led));
+	memset(&frame->snd, 0, sizeof(frame->snd));
+	memset(&frame->sw, 0, sizeof(frame->sw));
+	memset(frame->abs_known, 0, sizeof(frame->abs_known));
+	memset(frame->mt_known, 0,
+	       NLONGS(nslots * ABS_MT_CNT) * sizeof(*frame->mt_known));
+	frame->kernel_slot = -1;
+}
+
+static struct uinput_frame *
+frame_new(const struct libevdev_uinput *uinput_dev)
+{
+	struct uinput_frame *frame;
+	size_t nslots = max(uinput_dev->num_slots, 0);
+
+	frame = calloc(1, sizeof(*frame));
+	if (!frame)
+		return NULL;
+
+	frame->size = 64;
+	frame->events = calloc(frame->size, sizeof(*frame->events));
+	frame->mt_known = calloc(NLONGS(nslots * ABS_MT_CNT) + 1,
+				 sizeof(*frame->mt_known));
+	frame->mt_values = calloc(nslots * ABS_MT_CNT + 1,
+				  sizeof(*frame->mt_values));
+	if (!frame->events || !frame->mt_known || !frame->mt_values) {
+		frame_free(frame);
+		return NULL;
+	}
+
+	frame->kernel_slot = -1;
+	frame->next_slot = -1;
+
+	return frame;
+}
+
 static struct libevdev_uinput *
 alloc_uinput_device(const char *name)
 {
@@ -57,6 +146,7 @@ alloc_uinput_device(const char *name)
 	if (uinput_dev) {
 		uinput_dev->name = strdup(name);
 		uinput_dev->fd = -1;
+		uinput_dev->num_slots = -1;
 	}
 
 	return uinput_dev;
@@ -222,6 +312,10 @@ fetch_syspath_and_devnode(struct libevdev_uinput *uinput_dev)
 	int rc;
 	char buf[sizeof(SYS_INPUT_DIR) + 64] = SYS_INPUT_DIR;
 
+	if (uinput_dev->syspath_fetched)
+		return uinput_dev->devnode ? 0 : -1;
+	uinput_dev->syspath_fetched = 1;
+
 	rc = ioctl(uinput_dev->fd,
 		   UI_GET_SYSNAME(sizeof(buf) - strlen(SYS_INPUT_DIR)),
 		   &buf[strlen(SYS_INPUT_DIR)]);
@@ -289,7 +383,12 @@ fetch_syspath_and_devnode(struct libevdev_uinput *uinput_dev)
 		free(namelist[i]);
 	free(namelist);
 
-	return uinput_dev->devnode ? 0 : -1;
+	if (!uinput_dev->devnode) {
+		log_error(NULL, "unable to fetch syspath or device node.\n");
+		return -1;
+	}
+
+	return 0;
 }
 
 static int
@@ -353,32 +452,43 @@ error:
 	return -errno;
 }
 
-LIBEVDEV_EXPORT int
-libevdev_uinput_create_from_device(const struct libevdev *dev, int fd, struct libevdev_uinput** uinput_dev)
+static uint64_t
+now_us(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static int
+uinput_create(const struct libevdev *dev, int fd, int fd_is_managed,
+	      unsigned int uinput_version,
+	      struct libevdev_uinput **uinput_dev)
 {
 	int rc;
 	struct libevdev_uinput *new_device;
-	int close_fd_on_error = (fd == LIBEVDEV_UINPUT_OPEN_MANAGED);
-	unsigned int uinput_version = 0;
+	unsigned int code;
+	uint64_t start, setup_done;
 
 	new_device = alloc_uinput_device(libevdev_get_name(dev));
 	if (!new_device)
 		return -ENOMEM;
 
-	if (fd == LIBEVDEV_UINPUT_OPEN_MANAGED) {
-		fd = open("/dev/uinput", O_RDWR|O_CLOEXEC);
-		if (fd < 0)
-			goto error;
+	new_device->fd_is_managed = fd_is_managed;
 
-		new_device->fd_is_managed = 1;
-	} else if (fd < 0) {
-		log_bug(NULL, "Invalid fd %d\n", fd);
-		errno = EBADF;
-		goto error;
+	/* what the kernel's input core filters with, see the frame builder */
+	if (libevdev_has_event_code(dev, EV_ABS, ABS_MT_SLOT))
+		new_device->num_slots = libevdev_get_abs_maximum(dev, ABS_MT_SLOT) + 1;
+	for (code = 0; code <= ABS_MAX; code++) {
+		if (libevdev_has_event_code(dev, EV_ABS, code) &&
+		    libevdev_get_abs_fuzz(dev, code) != 0)
+			set_bit(new_device->abs_fuzzed, code);
 	}
 
-	if (ioctl(fd, UI_GET_VERSION, &uinput_version) == 0 &&
-	    uinput_version >= 5)
+	start = now_us();
+
+	if (uinput_version >= 5)
 		rc = uinput_create_DEV_SETUP(dev, fd, new_device);
 	else
 		rc = uinput_create_write(dev, fd, new_device);
@@ -386,6 +496,8 @@ libevdev_uinput_create_from_device(const struct libevdev *dev, int fd, struct li
 	if (rc != 0)
 		goto error;
 
+	setup_done = now_us();
+
 	/* ctime notes time before/after ioctl to help us filter out devices
 	   when traversing /sys/devices/virtual/input to find the device
 	   node.
@@ -402,11 +514,12 @@ libevdev_uinput_create_from_device(const struct libevdev *dev, int fd, struct li
 	new_device->ctime[1] = time(NULL);
 	new_device->fd = fd;
 
-	if (fetch_syspath_and_devnode(new_device) == -1) {
-		log_error(NULL, "unable to fetch syspath or device node.\n");
-		errno = ENODEV;
-		goto error;
-	}
+	log_dbg(NULL, "uinput device '%s' created: setup %lluus, UI_DEV_CREATE %lluus\n",
+		new_device->name,
+		(unsigned long long)(setup_done - start),
+		(unsigned long long)(now_us() - setup_done));
+
+	/* syspath and devnode are looked up on first use */
 
 	*uinput_dev = new_device;
 
@@ -415,8 +528,101 @@ libevdev_uinput_create_from_device(const struct libevdev *dev, int fd, struct li
 error:
 	rc = -errno;
 	libevdev_uinput_destroy(new_device);
-	if (fd != -1 && close_fd_on_error)
+	return rc;
+}
+
+static int
+open_uinput(int *fd, unsigned int *uinput_version)
+{
+	*fd = open("/dev/uinput", O_RDWR|O_CLOEXEC);
+	if (*fd < 0)
+		return -errno;
+
+	if (ioctl(*fd, UI_GET_VERSION, uinput_version) != 0)
+		*uinput_version = 0;
+
+	return 0;
+}
+
+LIBEVDEV_EXPORT int
+libevdev_uinput_create_from_device(const struct libevdev *dev, int fd, struct libevdev_uinput** uinput_dev)
+{
+	int rc;
+	int fd_is_managed = (fd == LIBEVDEV_UINPUT_OPEN_MANAGED);
+	unsigned int uinput_version = 0;
+
+	if (fd_is_managed) {
+		rc = open_uinput(&fd, &uinput_version);
+		if (rc != 0)
+			return rc;
+	} else if (fd < 0) {
+		log_bug(NULL, "Invalid fd %d\n", fd);
+		return -EBADF;
+	} else if (ioctl(fd, UI_GET_VERSION, &uinput_version) != 0) {
+		uinput_version = 0;
+	}
+
+	rc = uinput_create(dev, fd, fd_is_managed, uinput_version, uinput_dev);
+	if (rc != 0 && fd_is_managed)
 		close(fd);
+
+	return rc;
+}
+
+LIBEVDEV_EXPORT int
+libevdev_uinput_create_from_devices(const struct libevdev * const *devs,
+				    size_t ndevices,
+				    struct libevdev_uinput **uinput_devs)
+{
+	struct libevdev_uinput **created;
+	int *fds;
+	unsigned int uinput_version = 0;
+	size_t i, nopened = 0, ncreated = 0;
+	int rc = 0;
+
+	if (ndevices == 0)
+		return 0;
+
+	created = calloc(ndevices, sizeof(*created));
+	fds = calloc(ndevices, sizeof(*fds));
+	if (!created || !fds) {
+		rc = -ENOMEM;
+		goto out;
+	}
+
+	/* open all fds first, the version is the same for all of them */
+	for (i = 0; i < ndevices; i++) {
+		unsigned int version;
+
+		rc = open_uinput(&fds[i], &version);
+		if (rc != 0)
+			goto out;
+		if (i == 0)
+			uinput_version = version;
+		nopened++;
+	}
+
+	for (i = 0; i < ndevices; i++) {
+		rc = uinput_create(devs[i], fds[i], 1, uinput_version,
+				   &created[i]);
+		if (rc != 0)
+			goto out;
+		ncreated++;
+	}
+
+	memcpy(uinput_devs, created, ndevices * sizeof(*created));
+
+out:
+	if (rc != 0) {
+		for (i = 0; i < ncreated; i++)
+			libevdev_uinput_destroy(created[i]);
+		for (i = ncreated; i < nopened; i++)
+			close(fds[i]);
+	}
+
+	free(created);
+	free(fds);
+
 	return rc;
 }
 
@@ -434,18 +640,21 @@ libevdev_uinput_destroy(struct libevdev_uinput *uinput_dev)
 	free(uinput_dev->syspath);
 	free(uinput_dev->devnode);
 	free(uinput_dev->name);
+	frame_free(uinput_dev->frame);
 	free(uinput_dev);
 }
 
 LIBEVDEV_EXPORT const char*
 libevdev_uinput_get_syspath(struct libevdev_uinput *uinput_dev)
 {
+	fetch_syspath_and_devnode(uinput_dev);
 	return uinput_dev->syspath;
 }
 
 LIBEVDEV_EXPORT const char*
 libevdev_uinput_get_devnode(struct libevdev_uinput *uinput_dev)
 {
+	fetch_syspath_and_devnode(uinput_dev);
 	return uinput_dev->devnode;
 }
 
@@ -456,8 +665,199 @@ libevdev_uinput_write_event(const struct libevdev_uinput *uinput_dev,
 			    int value)
 {
 	struct input_event ev = { {0,0}, type, code, value };
-	int fd = libevdev_uinput_get_fd(uinput_dev);
-	int rc, max;
+
+	/* would be truncated in ev, libevdev_uinput_write_events()
+	   validates the rest */
+	if (type > EV_MAX || code > UINT16_MAX)
+		return -EINVAL;
+
+	return libevdev_uinput_write_events(uinput_dev, &ev, 1);
+}
+
+static struct shadow_bits *
+shadow_bits_for_type(struct uinput_frame *frame, unsigned int type)
+{
+	switch (type) {
+	case EV_KEY: return &frame->key;
+	case EV_LED: return &frame->led;
+	case EV_SND: return &frame->snd;
+	case EV_SW: return &frame->sw;
+	default: return NULL;
+	}
+}
+
+/**
+ * @return true if the kernel would ignore this event, see
+ * input_handle_event() and input_handle_abs_event()
+ */
+static bool
+shadow_is_redundant(const struct libevdev_uinput *uinput_dev,
+		    unsigned int type, unsigned int code, int value)
+{
+	struct uinput_frame *frame = uinput_dev->frame;
+	struct shadow_bits *bits;
+
+	switch (type) {
+	case EV_REL:
+		return value == 0;
+	case EV_KEY:
+		/* autorepeat doesn't change the state */
+		if (value == 2)
+			return false;
+		break;
+	case EV_ABS:
+		/* the kernel filters the defuzzed value, we don't know it */
+		if (bit_is_set(uinput_dev->abs_fuzzed, code))
+			return false;
+
+		if (is_mt_value(code)) {
+			int idx;
+
+			/* protocol A is never filtered */
+			if (uinput_dev->num_slots <= 0 || frame->next_slot == -1)
+				return false;
+
+			idx = SLOT_AXIS(frame->next_slot, code);
+			return bit_is_set(frame->mt_known, idx) &&
+			       frame->mt_values[idx] == value;
+		}
+
+		return bit_is_set(frame->abs_known, code) &&
+		       frame->abs_values[code] == value;
+	}
+
+	bits = shadow_bits_for_type(frame, type);
+
+	return bits && bit_is_set(bits->known, code) &&
+	       bit_is_set(bits->state, code) == !!value;
+}
+
+/**
+ * Update the shadow state for an event that was passed to the kernel.
+ * The shadow lives in the separately allocated frame, so this doesn't
+ * modify uinput_dev itself.
+ */
+static void
+shadow_update(const struct libevdev_uinput *uinput_dev,
+	      const struct input_event *ev)
+{
+	struct uinput_frame *frame = uinput_dev->frame;
+	struct shadow_bits *bits;
+
+	if (ev->type == EV_ABS) {
+		if (ev->code == ABS_MT_SLOT) {
+			if (ev->value >= 0 && ev->value < uinput_dev->num_slots) {
+				frame->kernel_slot = ev->value;
+				frame->next_slot = ev->value;
+			}
+		} else if (is_mt_value(ev->code) && uinput_dev->num_slots > 0) {
+			int idx;
+
+			if (frame->kernel_slot == -1)
+				return;
+
+			idx = SLOT_AXIS(frame->kernel_slot, ev->code);
+			set_bit(frame->mt_known, idx);
+			frame->mt_values[idx] = ev->value;
+		} else if (ev->code <= ABS_MAX) {
+			set_bit(frame->abs_known, ev->code);
+			frame->abs_values[ev->code] = ev->value;
+		}
+		return;
+	}
+
+	if (ev->type == EV_KEY && ev->value == 2)
+		return;
+
+	bits = shadow_bits_for_type(frame, ev->type);
+	if (bits && ev->code < KEY_CNT) {
+		set_bit(bits->known, ev->code);
+		set_bit_state(bits->state, ev->code, ev->value);
+	}
+}
+
+static int
+write_all(int fd, const struct input_event *events, size_t nevents)
+{
+	const char *data = (const char*)events;
+	size_t len = nevents * sizeof(*events);
+
+	/* uinput takes any number of events per write() but may stop
+	   early, e.g. on a signal */
+	while (len > 0) {
+		ssize_t rc = write(fd, data, len);
+
+		if (rc < 0) {
+			if (errno == EINTR)
+				continue;
+			return -errno;
+		} else if (rc == 0) {
+			/* nothing written, retrying won't change that */
+			return -EIO;
+		}
+
+		data += rc;
+		len -= rc;
+	}
+
+	return 0;
+}
+
+LIBEVDEV_EXPORT int
+libevdev_uinput_write_events(const struct libevdev_uinput *uinput_dev,
+			     const struct input_event *events,
+			     size_t nevents)
+{
+	struct uinput_frame *frame = uinput_dev->frame;
+	size_t i;
+	int rc;
+
+	for (i = 0; i < nevents; i++) {
+		int max = libevdev_event_type_get_max(events[i].type);
+
+		if (max == -1 || events[i].code > (unsigned int)max)
+			return -EINVAL;
+	}
+
+	rc = write_all(libevdev_uinput_get_fd(uinput_dev), events, nevents);
+
+	if (frame) {
+		/* with a frame pending, these events overtake it and we
+		   can't tell which value the kernel ends up with */
+		if (rc != 0 || frame->nevents > 0) {
+			shadow_reset(uinput_dev);
+		} else {
+			for (i = 0; i < nevents; i++)
+				shadow_update(uinput_dev, &events[i]);
+		}
+	}
+
+	return rc;
+}
+
+static void
+frame_append(struct libevdev_uinput *uinput_dev,
+	     unsigned int type, unsigned int code, int value)
+{
+	struct uinput_frame *frame = uinput_dev->frame;
+	struct input_event *ev = &frame->events[frame->nevents++];
+
+	memset(ev, 0, sizeof(*ev));
+	ev->type = type;
+	ev->code = code;
+	ev->value = value;
+
+	shadow_update(uinput_dev, ev);
+}
+
+LIBEVDEV_EXPORT int
+libevdev_uinput_frame_add(struct libevdev_uinput *uinput_dev,
+			  unsigned int type,
+			  unsigned int code,
+			  int value)
+{
+	struct uinput_frame *frame;
+	int max;
 
 	if (type > EV_MAX)
 		return -EINVAL;
@@ -466,7 +866,75 @@ libevdev_uinput_write_event(const struct libevdev_uinput *uinput_dev,
 	if (max == -1 || code > (unsigned int)max)
 		return -EINVAL;
 
-	rc = write(fd, &ev, sizeof(ev));
+	if (type == EV_SYN && code == SYN_REPORT)
+		return -EINVAL;
+
+	if (!uinput_dev->frame) {
+		uinput_dev->frame = frame_new(uinput_dev);
+		if (!uinput_dev->frame)
+			return -ENOMEM;
+	}
+	frame = uinput_dev->frame;
+
+	/* room for a slot switch, the event and the SYN_REPORT */
+	if (frame->nevents + 3 > frame->size) {
+		size_t size = frame->size * 2;
+		struct input_event *events;
 
-	return rc < 0 ? -errno : 0;
+		events = realloc(frame->events, size * sizeof(*events));
+		if (!events)
+			return -ENOMEM;
+
+		frame->events = events;
+		frame->size = size;
+	}
+
+	/* Like the kernel, only post the slot once a value in it changes.
+	   A slot out of range is ignored by the kernel. */
+	if (type == EV_ABS && code == ABS_MT_SLOT) {
+		if (value >= 0 && value < uinput_dev->num_slots)
+			frame->next_slot = value;
+		return 0;
+	}
+
+	if (shadow_is_redundant(uinput_dev, type, code, value))
+		return 0;
+
+	if (type == EV_ABS && is_mt_value(code) &&
+	    uinput_dev->num_slots > 0 && frame->next_slot != -1 &&
+	    frame->next_slot != frame->kernel_slot)
+		frame_append(uinput_dev, EV_ABS, ABS_MT_SLOT, frame->next_slot);
+
+	frame_append(uinput_dev, type, code, value);
+
+	return 0;
+}
+
+void
+_libevdev_uinput_discard_frame(struct libevdev_uinput *uinput_dev)
+{
+	if (uinput_dev->frame)
+		uinput_dev->frame->nevents = 0;
+}
+
+LIBEVDEV_EXPORT int
+libevdev_uinput_frame_flush(struct libevdev_uinput *uinput_dev)
+{
+	struct uinput_frame *frame = uinput_dev->frame;
+	int rc;
+
+	/* the kernel drops a SYN_REPORT without events too */
+	if (!frame || frame->nevents == 0)
+		return 0;
+
+	frame_append(uinput_dev, EV_SYN, SYN_REPORT, 0);
+
+	rc = write_all(uinput_dev->fd, frame->events, frame->nevents);
+	frame->nevents = 0;
+
+	/* we don't know how much of the frame the kernel got */
+	if (rc != 0)
+		shadow_reset(uinput_dev);
+
+	return rc;
 }
@@ -30,6 +30,11 @@ extern "C" {
 #include <libevdev/libevdev.h>
 
 struct libevdev_uinput;
+struct libevdev_uinput_pool;
+struct libevdev_uinput_replay;
+struct libevdev_uinput_proxy;
+struct libevdev_uinput_aggregator;
+struct libevdev_uinput_splitter;
 
 /**
  * @defgroup uinput uinput device creation
@@ -151,6 +156,29 @@ int libevdev_uinput_create_from_device(const struct libevdev *dev,
 				       int uinput_fd,
 				       struct libevdev_uinput **uinput_dev);
 
+/**
+ * @ingroup uinput
+ *
+ * Create a uinput device for each of the given libevdev devices, as
+ * libevdev_uinput_create_from_device() with @ref
+ * LIBEVDEV_UINPUT_OPEN_MANAGED would. All file descriptors to @c
+ * /dev/uinput are opened before the first device is created. Either all
+ * devices are created or none.
+ *
+ * @param devs The devices to duplicate
+ * @param ndevices The number of devices
+ * @param[out] uinput_devs The newly created uinput devices, one per device
+ * in devs. Each must be destroyed with libevdev_uinput_destroy().
+ *
+ * @return 0 on success or a negative errno on failure. On failure, the
+ * value of uinput_devs is unmodified.
+ *
+ * @see libevdev_uinput_create_from_device
+ */
+int libevdev_uinput_create_from_devices(const struct libevdev * const *devs,
+					size_t ndevices,
+					struct libevdev_uinput **uinput_devs);
+
 /**
  * @ingroup uinput
  *
@@ -195,6 +223,12 @@ int libevdev_uinput_get_fd(const struct libevdev_uinput *uinput_dev);
  * To avoid false positives, wait at least wait at least 1.5s between
  * creating devices that have the same name.
  *
+ * The syspath and the device node are looked up on the first call to
+ * this function or libevdev_uinput_get_devnode(), not when the device is
+ * created. A successful creation does not guarantee that the lookup
+ * succeeds; the result of the first lookup, including NULL, is returned
+ * by all later calls.
+ *
  * @param uinput_dev A previously created uinput device.
  * @return The syspath for this device, including the preceding /sys
  *
@@ -210,8 +244,10 @@ const char* libevdev_uinput_get_syspath(struct libevdev_uinput *uinput_dev);
  * This relies on libevdev_uinput_get_syspath() to provide a valid syspath.
  * See libevdev_uinput_get_syspath() for more details.
  *
- * @note This function may return NULL. libevdev may have to guess the
- * syspath and the device node. See libevdev_uinput_get_syspath() for details.
+ * @note This function may return NULL, callers must check the return
+ * value before using it. libevdev may have to guess the syspath and the
+ * device node, and the lookup only happens on the first call. See
+ * libevdev_uinput_get_syspath() for details.
  * @param uinput_dev A previously created uinput device.
  * @return The device node for this device, in the form of /dev/input/eventN
  *
@@ -237,6 +273,522 @@ int libevdev_uinput_write_event(const struct libevdev_uinput *uinput_dev,
 				unsigned int type,
 				unsigned int code,
 				int value);
+
+/**
+ * @ingroup uinput
+ *
+ * Post a number of events through the uinput device with a single
+ * write(), e.g. a whole frame terminated by EV_SYN/SYN_REPORT/0. The
+ * event types and codes are validated before anything is written; if
+ * one of them is invalid, no event is posted. The timestamps of the
+ * events are ignored.
+ *
+ * If the write is interrupted, the remaining events are written until
+ * all events are posted or an error occurs.
+ *
+ * @param uinput_dev A previously created uinput device.
+ * @param events The events to post
+ * @param nevents The number of events
+ * @return 0 on success or a negative errno on error. On error, some of
+ * the leading events may have been posted.
+ *
+ * @see libevdev_uinput_write_event
+ */
+int libevdev_uinput_write_events(const struct libevdev_uinput *uinput_dev,
+				 const struct input_event *events,
+				 size_t nevents);
+
+/**
+ * @ingroup uinput
+ *
+ * Add an event to the frame that is posted with the next call to
+ * libevdev_uinput_frame_flush(). Events the kernel would ignore are
+ * dropped right away: relative events with a value of 0 and key, switch,
+ * LED, sound and absolute events that do not change the current state.
+ * Only state that was previously posted through this uinput device is
+ * known, the first event for each code is always added.
+ *
+ * An EV_ABS/ABS_MT_SLOT event only selects the slot; it is added before
+ * the first event that changes a value in that slot. Axes with a fuzz
+ * are never filtered.
+ *
+ * Events posted with libevdev_uinput_write_event() or
+ * libevdev_uinput_write_events() while a frame is pending are posted
+ * before that frame and reset the known state.
+ *
+ * @param uinput_dev A previously created uinput device.
+ * @param type Event type (EV_ABS, EV_REL, etc.)
+ * @param code Event code (ABS_X, REL_Y, etc.)
+ * @param value The event value
+ * @return 0 on success or a negative errno on error. EV_SYN/SYN_REPORT
+ * is not a valid event, use libevdev_uinput_frame_flush() instead.
+ *
+ * @see libevdev_uinput_frame_flush
+ */
+int libevdev_uinput_frame_add(struct libevdev_uinput *uinput_dev,
+			      unsigned int type,
+			      unsigned int code,
+			      int value);
+
+/**
+ * @ingroup uinput
+ *
+ * Post the events added with libevdev_uinput_frame_add(), terminated by
+ * EV_SYN/SYN_REPORT/0, with a single write(). If no events were added,
+ * nothing is posted.
+ *
+ * @param uinput_dev A previously created uinput device.
+ * @return 0 on success or a negative errno on error. The frame is
+ * discarded in either case.
+ *
+ * @see libevdev_uinput_frame_add
+ */
+int libevdev_uinput_frame_flush(struct libevdev_uinput *uinput_dev);
+
+/**
+ * @ingroup uinput
+ *
+ * Create a new, empty pool of uinput devices. A pool hands out uinput
+ * devices for a libevdev device and keeps them when they are released,
+ * the next request for a device with the same description gets the same
+ * uinput device back instead of a newly created one.
+ *
+ * @param[out] pool The newly created pool
+ * @return 0 on success or a negative errno on failure
+ *
+ * @see libevdev_uinput_pool_acquire
+ * @see libevdev_uinput_pool_free
+ */
+int libevdev_uinput_pool_new(struct libevdev_uinput_pool **pool);
+
+/**
+ * @ingroup uinput
+ *
+ * Destroy all uinput devices of the pool, including the ones that were
+ * not released, and free the pool.
+ *
+ * @param pool The pool to free
+ */
+void libevdev_uinput_pool_free(struct libevdev_uinput_pool *pool);
+
+/**
+ * @ingroup uinput
+ *
+ * Get a uinput device for the given libevdev device. If the pool has a
+ * released uinput device that was created from a device with the same
+ * description, see libevdev_serialize_description(), that device is
+ * returned. The axis values are not part of the comparison, the axes of
+ * a returned device are set to the values of dev. Otherwise a new uinput
+ * device is created with @ref LIBEVDEV_UINPUT_OPEN_MANAGED.
+ *
+ * The uinput device is owned by the pool and must be returned with
+ * libevdev_uinput_pool_release(), not destroyed with
+ * libevdev_uinput_destroy().
+ *
+ * @param pool The pool
+ * @param dev The device to duplicate
+ * @param[out] uinput_dev The uinput device
+ * @return 0 on success or a negative errno on failure
+ *
+ * @see libevdev_uinput_pool_release
+ */
+int libevdev_uinput_pool_acquire(struct libevdev_uinput_pool *pool,
+				 const struct libevdev *dev,
+				 struct libevdev_uinput **uinput_dev);
+
+/**
+ * @ingroup uinput
+ *
+ * Return a uinput device to the pool. The device's state is reset: all
+ * keys, switches, LEDs and sounds are set to 0, the axes to the values of
+ * the device passed to libevdev_uinput_pool_acquire() and all touches are
+ * ended, followed by a SYN_REPORT. A frame pending in the frame builder is discarded.
+ * Unread events on the uinput fd are discarded; pending force feedback
+ * uploads are refused and pending erases are completed.
+ *
+ * Changes made through the event node, e.g. to the absinfo with
+ * EVIOCSABS, are not reset. If the reset fails, the device is destroyed.
+ *
+ * @param pool The pool the device was acquired from
+ * @param uinput_dev The device to release
+ *
+ * @see libevdev_uinput_pool_acquire
+ */
+void libevdev_uinput_pool_release(struct libevdev_uinput_pool *pool,
+				  struct libevdev_uinput *uinput_dev);
+
+/**
+ * @ingroup uinput
+ *
+ * Create a replay of recorded events through the uinput device. The
+ * events are split into frames, each ending with an EV_SYN/SYN_REPORT
+ * event; trailing events without one form the last frame. Each frame is
+ * posted with a single write() at the time given by its SYN_REPORT's
+ * timestamp, relative to the first frame and divided by speed. The
+ * events are copied, the caller may free them after this call.
+ *
+ * The replay starts with the first call to libevdev_uinput_replay_run(),
+ * libevdev_uinput_replay_get_fd() or libevdev_uinput_replay_dispatch().
+ *
+ * @param uinput_dev A previously created uinput device, it must outlive
+ * the replay
+ * @param events The recorded events
+ * @param nevents The number of events
+ * @param speed The speed multiplier, e.g. 2.0 to replay twice as fast as
+ * recorded or 0 to post all frames as fast as possible
+ * @param[out] replay The newly created replay
+ *
+ * @return 0 on success or a negative errno on failure. -EINVAL is
+ * returned for a negative speed or an invalid event type or code.
+ *
+ * @see libevdev_uinput_replay_free
+ */
+int libevdev_uinput_replay_new(struct libevdev_uinput *uinput_dev,
+			       const struct input_event *events,
+			       size_t nevents,
+			       double speed,
+			       struct libevdev_uinput_replay **replay);
+
+/**
+ * @ingroup uinput
+ *
+ * Free the replay and close its timer fd, if any.
+ *
+ * @param replay The replay to free
+ */
+void libevdev_uinput_replay_free(struct libevdev_uinput_replay *replay);
+
+/**
+ * @ingroup uinput
+ *
+ * Post all remaining frames of the replay, sleeping until each frame's
+ * deadline with clock_nanosleep(). This function returns once all
+ * frames have been posted or an error occurs.
+ *
+ * @param replay The replay
+ * @return 0 on success or a negative errno on failure
+ */
+int libevdev_uinput_replay_run(struct libevdev_uinput_replay *replay);
+
+/**
+ * @ingroup uinput
+ *
+ * Return a timerfd that becomes readable when the next frame of the
+ * replay is due, for use in the caller's event loop. Call
+ * libevdev_uinput_replay_dispatch() whenever the fd is readable.
+ * The fd is owned by the replay and closed by
+ * libevdev_uinput_replay_free().
+ *
+ * @param replay The replay
+ * @return The fd or a negative errno on failure
+ */
+int libevdev_uinput_replay_get_fd(struct libevdev_uinput_replay *replay);
+
+/**
+ * @ingroup uinput
+ *
+ * Post all frames of the replay whose deadline has passed and re-arm the
+ * timer fd for the next frame.
+ *
+ * @param replay The replay
+ * @return 1 if frames remain, 0 if the replay is complete or a negative
+ * errno on failure
+ *
+ * @see libevdev_uinput_replay_get_fd
+ */
+int libevdev_uinput_replay_dispatch(struct libevdev_uinput_replay *replay);
+
+/**
+ * @ingroup uinput
+ *
+ * @param replay The replay
+ * @return The number of frames in the replay
+ */
+unsigned int libevdev_uinput_replay_get_num_frames(const struct libevdev_uinput_replay *replay);
+
+/**
+ * @ingroup uinput
+ *
+ * @param replay The replay
+ * @return The number of frames posted so far
+ */
+unsigned int libevdev_uinput_replay_get_num_frames_written(const struct libevdev_uinput_replay *replay);
+
+/**
+ * @ingroup uinput
+ *
+ * Return the timing error of the frames posted so far at the given
+ * percentile: 0 for the smallest, 50 for the median and 100 for the
+ * largest error. The timing error is the time between a frame's deadline
+ * and its write(), in nanoseconds. It is 0 for all frames if the replay
+ * runs as fast as possible.
+ *
+ * @param replay The replay
+ * @param percentile The percentile, 0 to 100
+ * @return The timing error in nanoseconds, or 0 if no frame was posted
+ * or percentile is larger than 100
+ */
+int64_t libevdev_uinput_replay_get_timing_error(struct libevdev_uinput_replay *replay,
+						unsigned int percentile);
+
+/**
+ * @ingroup uinput
+ *
+ * Filter for the frames forwarded by a proxy, see
+ * libevdev_uinput_proxy_set_filter(). The events of one frame, ending
+ * with EV_SYN/SYN_REPORT, are passed in and may be modified, reordered
+ * or removed in place. No events may be added.
+ *
+ * @param events The events of the frame
+ * @param nevents The number of events
+ * @param data The data passed to libevdev_uinput_proxy_set_filter()
+ * @return The number of events at the start of events to forward, 0 to
+ * drop the frame
+ */
+typedef unsigned int (*libevdev_uinput_proxy_filter_func_t)(struct input_event *events,
+							    unsigned int nevents,
+							    void *data);
+
+/**
+ * @ingroup uinput
+ *
+ * Create a proxy that forwards the events of the source device to a
+ * uinput device created from it, see
+ * libevdev_uinput_create_from_device(). The source device is grabbed,
+ * other clients only see the events through the uinput device.
+ *
+ * Call libevdev_uinput_proxy_dispatch() whenever the source's fd is
+ * readable. The source device must not be read by the caller while the
+ * proxy exists and it must outlive the proxy.
+ *
+ * @param source The device to forward, initialized with an fd
+ * @param uinput_fd @ref LIBEVDEV_UINPUT_OPEN_MANAGED or a file descriptor
+ * to @c /dev/uinput
+ * @param[out] proxy The newly created proxy
+ * @return 0 on success or a negative errno on failure
+ *
+ * @see libevdev_uinput_proxy_free
+ */
+int libevdev_uinput_proxy_new(struct libevdev *source, int uinput_fd,
+			      struct libevdev_uinput_proxy **proxy);
+
+/**
+ * @ingroup uinput
+ *
+ * Ungrab the source device, destroy the uinput device and free the
+ * proxy.
+ *
+ * @param proxy The proxy to free
+ */
+void libevdev_uinput_proxy_free(struct libevdev_uinput_proxy *proxy);
+
+/**
+ * @ingroup uinput
+ *
+ * @param proxy The proxy
+ * @return The uinput device the events are forwarded to. It is owned by
+ * the proxy.
+ */
+struct libevdev_uinput *
+libevdev_uinput_proxy_get_uinput(const struct libevdev_uinput_proxy *proxy);
+
+/**
+ * @ingroup uinput
+ *
+ * Set a filter that is called for each frame before it is forwarded.
+ *
+ * @param proxy The proxy
+ * @param filter The filter or NULL to forward all frames unmodified
+ * @param data Passed to the filter
+ */
+void libevdev_uinput_proxy_set_filter(struct libevdev_uinput_proxy *proxy,
+				      libevdev_uinput_proxy_filter_func_t filter,
+				      void *data);
+
+/**
+ * @ingroup uinput
+ *
+ * Read the pending events from the source device and forward each
+ * complete frame with a single write(). An incomplete frame is kept
+ * until its SYN_REPORT arrives with a later call.
+ *
+ * If the source device reports a SYN_DROPPED, the incomplete frame is
+ * discarded. The device is synced and the sync events are forwarded like
+ * any other events: each SYN_REPORT in them ends a frame that is passed
+ * to the filter and written. The uinput device ends up in the source's
+ * state without its clients seeing a SYN_DROPPED.
+ *
+ * Once a frame was forwarded and no more events are buffered, this
+ * function returns without another read(), a blocking fd does not block.
+ *
+ * @param proxy The proxy
+ * @return 0 on success or a negative errno on failure
+ */
+int libevdev_uinput_proxy_dispatch(struct libevdev_uinput_proxy *proxy);
+
+/**
+ * @ingroup uinput
+ *
+ * Create an aggregator that merges the events of several source devices
+ * into one uinput device, e.g. the separate nodes a keyboard has for its
+ * keys and its media keys. The uinput device has the properties and the
+ * event codes of all sources; for an axis or a repeat value present on
+ * more than one source, the first source's values are used. The bus type
+ * and ids are the ones of the first source. All sources are grabbed.
+ *
+ * A key is down on the uinput device while at least one source holds it
+ * down. Other events are forwarded as-is; MT slots are not remapped and
+ * two touch devices cannot be merged.
+ *
+ * The sources must outlive the aggregator and must not be read by the
+ * caller while the aggregator exists. Their fds must be non-blocking.
+ *
+ * @param sources The devices to merge, initialized with an fd
+ * @param nsources The number of sources
+ * @param name The name of the uinput device, or NULL for the first
+ * source's name
+ * @param uinput_fd @ref LIBEVDEV_UINPUT_OPEN_MANAGED or a file descriptor
+ * to @c /dev/uinput
+ * @param[out] aggregator The newly created aggregator
+ * @return 0 on success or a negative errno on failure
+ *
+ * @see libevdev_uinput_aggregator_dispatch
+ * @see libevdev_uinput_aggregator_free
+ */
+int libevdev_uinput_aggregator_new(struct libevdev * const *sources,
+				   unsigned int nsources,
+				   const char *name,
+				   int uinput_fd,
+				   struct libevdev_uinput_aggregator **aggregator);
+
+/**
+ * @ingroup uinput
+ *
+ * Ungrab the sources, destroy the uinput device and free the aggregator.
+ *
+ * @param aggregator The aggregator to free
+ */
+void libevdev_uinput_aggregator_free(struct libevdev_uinput_aggregator *aggregator);
+
+/**
+ * @ingroup uinput
+ *
+ * @param aggregator The aggregator
+ * @return The uinput device the events are merged into. It is owned by
+ * the aggregator.
+ */
+struct libevdev_uinput *
+libevdev_uinput_aggregator_get_uinput(const struct libevdev_uinput_aggregator *aggregator);
+
+/**
+ * @ingroup uinput
+ *
+ * Read the pending events of all sources and post their complete frames,
+ * sorted by timestamp, with a single write(). Incomplete frames are kept
+ * until their SYN_REPORT arrives with a later call. After a SYN_DROPPED
+ * on a source, its incomplete frame is discarded and the changes found
+ * by syncing the source are posted as one frame.
+ *
+ * Call this function whenever one of the sources' fds is readable.
+ *
+ * @param aggregator The aggregator
+ * @return 0 on success or a negative errno on failure
+ */
+int libevdev_uinput_aggregator_dispatch(struct libevdev_uinput_aggregator *aggregator);
+
+/**
+ * @ingroup uinput
+ *
+ * A routing rule for libevdev_uinput_splitter_new(): the codes
+ * code_min to code_max inclusive of the given type go to the uinput
+ * device with the index sink.
+ */
+struct libevdev_uinput_split_rule {
+	unsigned int type; /**< The event type, not EV_SYN or EV_REP */
+	unsigned int code_min; /**< The first code of the range */
+	unsigned int code_max; /**< The last code of the range */
+	unsigned int sink; /**< The index of the uinput device */
+};
+
+/**
+ * @ingroup uinput
+ *
+ * Create a splitter that routes the events of one source device to
+ * several uinput devices, e.g. to separate the buttons and dials of a
+ * gaming keypad from its pointer. Each uinput device is created with the
+ * source's codes routed to it by the rules; if several rules match a
+ * code, the first one wins and codes no rule matches are dropped. The
+ * uinput devices with axes get the source's properties, the ones with
+ * keys its repeat settings. The source is grabbed.
+ *
+ * ABS_MT_SLOT must be routed to the same device as the other MT axes.
+ * SYN_MT_REPORT goes with ABS_MT_POSITION_X.
+ *
+ * The source must outlive the splitter and must not be read by the
+ * caller while the splitter exists.
+ *
+ * @param source The device to split, initialized with an fd
+ * @param rules The routing rules
+ * @param nrules The number of rules
+ * @param names The names of the uinput devices, or NULL. If NULL or an
+ * entry is NULL, the source's name followed by the index is used.
+ * @param nsinks The number of uinput devices to create
+ * @param uinput_fd @ref LIBEVDEV_UINPUT_OPEN_MANAGED or a file descriptor
+ * to @c /dev/uinput
+ * @param[out] splitter The newly created splitter
+ * @return 0 on success or a negative errno on failure. -EINVAL if a rule
+ * is invalid or a uinput device would have no codes.
+ *
+ * @see libevdev_uinput_splitter_dispatch
+ * @see libevdev_uinput_splitter_free
+ */
+int libevdev_uinput_splitter_new(struct libevdev *source,
+				 const struct libevdev_uinput_split_rule *rules,
+				 unsigned int nrules,
+				 const char * const *names,
+				 unsigned int nsinks,
+				 int uinput_fd,
+				 struct libevdev_uinput_splitter **splitter);
+
+/**
+ * @ingroup uinput
+ *
+ * Ungrab the source, destroy the uinput devices and free the splitter.
+ *
+ * @param splitter The splitter to free
+ */
+void libevdev_uinput_splitter_free(struct libevdev_uinput_splitter *splitter);
+
+/**
+ * @ingroup uinput
+ *
+ * @param splitter The splitter
+ * @param sink The index of the uinput device
+ * @return The uinput device, owned by the splitter, or NULL if the index
+ * is out of range
+ */
+struct libevdev_uinput *
+libevdev_uinput_splitter_get_uinput(const struct libevdev_uinput_splitter *splitter,
+				    unsigned int sink);
+
+/**
+ * @ingroup uinput
+ *
+ * Read the pending events from the source device and route them. Once a
+ * frame is complete, its events for each uinput device are posted with
+ * a single write() per device; a device without events in the frame is
+ * skipped. An incomplete frame is kept until its SYN_REPORT arrives with
+ * a later call. After a SYN_DROPPED, the incomplete frame is discarded
+ * and the sync events are routed instead.
+ *
+ * Once a frame was posted and no more events are buffered, this function
+ * returns without another read(), a blocking fd does not block.
+ *
+ * @param splitter The splitter
+ * @return 0 on success or a negative errno on failure
+ */
+int libevdev_uinput_splitter_dispatch(struct libevdev_uinput_splitter *splitter);
+
 #ifdef __cplusplus
 }
 #endif
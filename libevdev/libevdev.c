@@ -29,6 +29,7 @@
 #include <unistd.h>
 #include <stdarg.h>
 #include <stdbool.h>
+#include <stddef.h>
 
 #include "libevdev.h"
 #include "libevdev-int.h"
@@ -36,6 +37,7 @@
 #include "event-names.h"
 
 #define MAXEVENTS 64
+#define MAX_CONVERTED_SLOTS 1024
 
 enum event_filter_status {
 	EVENT_FILTER_NONE,	/**< Event untouched by filters */
@@ -57,11 +59,86 @@ slot_value(const struct libevdev *dev, int slot, int axis)
 			axis, ABS_MT_MIN, ABS_MT_MAX);
 		axis = ABS_MT_MIN;
 	}
-	return &dev->mt_slot_vals[slot * ABS_MT_CNT + axis - ABS_MT_MIN];
+	return &dev->mt_slot_vals[(axis - ABS_MT_MIN) * dev->num_slots + slot];
 }
 
+/**
+ * Bit index of an axis of a slot in mt_sync.slot_update and
+ * mt_changes. The ABS_MT_SLOT bit of a slot is set if any of its axes is
+ * set.
+ */
+#define AXISBIT(_slot, _axis) ((_slot) * ABS_MT_CNT + (_axis) - ABS_MT_MIN)
+
+/**
+ * Set a slot value, keeping the active slot bitmap up-to-date. slot must
+ * be a valid slot.
+ */
+static inline void
+set_slot_value(struct libevdev *dev, int slot, int axis, int value)
+{
+	*slot_value(dev, slot, axis) = value;
+	if (axis == ABS_MT_TRACKING_ID)
+		set_bit_state(dev->mt_active_slots, slot, value != -1);
+}
+
+/**
+ * @return the abs_info for this code or NULL if the axis is not enabled
+ */
+static inline struct input_absinfo *
+abs_info_ptr(const struct libevdev *dev, unsigned int code)
+{
+	if (code > ABS_MAX || !bit_is_set(dev->caps->abs_bits, code))
+		return NULL;
+
+	return &dev->abs_info[code];
+}
+
+/**
+ * Allocate the abs_info of all axes when the first axis is enabled. The
+ * array is never moved afterwards, so pointers returned by
+ * libevdev_get_abs_info() stay valid while axes are enabled and
+ * disabled.
+ */
 static int
-init_event_queue(struct libevdev *dev)
+abs_info_alloc(struct libevdev *dev)
+{
+	if (dev->abs_info)
+		return 0;
+
+	dev->abs_info = calloc(ABS_CNT, sizeof(*dev->abs_info));
+	if (!dev->abs_info)
+		return -ENOMEM;
+
+	return 0;
+}
+
+/**
+ * @return true if the value of the code is stored per slot. The
+ * abs_info[code].value of these codes is not updated on a slot switch,
+ * see current_abs_value().
+ */
+static inline bool
+is_slotted_code(const struct libevdev *dev, unsigned int code)
+{
+	return code > ABS_MT_SLOT && code <= ABS_MT_MAX &&
+	       dev->num_slots > -1 && dev->current_slot > -1;
+}
+
+/**
+ * @return the value of an enabled ABS code, for MT codes the value in the
+ * current slot
+ */
+static inline int
+current_abs_value(const struct libevdev *dev, unsigned int code)
+{
+	if (is_slotted_code(dev, code))
+		return *slot_value(dev, dev->current_slot, code);
+
+	return abs_info_ptr(dev, code)->value;
+}
+
+static size_t
+event_queue_size(const struct libevdev *dev)
 {
 	const int MIN_QUEUE_SIZE = 256;
 	int nevents = 1; /* terminating SYN_REPORT */
@@ -94,7 +171,124 @@ init_event_queue(struct libevdev *dev)
 		nevents += num_mt_axes * (nslots - 1);
 	}
 
-	return queue_alloc(dev, max(MIN_QUEUE_SIZE, nevents * 2));
+	return max(MIN_QUEUE_SIZE, nevents * 2);
+}
+
+static size_t
+arena_reserve(size_t *size, size_t len, size_t align)
+{
+	size_t offset = (*size + align - 1) & ~(align - 1);
+
+	*size = offset + len;
+
+	return offset;
+}
+
+static char *
+arena_strcpy(char *arena, size_t offset, const char *str)
+{
+	if (!str)
+		return NULL;
+
+	return strcpy(arena + offset, str);
+}
+
+/**
+ * Allocate all buffers of a device whose size is known once the
+ * capabilities and the number of slots are set, in one allocation.
+ *
+ * @param abs_info The dense abs_info for all ABS_CNT axes, only the
+ * enabled axes are copied. No abs_info is allocated for a device
+ * without axes.
+ * @param queue_size The number of events in the queue, may be 0
+ */
+static int
+init_arena(struct libevdev *dev,
+	   const char *name, const char *phys, const char *uniq,
+	   const struct input_absinfo *abs_info,
+	   size_t queue_size)
+{
+	size_t sz = 0;
+	size_t o_abs, o_slots, o_active, o_changes, o_last_changes,
+	       o_mt_state, o_tracking, o_update, o_queue,
+	       o_name, o_phys, o_uniq;
+	size_t nslots = max(dev->num_slots, 0);
+	size_t active_slots_sz = 0,
+	       mt_state_sz = 0,
+	       tracking_id_changes_sz = 0,
+	       slot_update_sz = 0;
+	unsigned int code;
+	bool has_abs = false;
+	char *arena;
+
+	for (code = 0; code < ARRAY_LENGTH(dev->caps->abs_bits); code++)
+		has_abs |= dev->caps->abs_bits[code] != 0;
+
+	if (dev->num_slots > -1) {
+		active_slots_sz = NLONGS(nslots) * sizeof(long);
+		mt_state_sz = sizeof(*dev->mt_sync.mt_state) + nslots * sizeof(int);
+		tracking_id_changes_sz = NLONGS(nslots) * sizeof(long);
+		slot_update_sz = NLONGS(nslots * ABS_MT_CNT) * sizeof(long);
+	}
+
+	/* dense rather than one entry per axis, so enabling another axis
+	   never moves the entries libevdev_get_abs_info() handed out */
+	o_abs = arena_reserve(&sz, has_abs ? ABS_CNT * sizeof(*abs_info) : 0,
+			      __alignof__(*abs_info));
+	o_slots = arena_reserve(&sz, nslots * ABS_MT_CNT * sizeof(int),
+				__alignof__(int));
+	o_active = arena_reserve(&sz, active_slots_sz, __alignof__(long));
+	o_changes = arena_reserve(&sz, slot_update_sz, __alignof__(long));
+	o_last_changes = arena_reserve(&sz, slot_update_sz, __alignof__(long));
+	o_mt_state = arena_reserve(&sz, mt_state_sz,
+				   __alignof__(*dev->mt_sync.mt_state));
+	o_tracking = arena_reserve(&sz, tracking_id_changes_sz, __alignof__(long));
+	o_update = arena_reserve(&sz, slot_update_sz, __alignof__(long));
+	o_queue = arena_reserve(&sz, queue_size * sizeof(struct input_event),
+				__alignof__(struct input_event));
+	o_name = arena_reserve(&sz, name ? strlen(name) + 1 : 0, 1);
+	o_phys = arena_reserve(&sz, phys ? strlen(phys) + 1 : 0, 1);
+	o_uniq = arena_reserve(&sz, uniq ? strlen(uniq) + 1 : 0, 1);
+
+	arena = calloc(1, sz);
+	if (!arena)
+		return -ENOMEM;
+
+	dev->arena = arena;
+	dev->arena_sz = sz;
+
+	if (has_abs) {
+		dev->abs_info = (struct input_absinfo*)(arena + o_abs);
+		for (code = 0; code < ABS_CNT; code++) {
+			if (bit_is_set(dev->caps->abs_bits, code))
+				dev->abs_info[code] = abs_info[code];
+		}
+	}
+
+	if (dev->num_slots > -1) {
+		dev->mt_slot_vals = (int*)(arena + o_slots);
+		dev->mt_active_slots = (unsigned long*)(arena + o_active);
+		dev->mt_changes = (unsigned long*)(arena + o_changes);
+		dev->mt_last_changes = (unsigned long*)(arena + o_last_changes);
+		dev->mt_sync.mt_state = (struct mt_sync_state*)(arena + o_mt_state);
+		dev->mt_sync.mt_state_sz = mt_state_sz;
+		dev->mt_sync.tracking_id_changes = (unsigned long*)(arena + o_tracking);
+		dev->mt_sync.tracking_id_changes_sz = tracking_id_changes_sz;
+		dev->mt_sync.slot_update = (unsigned long*)(arena + o_update);
+		dev->mt_sync.slot_update_sz = slot_update_sz;
+	}
+
+	if (queue_size > 0) {
+		dev->queue = (struct input_event*)(arena + o_queue);
+		dev->queue_size = queue_size;
+		dev->queue_next = 0;
+	}
+
+	dev->name = arena_strcpy(arena, o_name, name);
+	dev->phys = arena_strcpy(arena, o_phys, phys);
+	dev->uniq = arena_strcpy(arena, o_uniq, uniq);
+
+	return 0;
 }
 
 static void
@@ -189,28 +383,305 @@ _libevdev_log_msg(const struct libevdev *dev,
 	va_end(args);
 }
 
+/*
+ * The capabilities every device starts with. Modifying them splits off a
+ * private copy, see caps_make_private().
+ */
+static struct capabilities empty_caps = {
+	.refcount = -1,
+};
+
+static struct capabilities *
+caps_ref(struct capabilities *caps)
+{
+	if (caps->refcount != -1)
+		caps->refcount++;
+
+	return caps;
+}
+
+static void
+caps_unref(struct capabilities *caps)
+{
+	if (!caps || caps->refcount == -1)
+		return;
+
+	if (--caps->refcount == 0)
+		free(caps);
+}
+
+/**
+ * Make sure the device's capabilities are not shared with any other
+ * device. This must be called before modifying any of the capability
+ * bits.
+ *
+ * @return 0 on success, or -ENOMEM
+ */
+static int
+caps_make_private(struct libevdev *dev)
+{
+	struct capabilities *caps;
+
+	if (dev->caps->refcount == 1)
+		return 0;
+
+	caps = malloc(sizeof(*caps));
+	if (!caps)
+		return -ENOMEM;
+
+	*caps = *dev->caps;
+	caps->refcount = 1;
+
+	caps_unref(dev->caps);
+	dev->caps = caps;
+
+	return 0;
+}
+
+/*
+ * Streaming MurmurHash3 x64_128 for the capability fingerprint. The input
+ * is fed bytewise so the result does not depend on the host's endianness
+ * or word size.
+ */
+struct hash_state {
+	uint64_t h1, h2;
+	uint8_t block[16];
+	size_t nblock;
+	uint64_t len;
+};
+
+static inline uint64_t
+rotl64(uint64_t x, int r)
+{
+	return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t
+fmix64(uint64_t k)
+{
+	k ^= k >> 33;
+	k *= 0xff51afd7ed558ccdULL;
+	k ^= k >> 33;
+	k *= 0xc4ceb9fe1a85ec53ULL;
+	k ^= k >> 33;
+	return k;
+}
+
+static inline uint64_t
+le64(const uint8_t *p, size_t n)
+{
+	uint64_t v = 0;
+
+	while (n-- > 0)
+		v = (v << 8) | p[n];
+
+	return v;
+}
+
+#define HASH_C1 0x87c37b91114253d5ULL
+#define HASH_C2 0x4cf5ad432745937fULL
+
+static void
+hash_block(struct hash_state *s)
+{
+	uint64_t k1 = le64(&s->block[0], 8),
+		 k2 = le64(&s->block[8], 8);
+
+	k1 *= HASH_C1; k1 = rotl64(k1, 31); k1 *= HASH_C2; s->h1 ^= k1;
+	s->h1 = rotl64(s->h1, 27); s->h1 += s->h2; s->h1 = s->h1 * 5 + 0x52dce729;
+
+	k2 *= HASH_C2; k2 = rotl64(k2, 33); k2 *= HASH_C1; s->h2 ^= k2;
+	s->h2 = rotl64(s->h2, 31); s->h2 += s->h1; s->h2 = s->h2 * 5 + 0x38495ab5;
+}
+
+static void
+hash_u8(struct hash_state *s, uint8_t byte)
+{
+	s->block[s->nblock++] = byte;
+	s->len++;
+
+	if (s->nblock == sizeof(s->block)) {
+		hash_block(s);
+		s->nblock = 0;
+	}
+}
+
+static void
+hash_u32(struct hash_state *s, uint32_t v)
+{
+	hash_u8(s, v & 0xff);
+	hash_u8(s, (v >> 8) & 0xff);
+	hash_u8(s, (v >> 16) & 0xff);
+	hash_u8(s, v >> 24);
+}
+
+/**
+ * Hash the bitmap up to and including the highest bit set, so the hash
+ * does not change when the kernel headers add new codes.
+ */
+static void
+hash_bitmap(struct hash_state *s, const unsigned long *bits, int max)
+{
+	int last = max;
+	int code;
+
+	while (last >= 0 && !bit_is_set(bits, last))
+		last--;
+
+	hash_u32(s, last + 1);
+	for (code = 0; code <= last; code += 8) {
+		uint8_t byte = 0;
+		int i;
+
+		for (i = 0; i < 8 && code + i <= last; i++) {
+			if (bit_is_set(bits, code + i))
+				byte |= 1 << i;
+		}
+		hash_u8(s, byte);
+	}
+}
+
+static void
+hash_final(struct hash_state *s, uint64_t out[2])
+{
+	uint64_t k1, k2;
+
+	if (s->nblock > 8) {
+		k2 = le64(&s->block[8], s->nblock - 8);
+		k2 *= HASH_C2; k2 = rotl64(k2, 33); k2 *= HASH_C1; s->h2 ^= k2;
+	}
+	if (s->nblock > 0) {
+		k1 = le64(&s->block[0], min(s->nblock, 8U));
+		k1 *= HASH_C1; k1 = rotl64(k1, 31); k1 *= HASH_C2; s->h1 ^= k1;
+	}
+
+	s->h1 ^= s->len;
+	s->h2 ^= s->len;
+	s->h1 += s->h2;
+	s->h2 += s->h1;
+	s->h1 = fmix64(s->h1);
+	s->h2 = fmix64(s->h2);
+	s->h1 += s->h2;
+	s->h2 += s->h1;
+
+	out[0] = s->h1;
+	out[1] = s->h2;
+}
+
+/**
+ * Hash the event types and codes, the properties and the axis ranges.
+ *
+ * @param abs_info The abs_info of all ABS_CNT axes by code, only the
+ * entries of enabled axes are read
+ */
+static void
+hash_capabilities(const struct capabilities *caps,
+		  const struct input_absinfo *abs_info,
+		  uint64_t fingerprint[2])
+{
+	struct hash_state s = {0};
+	unsigned long bits[NLONGS(EV_CNT)];
+	unsigned int type, code;
+
+	/* EV_SYN is implied, whether the bit is set or not */
+	memcpy(bits, caps->bits, sizeof(bits));
+	set_bit(bits, EV_SYN);
+
+	hash_bitmap(&s, bits, EV_MAX);
+	hash_bitmap(&s, caps->props, INPUT_PROP_MAX);
+
+	/* codes of a disabled type are ignored, same as in
+	 * libevdev_has_event_code() */
+	for (type = 1; type < EV_CNT; type++) {
+		unsigned long *mask;
+		int max = caps_type_to_mask((struct capabilities *)caps, type, &mask);
+
+		if (max == -1 || !bit_is_set(bits, type))
+			continue;
+
+		hash_bitmap(&s, mask, max);
+	}
+
+	for (code = 0; bit_is_set(bits, EV_ABS) && code < ABS_CNT; code++) {
+		const struct input_absinfo *abs = &abs_info[code];
+
+		if (!bit_is_set(caps->abs_bits, code))
+			continue;
+
+		hash_u32(&s, abs->minimum);
+		hash_u32(&s, abs->maximum);
+		hash_u32(&s, abs->fuzz);
+		hash_u32(&s, abs->flat);
+		hash_u32(&s, abs->resolution);
+	}
+
+	hash_final(&s, fingerprint);
+}
+
+/**
+ * Cache the fingerprint of the device if it is out of date. Mutators only
+ * set fingerprint_dirty so building a device code by code doesn't hash
+ * the capabilities each time.
+ */
+static void
+update_fingerprint(struct libevdev *dev)
+{
+	if (!dev->fingerprint_dirty)
+		return;
+
+	hash_capabilities(dev->caps, dev->abs_info, dev->fingerprint);
+	dev->fingerprint_dirty = false;
+}
+
+/**
+ * Copy the fingerprint of the device, hashing the capabilities if they
+ * changed since the fingerprint was cached.
+ */
+static void
+get_fingerprint(const struct libevdev *dev, uint64_t fingerprint[2])
+{
+	if (dev->fingerprint_dirty) {
+		hash_capabilities(dev->caps, dev->abs_info, fingerprint);
+		return;
+	}
+
+	fingerprint[0] = dev->fingerprint[0];
+	fingerprint[1] = dev->fingerprint[1];
+}
+
 static void
 libevdev_reset(struct libevdev *dev)
 {
 	enum libevdev_log_priority pri = dev->log.priority;
 	libevdev_device_log_func_t handler = dev->log.device_handler;
 
-	free(dev->name);
-	free(dev->phys);
-	free(dev->uniq);
-	free(dev->mt_slot_vals);
-	free(dev->mt_sync.mt_state);
-	free(dev->mt_sync.tracking_id_changes);
-	free(dev->mt_sync.slot_update);
+	caps_unref(dev->caps);
+	arena_free(dev, dev->name);
+	arena_free(dev, dev->phys);
+	arena_free(dev, dev->uniq);
+	arena_free(dev, dev->abs_info);
+	arena_free(dev, dev->mt_slot_vals);
+	arena_free(dev, dev->mt_active_slots);
+	arena_free(dev, dev->mt_changes);
+	arena_free(dev, dev->mt_last_changes);
+	arena_free(dev, dev->mt_sync.mt_state);
+	arena_free(dev, dev->mt_sync.tracking_id_changes);
+	arena_free(dev, dev->mt_sync.slot_update);
+	free(dev->touch_history.frames);
+	free(dev->touch_history.touches);
+	_libevdev_mt_converter_free(dev->mt_converter);
+	free(dev->arena);
 	memset(dev, 0, sizeof(*dev));
 	dev->fd = -1;
 	dev->initialized = false;
+	dev->caps = &empty_caps;
 	dev->num_slots = -1;
 	dev->current_slot = -1;
 	dev->grabbed = LIBEVDEV_UNGRAB;
 	dev->sync_state = SYNC_NONE;
 	dev->log.priority = pri;
 	dev->log.device_handler = handler;
+	dev->fingerprint_dirty = true;
 	libevdev_enable_event_type(dev, EV_SYN);
 }
 
@@ -315,113 +786,263 @@ libevdev_change_fd(struct libevdev *dev, int fd)
 	return 0;
 }
 
-LIBEVDEV_EXPORT int
-libevdev_set_fd(struct libevdev* dev, int fd)
+/**
+ * Read the name, phys and uniq of the device behind fd.
+ *
+ * @return 0 on success or -1 with errno set
+ */
+static int
+read_names(int fd, struct device_description *desc)
 {
 	int rc;
-	int i;
-	char buf[256];
-
-	if (dev->initialized) {
-		log_bug(dev, "device already initialized.\n");
-		return -EBADF;
-	} else if (fd < 0)
-		return -EBADF;
-
-	libevdev_reset(dev);
-
-	rc = ioctl(fd, EVIOCGBIT(0, sizeof(dev->bits)), dev->bits);
-	if (rc < 0)
-		goto out;
 
-	memset(buf, 0, sizeof(buf));
-	rc = ioctl(fd, EVIOCGNAME(sizeof(buf) - 1), buf);
+	rc = ioctl(fd, EVIOCGNAME(sizeof(desc->name) - 1), desc->name);
 	if (rc < 0)
-		goto out;
-
-	free(dev->name);
-	dev->name = strdup(buf);
-	if (!dev->name) {
-		errno = ENOMEM;
-		goto out;
-	}
+		return -1;
 
-	free(dev->phys);
-	dev->phys = NULL;
-	memset(buf, 0, sizeof(buf));
-	rc = ioctl(fd, EVIOCGPHYS(sizeof(buf) - 1), buf);
+	rc = ioctl(fd, EVIOCGPHYS(sizeof(desc->phys) - 1), desc->phys);
 	if (rc < 0) {
 		/* uinput has no phys */
 		if (errno != ENOENT)
-			goto out;
+			return -1;
 	} else {
-		dev->phys = strdup(buf);
-		if (!dev->phys) {
-			errno = ENOMEM;
-			goto out;
-		}
+		desc->has_phys = true;
 	}
 
-	free(dev->uniq);
-	dev->uniq = NULL;
-	memset(buf, 0, sizeof(buf));
-	rc = ioctl(fd, EVIOCGUNIQ(sizeof(buf) - 1), buf);
+	rc = ioctl(fd, EVIOCGUNIQ(sizeof(desc->uniq) - 1), desc->uniq);
 	if (rc < 0) {
 		if (errno != ENOENT)
-			goto out;
+			return -1;
 	} else  {
-		dev->uniq = strdup(buf);
-		if (!dev->uniq) {
-			errno = ENOMEM;
-			goto out;
+		desc->has_uniq = true;
+	}
+
+	return 0;
+}
+
+/**
+ * Read the ids, properties, event codes and axis ranges of the device
+ * behind fd. The rest of desc is zeroed.
+ *
+ * @return 0 on success or -1 with errno set
+ */
+static int
+read_capabilities(int fd, struct device_description *desc)
+{
+	struct capabilities *caps = &desc->caps;
+	int rc;
+	int i;
+
+	memset(desc, 0, sizeof(*desc));
+
+	rc = ioctl(fd, EVIOCGBIT(0, sizeof(caps->bits)), caps->bits);
+	if (rc < 0)
+		return -1;
+
+	rc = ioctl(fd, EVIOCGID, &desc->ids);
+	if (rc < 0)
+		return -1;
+
+	rc = ioctl(fd, EVIOCGVERSION, &desc->driver_version);
+	if (rc < 0)
+		return -1;
+
+	/* Built on a kernel with props, running against a kernel without property
+	   support. This should not be a fatal case, we'll be missing properties but other
+	   than that everything is as expected.
+	 */
+	rc = ioctl(fd, EVIOCGPROP(sizeof(caps->props)), caps->props);
+	if (rc < 0 && errno != EINVAL)
+		return -1;
+
+	rc = ioctl(fd, EVIOCGBIT(EV_REL, sizeof(caps->rel_bits)), caps->rel_bits);
+	if (rc < 0)
+		return -1;
+
+	rc = ioctl(fd, EVIOCGBIT(EV_ABS, sizeof(caps->abs_bits)), caps->abs_bits);
+	if (rc < 0)
+		return -1;
+
+	rc = ioctl(fd, EVIOCGBIT(EV_LED, sizeof(caps->led_bits)), caps->led_bits);
+	if (rc < 0)
+		return -1;
+
+	rc = ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(caps->key_bits)), caps->key_bits);
+	if (rc < 0)
+		return -1;
+
+	rc = ioctl(fd, EVIOCGBIT(EV_SW, sizeof(caps->sw_bits)), caps->sw_bits);
+	if (rc < 0)
+		return -1;
+
+	rc = ioctl(fd, EVIOCGBIT(EV_MSC, sizeof(caps->msc_bits)), caps->msc_bits);
+	if (rc < 0)
+		return -1;
+
+	rc = ioctl(fd, EVIOCGBIT(EV_FF, sizeof(caps->ff_bits)), caps->ff_bits);
+	if (rc < 0)
+		return -1;
+
+	rc = ioctl(fd, EVIOCGBIT(EV_SND, sizeof(caps->snd_bits)), caps->snd_bits);
+	if (rc < 0)
+		return -1;
+
+	/* rep is a special case, always set it to 1 for both values if EV_REP is set */
+	if (bit_is_set(caps->bits, EV_REP)) {
+		for (i = 0; i < REP_CNT; i++)
+			set_bit(caps->rep_bits, i);
+		rc = ioctl(fd, EVIOCGREP, desc->rep_values);
+		if (rc < 0)
+			return -1;
+	}
+
+	for (i = ABS_X; i <= ABS_MAX; i++) {
+		if (bit_is_set(caps->abs_bits, i)) {
+			rc = ioctl(fd, EVIOCGABS(i), &desc->abs_info[i]);
+			if (rc < 0)
+				return -1;
 		}
 	}
 
-	rc = ioctl(fd, EVIOCGID, &dev->ids);
+	return 0;
+}
+
+/**
+ * Read the identity and capabilities of the device behind fd.
+ *
+ * @return 0 on success or -1 with errno set
+ */
+static int
+read_description(int fd, struct device_description *desc)
+{
+	if (read_capabilities(fd, desc) < 0)
+		return -1;
+
+	return read_names(fd, desc);
+}
+
+static int
+init_from_description(struct libevdev *dev,
+		      const struct device_description *desc,
+		      bool with_queue)
+{
+	int rc;
+	int i;
+
+	rc = caps_make_private(dev);
+	if (rc < 0)
+		return rc;
+
+	memcpy((char*)dev->caps + offsetof(struct capabilities, bits),
+	       (const char*)&desc->caps + offsetof(struct capabilities, bits),
+	       sizeof(*dev->caps) - offsetof(struct capabilities, bits));
+
+	dev->ids = desc->ids;
+	dev->driver_version = desc->driver_version;
+	memcpy(dev->rep_values, desc->rep_values, sizeof(dev->rep_values));
+
+	/* devices with ABS_MT_SLOT - 1 aren't MT devices,
+	   see the documentation for multitouch-related
+	   functions for more details */
+	if (!libevdev_has_event_code(dev, EV_ABS, ABS_MT_SLOT - 1) &&
+	    libevdev_has_event_code(dev, EV_ABS, ABS_MT_SLOT)) {
+		dev->num_slots = desc->abs_info[ABS_MT_SLOT].maximum + 1;
+		dev->current_slot = desc->abs_info[ABS_MT_SLOT].value;
+	}
+
+	rc = init_arena(dev, desc->name,
+			desc->has_phys ? desc->phys : NULL,
+			desc->has_uniq ? desc->uniq : NULL,
+			desc->abs_info,
+			with_queue ? event_queue_size(dev) : 0);
 	if (rc < 0)
-		goto out;
+		return rc;
+
+	for (i = ABS_X; i <= ABS_MAX; i++) {
+		if (bit_is_set(dev->caps->abs_bits, i))
+			fix_invalid_absinfo(dev, i, abs_info_ptr(dev, i));
+	}
+
+	update_fingerprint(dev);
+
+	return 0;
+}
 
-	rc = ioctl(fd, EVIOCGVERSION, &dev->driver_version);
+int
+_libevdev_init_from_description(struct libevdev *dev,
+				const struct device_description *desc)
+{
+	int rc;
+	int slot;
+
+	rc = init_from_description(dev, desc, false);
 	if (rc < 0)
-		goto out;
+		return rc;
+
+	/* no fd to sync from, all slots start without a touch */
+	for (slot = 0; slot < dev->num_slots; slot++)
+		set_slot_value(dev, slot, ABS_MT_TRACKING_ID, -1);
+
+	return 0;
+}
+
+/**
+ * Compare the ids, properties, event codes and axis ranges of the device
+ * behind fd to dev, without reading any state.
+ *
+ * @return true if the device behind fd looks like dev
+ */
+static bool
+same_capabilities(const struct libevdev *dev, int fd)
+{
+	struct device_description desc;
+	uint64_t fingerprint[2], current[2];
+	unsigned int code;
 
-	/* Built on a kernel with props, running against a kernel without property
-	   support. This should not be a fatal case, we'll be missing properties but other
-	   than that everything is as expected.
-	 */
-	rc = ioctl(fd, EVIOCGPROP(sizeof(dev->props)), dev->props);
-	if (rc < 0 && errno != EINVAL)
-		goto out;
+	if (read_capabilities(fd, &desc) < 0 ||
+	    memcmp(&desc.ids, &dev->ids, sizeof(desc.ids)) != 0)
+		return false;
 
-	rc = ioctl(fd, EVIOCGBIT(EV_REL, sizeof(dev->rel_bits)), dev->rel_bits);
-	if (rc < 0)
-		goto out;
+	for (code = 0; code < ABS_CNT; code++) {
+		if (bit_is_set(desc.caps.abs_bits, code))
+			fix_invalid_absinfo(dev, code, &desc.abs_info[code]);
+	}
 
-	rc = ioctl(fd, EVIOCGBIT(EV_ABS, sizeof(dev->abs_bits)), dev->abs_bits);
-	if (rc < 0)
-		goto out;
+	/* the protocol A conversion added the slots to dev */
+	if (dev->mt_converter) {
+		if (bit_is_set(desc.caps.abs_bits, ABS_MT_SLOT))
+			return false;
+
+		set_bit(desc.caps.abs_bits, ABS_MT_SLOT);
+		desc.abs_info[ABS_MT_SLOT] = dev->abs_info[ABS_MT_SLOT];
+		if (!bit_is_set(desc.caps.abs_bits, ABS_MT_TRACKING_ID)) {
+			set_bit(desc.caps.abs_bits, ABS_MT_TRACKING_ID);
+			desc.abs_info[ABS_MT_TRACKING_ID] =
+				dev->abs_info[ABS_MT_TRACKING_ID];
+		}
+	}
 
-	rc = ioctl(fd, EVIOCGBIT(EV_LED, sizeof(dev->led_bits)), dev->led_bits);
-	if (rc < 0)
-		goto out;
+	hash_capabilities(&desc.caps, desc.abs_info, fingerprint);
+	get_fingerprint(dev, current);
 
-	rc = ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(dev->key_bits)), dev->key_bits);
-	if (rc < 0)
-		goto out;
+	return memcmp(fingerprint, current, sizeof(fingerprint)) == 0;
+}
 
-	rc = ioctl(fd, EVIOCGBIT(EV_SW, sizeof(dev->sw_bits)), dev->sw_bits);
-	if (rc < 0)
-		goto out;
+LIBEVDEV_EXPORT int
+libevdev_set_fd(struct libevdev* dev, int fd)
+{
+	int rc;
+	struct device_description desc;
 
-	rc = ioctl(fd, EVIOCGBIT(EV_MSC, sizeof(dev->msc_bits)), dev->msc_bits);
-	if (rc < 0)
-		goto out;
+	if (dev->initialized) {
+		log_bug(dev, "device already initialized.\n");
+		return -EBADF;
+	} else if (fd < 0)
+		return -EBADF;
 
-	rc = ioctl(fd, EVIOCGBIT(EV_FF, sizeof(dev->ff_bits)), dev->ff_bits);
-	if (rc < 0)
-		goto out;
+	libevdev_reset(dev);
 
-	rc = ioctl(fd, EVIOCGBIT(EV_SND, sizeof(dev->snd_bits)), dev->snd_bits);
+	rc = read_description(fd, &desc);
 	if (rc < 0)
 		goto out;
 
@@ -437,72 +1058,17 @@ libevdev_set_fd(struct libevdev* dev, int fd)
 	if (rc < 0)
 		goto out;
 
-	/* rep is a special case, always set it to 1 for both values if EV_REP is set */
-	if (bit_is_set(dev->bits, EV_REP)) {
-		for (i = 0; i < REP_CNT; i++)
-			set_bit(dev->rep_bits, i);
-		rc = ioctl(fd, EVIOCGREP, dev->rep_values);
-		if (rc < 0)
-			goto out;
-	}
-
-	for (i = ABS_X; i <= ABS_MAX; i++) {
-		if (bit_is_set(dev->abs_bits, i)) {
-			struct input_absinfo abs_info;
-			rc = ioctl(fd, EVIOCGABS(i), &abs_info);
-			if (rc < 0)
-				goto out;
-
-			fix_invalid_absinfo(dev, i, &abs_info);
-
-			dev->abs_info[i] = abs_info;
-		}
+	rc = init_from_description(dev, &desc, true);
+	if (rc < 0) {
+		errno = -rc;
+		rc = -1;
+		goto out;
 	}
 
 	dev->fd = fd;
 
-	/* devices with ABS_MT_SLOT - 1 aren't MT devices,
-	   see the documentation for multitouch-related
-	   functions for more details */
-	if (!libevdev_has_event_code(dev, EV_ABS, ABS_MT_SLOT - 1) &&
-	    libevdev_has_event_code(dev, EV_ABS, ABS_MT_SLOT)) {
-		const struct input_absinfo *abs_info;
-
-		abs_info = libevdev_get_abs_info(dev, ABS_MT_SLOT);
-
-		dev->num_slots = abs_info->maximum + 1;
-		dev->mt_slot_vals = calloc(dev->num_slots * ABS_MT_CNT, sizeof(int));
-		if (!dev->mt_slot_vals) {
-			rc = -ENOMEM;
-			goto out;
-		}
-		dev->current_slot = abs_info->value;
-
-		dev->mt_sync.mt_state_sz = sizeof(*dev->mt_sync.mt_state) +
-					   (dev->num_slots) * sizeof(int);
-		dev->mt_sync.mt_state = calloc(1, dev->mt_sync.mt_state_sz);
-
-		dev->mt_sync.tracking_id_changes_sz = NLONGS(dev->num_slots) * sizeof(long);
-		dev->mt_sync.tracking_id_changes = malloc(dev->mt_sync.tracking_id_changes_sz);
-
-		dev->mt_sync.slot_update_sz = NLONGS(dev->num_slots * ABS_MT_CNT) * sizeof(long);
-		dev->mt_sync.slot_update = malloc(dev->mt_sync.slot_update_sz);
-
-		if (!dev->mt_sync.tracking_id_changes ||
-		    !dev->mt_sync.slot_update ||
-		    !dev->mt_sync.mt_state) {
-			rc = -ENOMEM;
-			goto out;
-		}
-
+	if (dev->num_slots > -1)
 		sync_mt_state(dev, 0);
-	}
-
-	rc = init_event_queue(dev);
-	if (rc < 0) {
-		dev->fd = -1;
-		return -rc;
-	}
 
 	/* not copying key state because we won't know when we'll start to
 	 * use this fd and key's are likely to change state by then.
@@ -516,6 +1082,64 @@ out:
 	return rc ? -errno : 0;
 }
 
+LIBEVDEV_EXPORT int
+libevdev_reattach_fd(struct libevdev *dev, int fd)
+{
+	unsigned int history_size;
+	int converted_slots;
+	int rc;
+
+	if (!dev->initialized) {
+		log_bug(dev, "device not initialized. call libevdev_set_fd() first\n");
+		return -EBADF;
+	} else if (fd < 0)
+		return -EBADF;
+
+	update_fingerprint(dev);
+	if (same_capabilities(dev, fd)) {
+		dev->fd = fd;
+		dev->grabbed = LIBEVDEV_UNGRAB;
+		/* anything still queued came from the old fd */
+		dev->queue_next = 0;
+		dev->queue_nsync = 0;
+		if (dev->mt_converter)
+			_libevdev_mt_converter_discard_frame(dev->mt_converter);
+		dev->sync_state = SYNC_NEEDED;
+		return LIBEVDEV_REATTACH_SAME_DEVICE;
+	}
+
+	log_info(dev, "device capabilities changed, re-initializing\n");
+
+	/* libevdev_set_fd() resets these, re-enable them below */
+	history_size = dev->touch_history.size;
+	converted_slots = dev->mt_converter ? dev->num_slots : 0;
+
+	queue_free(dev);
+	dev->initialized = false;
+	rc = libevdev_set_fd(dev, fd);
+	if (rc < 0)
+		return rc;
+
+	/* skip what the new device does not support, anything else that
+	   fails here is an error */
+	if (converted_slots > 0 &&
+	    !libevdev_has_event_code(dev, EV_ABS, ABS_MT_SLOT) &&
+	    libevdev_has_event_code(dev, EV_ABS, ABS_MT_POSITION_X) &&
+	    libevdev_has_event_code(dev, EV_ABS, ABS_MT_POSITION_Y)) {
+		rc = libevdev_enable_mt_protocol_a_conversion(dev, converted_slots);
+		if (rc < 0)
+			return rc;
+	}
+	if (history_size > 0 && dev->num_slots > 0 &&
+	    libevdev_has_event_code(dev, EV_ABS, ABS_MT_TRACKING_ID)) {
+		rc = libevdev_enable_touch_history(dev, history_size);
+		if (rc < 0)
+			return rc;
+	}
+
+	return LIBEVDEV_REATTACH_NEW_DEVICE;
+}
+
 LIBEVDEV_EXPORT int
 libevdev_get_fd(const struct libevdev* dev)
 {
@@ -627,18 +1251,18 @@ sync_abs_state(struct libevdev *dev)
 		if (i >= ABS_MT_MIN && i <= ABS_MT_MAX)
 			continue;
 
-		if (!bit_is_set(dev->abs_bits, i))
+		if (!bit_is_set(dev->caps->abs_bits, i))
 			continue;
 
 		rc = ioctl(dev->fd, EVIOCGABS(i), &abs_info);
 		if (rc < 0)
 			goto out;
 
-		if (dev->abs_info[i].value != abs_info.value) {
+		if (abs_info_ptr(dev, i)->value != abs_info.value) {
 			struct input_event *ev = queue_push(dev);
 
 			init_event(dev, ev, EV_ABS, i, abs_info.value);
-			dev->abs_info[i].value = abs_info.value;
+			abs_info_ptr(dev, i)->value = abs_info.value;
 		}
 	}
 
@@ -665,8 +1289,6 @@ sync_mt_state(struct libevdev *dev, int create_events)
 	memset(dev->mt_sync.tracking_id_changes, 0,
 	       dev->mt_sync.tracking_id_changes_sz);
 
-#define AXISBIT(_slot, _axis) (_slot * ABS_MT_CNT + _axis - ABS_MT_MIN)
-
 	for (axis = ABS_MT_MIN; axis <= ABS_MT_MAX; axis++) {
 		if (axis == ABS_MT_SLOT)
 			continue;
@@ -699,7 +1321,7 @@ sync_mt_state(struct libevdev *dev, int create_events)
 					need_tracking_id_changes = 1;
 				}
 
-				*slot_value(dev, slot, axis) = mt_state->val[slot];
+				set_slot_value(dev, slot, axis, mt_state->val[slot]);
 
 				set_bit(slot_update, AXISBIT(slot, axis));
 				/* note that this slot has updates */
@@ -709,6 +1331,14 @@ sync_mt_state(struct libevdev *dev, int create_events)
 		}
 	}
 
+	/* the initial values are zero, not -1, rebuild the active slots
+	   from scratch rather than relying on the changes above */
+	if (libevdev_has_event_code(dev, EV_ABS, ABS_MT_TRACKING_ID)) {
+		for (slot = 0; slot < dev->num_slots; slot++)
+			set_bit_state(dev->mt_active_slots, slot,
+				      *slot_value(dev, slot, ABS_MT_TRACKING_ID) != -1);
+	}
+
 	if (!create_events) {
 		rc = 0;
 		goto out;
@@ -765,8 +1395,6 @@ sync_mt_state(struct libevdev *dev, int create_events)
 		init_event(dev, ev, EV_ABS, ABS_MT_SLOT, dev->current_slot);
 	}
 
-#undef AXISBIT
-
 	rc = 0;
 out:
 	return rc ? -errno : 0;
@@ -850,7 +1478,9 @@ sync_state(struct libevdev *dev)
 		rc = sync_sw_state(dev);
 	if (rc == 0 && libevdev_has_event_type(dev, EV_ABS))
 		rc = sync_abs_state(dev);
-	if (rc == 0 && dev->num_slots > -1 &&
+	/* a converted protocol A device has no slots in the kernel, the
+	   next complete frame updates all touches */
+	if (rc == 0 && dev->num_slots > -1 && !dev->mt_converter &&
 	    libevdev_has_event_code(dev, EV_ABS, ABS_MT_SLOT))
 		rc = sync_mt_state(dev, 1);
 
@@ -883,26 +1513,82 @@ static int
 update_mt_state(struct libevdev *dev, const struct input_event *e)
 {
 	if (e->code == ABS_MT_SLOT && dev->num_slots > -1) {
-		int i;
 		dev->current_slot = e->value;
-		/* sync abs_info with the current slot values */
-		for (i = ABS_MT_SLOT + 1; i <= ABS_MT_MAX; i++) {
-			if (libevdev_has_event_code(dev, EV_ABS, i))
-				dev->abs_info[i].value = *slot_value(dev, dev->current_slot, i);
-		}
-
 		return 0;
 	} else if (dev->current_slot == -1)
 		return 1;
 
-	*slot_value(dev, dev->current_slot, e->code) = e->value;
+	set_slot_value(dev, dev->current_slot, e->code, e->value);
+	set_bit(dev->mt_changes, AXISBIT(dev->current_slot, e->code));
+	set_bit(dev->mt_changes, AXISBIT(dev->current_slot, ABS_MT_SLOT));
 
 	return 0;
 }
 
+static inline int
+slot_value_or_zero(const struct libevdev *dev, int slot, unsigned int code)
+{
+	return bit_is_set(dev->caps->abs_bits, code) ? *slot_value(dev, slot, code) : 0;
+}
+
+/**
+ * Append the active touches to the touch history, overwriting the oldest
+ * frame once the ring is full.
+ */
+static void
+record_touch_frame(struct libevdev *dev, const struct input_event *e)
+{
+	struct libevdev_touch_frame *frame;
+	struct libevdev_touch *touch;
+	int slot;
+
+	frame = &dev->touch_history.frames[dev->touch_history.next];
+	touch = &dev->touch_history.touches[dev->touch_history.next * dev->num_slots];
+
+	frame->time.tv_sec = e->input_event_sec;
+	frame->time.tv_usec = e->input_event_usec;
+	frame->touches = touch;
+	frame->ntouches = 0;
+
+	for (slot = libevdev_next_active_slot(dev, -1);
+	     slot != -1;
+	     slot = libevdev_next_active_slot(dev, slot)) {
+		touch->slot = slot;
+		touch->tracking_id = *slot_value(dev, slot, ABS_MT_TRACKING_ID);
+		touch->x = slot_value_or_zero(dev, slot, ABS_MT_POSITION_X);
+		touch->y = slot_value_or_zero(dev, slot, ABS_MT_POSITION_Y);
+		touch->pressure = slot_value_or_zero(dev, slot, ABS_MT_PRESSURE);
+		touch++;
+		frame->ntouches++;
+	}
+
+	dev->touch_history.next = (dev->touch_history.next + 1) % dev->touch_history.size;
+	if (dev->touch_history.count < dev->touch_history.size)
+		dev->touch_history.count++;
+}
+
+/**
+ * Publish the MT changes of the frame that ends with this SYN_REPORT and
+ * start a new frame.
+ */
+static void
+end_mt_frame(struct libevdev *dev, const struct input_event *e)
+{
+	unsigned long *changes = dev->mt_last_changes;
+
+	dev->mt_last_changes = dev->mt_changes;
+	dev->mt_changes = changes;
+	memset(changes, 0, dev->mt_sync.slot_update_sz);
+
+	if (dev->touch_history.size > 0)
+		record_touch_frame(dev, e);
+}
+
 static int
 update_abs_state(struct libevdev *dev, const struct input_event *e)
 {
+	struct input_absinfo *abs;
+
 	if (!libevdev_has_event_type(dev, EV_ABS))
 		return 1;
 
@@ -912,7 +1598,9 @@ update_abs_state(struct libevdev *dev, const struct input_event *e)
 	if (e->code >= ABS_MT_MIN && e->code <= ABS_MT_MAX)
 		update_mt_state(dev, e);
 
-	dev->abs_info[e->code].value = e->value;
+	abs = abs_info_ptr(dev, e->code);
+	if (abs)
+		abs->value = e->value;
 
 	return 0;
 }
@@ -952,6 +1640,9 @@ update_state(struct libevdev *dev, const struct input_event *e)
 
 	switch(e->type) {
 		case EV_SYN:
+			if (e->code == SYN_REPORT && dev->num_slots > -1)
+				end_mt_frame(dev, e);
+			break;
 		case EV_REL:
 			break;
 		case EV_KEY:
@@ -1068,6 +1759,14 @@ libevdev_next_event(struct libevdev *dev, unsigned int flags, struct input_event
 	   read in any more.
 	 */
 	do {
+		if (dev->mt_converter && !(flags & LIBEVDEV_READ_FLAG_SYNC) &&
+		    _libevdev_mt_converter_pop(dev->mt_converter, ev)) {
+			filter_status = sanitize_event(dev, ev, dev->sync_state);
+			if (filter_status != EVENT_FILTER_DISCARD)
+				update_state(dev, ev);
+			continue;
+		}
+
 		if (!(flags & LIBEVDEV_READ_FLAG_BLOCKING) ||
 		    queue_num_elements(dev) == 0) {
 			rc = read_more_events(dev);
@@ -1084,6 +1783,14 @@ libevdev_next_event(struct libevdev *dev, unsigned int flags, struct input_event
 		if (queue_shift(dev, ev) != 0)
 			return -EAGAIN;
 
+		/* protocol A events come back out of the converter as
+		   protocol B events once their frame is complete */
+		if (dev->mt_converter && !(flags & LIBEVDEV_READ_FLAG_SYNC) &&
+		    _libevdev_mt_converter_push(dev->mt_converter, ev)) {
+			filter_status = EVENT_FILTER_DISCARD;
+			continue;
+		}
+
 		filter_status = sanitize_event(dev, ev, dev->sync_state);
 		if (filter_status != EVENT_FILTER_DISCARD)
 			update_state(dev, ev);
@@ -1131,6 +1838,9 @@ libevdev_has_event_pending(struct libevdev *dev)
 	if (queue_num_elements(dev) != 0)
 		return 1;
 
+	if (dev->mt_converter && _libevdev_mt_converter_has_events(dev->mt_converter))
+		return 1;
+
 	rc = poll(&fds, 1, 0);
 	return (rc >= 0) ? rc : -errno;
 }
@@ -1158,7 +1868,7 @@ LIBEVDEV_EXPORT void libevdev_set_##field(struct libevdev *dev, const char *fiel
 { \
 	if (field == NULL) \
 		return; \
-	free(dev->field); \
+	arena_free(dev, dev->field); \
 	dev->field = strdup(field); \
 }
 
@@ -1197,7 +1907,7 @@ libevdev_get_driver_version(const struct libevdev *dev)
 LIBEVDEV_EXPORT int
 libevdev_has_property(const struct libevdev *dev, unsigned int prop)
 {
-	return (prop <= INPUT_PROP_MAX) && bit_is_set(dev->props, prop);
+	return (prop <= INPUT_PROP_MAX) && bit_is_set(dev->caps->props, prop);
 }
 
 LIBEVDEV_EXPORT int
@@ -1206,14 +1916,21 @@ libevdev_enable_property(struct libevdev *dev, unsigned int prop)
 	if (prop > INPUT_PROP_MAX)
 		return -1;
 
-	set_bit(dev->props, prop);
+	if (libevdev_has_property(dev, prop))
+		return 0;
+
+	if (caps_make_private(dev) != 0)
+		return -1;
+
+	set_bit(dev->caps->props, prop);
+	dev->fingerprint_dirty = true;
 	return 0;
 }
 
 LIBEVDEV_EXPORT int
 libevdev_has_event_type(const struct libevdev *dev, unsigned int type)
 {
-	return type == EV_SYN ||(type <= EV_MAX && bit_is_set(dev->bits, type));
+	return type == EV_SYN ||(type <= EV_MAX && bit_is_set(dev->caps->bits, type));
 }
 
 LIBEVDEV_EXPORT int
@@ -1236,6 +1953,32 @@ libevdev_has_event_code(const struct libevdev *dev, unsigned int type, unsigned
 	return bit_is_set(mask, code);
 }
 
+LIBEVDEV_EXPORT int
+libevdev_share_capabilities(struct libevdev *dev, const struct libevdev *other)
+{
+	const size_t offset = offsetof(struct capabilities, bits);
+
+	if (dev->caps == other->caps)
+		return 0;
+
+	/* compare everything but the refcount */
+	if (memcmp((const char*)dev->caps + offset,
+		   (const char*)other->caps + offset,
+		   sizeof(struct capabilities) - offset) != 0)
+		return -EINVAL;
+
+	caps_unref(dev->caps);
+	dev->caps = caps_ref(other->caps);
+
+	return 0;
+}
+
+LIBEVDEV_EXPORT void
+libevdev_get_fingerprint(const struct libevdev *dev, uint64_t fingerprint[2])
+{
+	get_fingerprint(dev, fingerprint);
+}
+
 LIBEVDEV_EXPORT int
 libevdev_get_event_value(const struct libevdev *dev, unsigned int type, unsigned int code)
 {
@@ -1245,7 +1988,7 @@ libevdev_get_event_value(const struct libevdev *dev, unsigned int type, unsigned
 		return 0;
 
 	switch (type) {
-		case EV_ABS: value = dev->abs_info[code].value; break;
+		case EV_ABS: value = current_abs_value(dev, code); break;
 		case EV_KEY: value = bit_is_set(dev->key_values, code); break;
 		case EV_LED: value = bit_is_set(dev->led_values, code); break;
 		case EV_SW: value = bit_is_set(dev->sw_values, code); break;
@@ -1343,7 +2086,7 @@ libevdev_set_slot_value(struct libevdev *dev, unsigned int slot, unsigned int co
 		dev->current_slot = value;
 	}
 
-	*slot_value(dev, slot, code) = value;
+	set_slot_value(dev, slot, code, value);
 
 	return 0;
 }
@@ -1361,6 +2104,224 @@ libevdev_fetch_slot_value(const struct libevdev *dev, unsigned int slot, unsigne
 		return 0;
 }
 
+LIBEVDEV_EXPORT const int *
+libevdev_get_slot_values_ptr(const struct libevdev *dev, unsigned int code)
+{
+	if (!libevdev_has_event_code(dev, EV_ABS, code) ||
+	    code < ABS_MT_MIN || code > ABS_MT_MAX ||
+	    dev->num_slots <= 0)
+		return NULL;
+
+	return slot_value(dev, 0, code);
+}
+
+LIBEVDEV_EXPORT int
+libevdev_get_slot_values(const struct libevdev *dev, unsigned int code,
+			 int *values, size_t nvalues)
+{
+	const int *ptr;
+	size_t n;
+
+	if (!libevdev_has_event_code(dev, EV_ABS, code) ||
+	    code < ABS_MT_MIN || code > ABS_MT_MAX ||
+	    dev->num_slots < 0)
+		return -EINVAL;
+
+	ptr = libevdev_get_slot_values_ptr(dev, code);
+	n = min(nvalues, (size_t)dev->num_slots);
+	if (n > 0)
+		memcpy(values, ptr, n * sizeof(*values));
+
+	return n;
+}
+
+LIBEVDEV_EXPORT int
+libevdev_next_active_slot(const struct libevdev *dev, int slot)
+{
+	unsigned long bits;
+	size_t w;
+
+	if (dev->num_slots <= 0 || slot >= dev->num_slots - 1)
+		return -1;
+
+	slot = max(slot + 1, 0);
+	w = slot / LONG_BITS;
+	bits = dev->mt_active_slots[w] & (~0UL << (slot % LONG_BITS));
+
+	while (bits == 0) {
+		if (++w >= NLONGS(dev->num_slots))
+			return -1;
+		bits = dev->mt_active_slots[w];
+	}
+
+	return w * LONG_BITS + __builtin_ctzl(bits);
+}
+
+LIBEVDEV_EXPORT int
+libevdev_get_num_active_slots(const struct libevdev *dev)
+{
+	size_t w;
+	int n = 0;
+
+	if (dev->num_slots <= 0)
+		return 0;
+
+	for (w = 0; w < NLONGS(dev->num_slots); w++)
+		n += __builtin_popcountl(dev->mt_active_slots[w]);
+
+	return n;
+}
+
+LIBEVDEV_EXPORT int
+libevdev_slot_value_changed(const struct libevdev *dev, unsigned int slot, unsigned int code)
+{
+	if (dev->num_slots < 0 || slot >= (unsigned int)dev->num_slots)
+		return 0;
+
+	if (code > ABS_MT_MAX || code < ABS_MT_MIN)
+		return 0;
+
+	return bit_is_set(dev->mt_last_changes, AXISBIT(slot, code));
+}
+
+LIBEVDEV_EXPORT int
+libevdev_next_changed_slot(const struct libevdev *dev, int slot)
+{
+	if (dev->num_slots <= 0)
+		return -1;
+
+	for (slot = max(slot + 1, 0); slot < dev->num_slots; slot++) {
+		if (bit_is_set(dev->mt_last_changes, AXISBIT(slot, ABS_MT_SLOT)))
+			return slot;
+	}
+
+	return -1;
+}
+
+LIBEVDEV_EXPORT int
+libevdev_enable_touch_history(struct libevdev *dev, unsigned int nframes)
+{
+	struct libevdev_touch_frame *frames = NULL;
+	struct libevdev_touch *touches = NULL;
+
+	if (nframes > 0) {
+		if (dev->num_slots <= 0 ||
+		    !libevdev_has_event_code(dev, EV_ABS, ABS_MT_TRACKING_ID))
+			return -EINVAL;
+
+		frames = calloc(nframes, sizeof(*frames));
+		touches = calloc((size_t)nframes * dev->num_slots, sizeof(*touches));
+		if (!frames || !touches) {
+			free(frames);
+			free(touches);
+			return -ENOMEM;
+		}
+	}
+
+	free(dev->touch_history.frames);
+	free(dev->touch_history.touches);
+	dev->touch_history.frames = frames;
+	dev->touch_history.touches = touches;
+	dev->touch_history.size = nframes;
+	dev->touch_history.count = 0;
+	dev->touch_history.next = 0;
+
+	return 0;
+}
+
+LIBEVDEV_EXPORT int
+libevdev_get_num_touch_frames(const struct libevdev *dev)
+{
+	return dev->touch_history.count;
+}
+
+LIBEVDEV_EXPORT const struct libevdev_touch_frame *
+libevdev_get_touch_frame(const struct libevdev *dev, unsigned int age)
+{
+	unsigned int idx;
+
+	if (age >= dev->touch_history.count)
+		return NULL;
+
+	idx = (dev->touch_history.next + dev->touch_history.size - 1 - age) %
+		dev->touch_history.size;
+
+	return &dev->touch_history.frames[idx];
+}
+
+LIBEVDEV_EXPORT int
+libevdev_enable_mt_protocol_a_conversion(struct libevdev *dev, unsigned int nslots)
+{
+	struct input_absinfo abs = {0};
+	size_t slot_update_sz = NLONGS(nslots * ABS_MT_CNT) * sizeof(long);
+	int *slot_vals;
+	unsigned long *active, *changes, *last_changes;
+	struct mt_converter *conv = NULL;
+	int max_tracking_id = 0xffff;
+	long long dx, dy;
+	int rc, slot;
+
+	if (nslots == 0 || nslots > MAX_CONVERTED_SLOTS ||
+	    dev->num_slots != -1 || dev->mt_converter ||
+	    libevdev_has_event_code(dev, EV_ABS, ABS_MT_SLOT) ||
+	    !libevdev_has_event_code(dev, EV_ABS, ABS_MT_POSITION_X) ||
+	    !libevdev_has_event_code(dev, EV_ABS, ABS_MT_POSITION_Y))
+		return -EINVAL;
+
+	if (libevdev_has_event_code(dev, EV_ABS, ABS_MT_TRACKING_ID))
+		max_tracking_id = libevdev_get_abs_maximum(dev, ABS_MT_TRACKING_ID);
+
+	slot_vals = calloc(nslots * ABS_MT_CNT, sizeof(*slot_vals));
+	active = calloc(NLONGS(nslots), sizeof(long));
+	changes = calloc(1, slot_update_sz);
+	last_changes = calloc(1, slot_update_sz);
+	/* a contact that jumps more than an eighth of the axis range is a
+	   new touch */
+	dx = ((long long)libevdev_get_abs_maximum(dev, ABS_MT_POSITION_X) -
+	      libevdev_get_abs_minimum(dev, ABS_MT_POSITION_X)) / 8;
+	dy = ((long long)libevdev_get_abs_maximum(dev, ABS_MT_POSITION_Y) -
+	      libevdev_get_abs_minimum(dev, ABS_MT_POSITION_Y)) / 8;
+
+	rc = _libevdev_mt_converter_new(nslots, max_tracking_id,
+					max(dx * dx + dy * dy, 1LL), &conv);
+	if (rc == 0 && (!slot_vals || !active || !changes || !last_changes))
+		rc = -ENOMEM;
+
+	if (rc == 0 && !libevdev_has_event_code(dev, EV_ABS, ABS_MT_TRACKING_ID)) {
+		abs.maximum = max_tracking_id;
+		if (libevdev_enable_event_code(dev, EV_ABS, ABS_MT_TRACKING_ID, &abs) != 0)
+			rc = -ENOMEM;
+	}
+	if (rc == 0) {
+		abs.maximum = nslots - 1;
+		if (libevdev_enable_event_code(dev, EV_ABS, ABS_MT_SLOT, &abs) != 0)
+			rc = -ENOMEM;
+	}
+
+	if (rc != 0) {
+		free(slot_vals);
+		free(active);
+		free(changes);
+		free(last_changes);
+		_libevdev_mt_converter_free(conv);
+		return rc;
+	}
+
+	dev->mt_slot_vals = slot_vals;
+	dev->mt_active_slots = active;
+	dev->mt_changes = changes;
+	dev->mt_last_changes = last_changes;
+	dev->mt_sync.slot_update_sz = slot_update_sz;
+	dev->mt_converter = conv;
+	dev->num_slots = nslots;
+	dev->current_slot = 0;
+
+	for (slot = 0; slot < dev->num_slots; slot++)
+		set_slot_value(dev, slot, ABS_MT_TRACKING_ID, -1);
+
+	return 0;
+}
+
 LIBEVDEV_EXPORT int
 libevdev_get_num_slots(const struct libevdev *dev)
 {
@@ -1376,11 +2337,16 @@ libevdev_get_current_slot(const struct libevdev *dev)
 LIBEVDEV_EXPORT const struct input_absinfo*
 libevdev_get_abs_info(const struct libevdev *dev, unsigned int code)
 {
+	struct input_absinfo *abs;
+
 	if (!libevdev_has_event_type(dev, EV_ABS) ||
 	    !libevdev_has_event_code(dev, EV_ABS, code))
 		return NULL;
 
-	return &dev->abs_info[code];
+	abs = abs_info_ptr(dev, code);
+	abs->value = current_abs_value(dev, code);
+
+	return abs;
 }
 
 #define ABS_GETTER(name) \
@@ -1401,7 +2367,8 @@ LIBEVDEV_EXPORT void libevdev_set_abs_##field(struct libevdev *dev, unsigned int
 { \
 	if (!libevdev_has_event_code(dev, EV_ABS, code)) \
 		return; \
-	dev->abs_info[code].field = val; \
+	abs_info_ptr(dev, code)->field = val; \
+	dev->fingerprint_dirty = true; \
 }
 
 ABS_SETTER(maximum)
@@ -1416,7 +2383,10 @@ libevdev_set_abs_info(struct libevdev *dev, unsigned int code, const struct inpu
 	if (!libevdev_has_event_code(dev, EV_ABS, code))
 		return;
 
-	dev->abs_info[code] = *abs;
+	*abs_info_ptr(dev, code) = *abs;
+	if (is_slotted_code(dev, code))
+		set_slot_value(dev, dev->current_slot, code, abs->value);
+	dev->fingerprint_dirty = true;
 }
 
 LIBEVDEV_EXPORT int
@@ -1434,13 +2404,17 @@ libevdev_enable_event_type(struct libevdev *dev, unsigned int type)
 	if (max == -1)
 		return -1;
 
-	set_bit(dev->bits, type);
+	if (caps_make_private(dev) != 0)
+		return -1;
+
+	set_bit(dev->caps->bits, type);
 
 	if (type == EV_REP) {
 		int delay = 0, period = 0;
 		libevdev_enable_event_code(dev, EV_REP, REP_DELAY, &delay);
 		libevdev_enable_event_code(dev, EV_REP, REP_PERIOD, &period);
 	}
+	dev->fingerprint_dirty = true;
 	return 0;
 }
 
@@ -1456,7 +2430,14 @@ libevdev_disable_event_type(struct libevdev *dev, unsigned int type)
 	if (max == -1)
 		return -1;
 
-	clear_bit(dev->bits, type);
+	if (!libevdev_has_event_type(dev, type))
+		return 0;
+
+	if (caps_make_private(dev) != 0)
+		return -1;
+
+	clear_bit(dev->caps->bits, type);
+	dev->fingerprint_dirty = true;
 
 	return 0;
 }
@@ -1467,6 +2448,7 @@ libevdev_enable_event_code(struct libevdev *dev, unsigned int type,
 {
 	unsigned int max;
 	unsigned long *mask = NULL;
+	const unsigned long *cmask = NULL;
 
 	if (libevdev_enable_event_type(dev, type))
 		return -1;
@@ -1485,21 +2467,32 @@ libevdev_enable_event_code(struct libevdev *dev, unsigned int type,
 			break;
 	}
 
-	max = type_to_mask(dev, type, &mask);
+	max = type_to_mask_const(dev, type, &cmask);
 
 	if (code > max || (int)max == -1)
 		return -1;
 
-	set_bit(mask, code);
+	if (!bit_is_set(cmask, code)) {
+		if (caps_make_private(dev) != 0)
+			return -1;
+
+		if (type == EV_ABS && abs_info_alloc(dev) != 0)
+			return -1;
+
+		type_to_mask(dev, type, &mask);
+		set_bit(mask, code);
+	}
 
 	if (type == EV_ABS) {
 		const struct input_absinfo *abs = data;
-		dev->abs_info[code] = *abs;
+		*abs_info_ptr(dev, code) = *abs;
 	} else if (type == EV_REP) {
 		const int *value = data;
 		dev->rep_values[code] = *value;
 	}
 
+	dev->fingerprint_dirty = true;
+
 	return 0;
 }
 
@@ -1508,16 +2501,25 @@ libevdev_disable_event_code(struct libevdev *dev, unsigned int type, unsigned in
 {
 	unsigned int max;
 	unsigned long *mask = NULL;
+	const unsigned long *cmask = NULL;
 
 	if (type > EV_MAX || type == EV_SYN)
 		return -1;
 
-	max = type_to_mask(dev, type, &mask);
+	max = type_to_mask_const(dev, type, &cmask);
 
 	if (code > max || (int)max == -1)
 		return -1;
 
+	if (!bit_is_set(cmask, code))
+		return 0;
+
+	if (caps_make_private(dev) != 0)
+		return -1;
+
+	type_to_mask(dev, type, &mask);
 	clear_bit(mask, code);
+	dev->fingerprint_dirty = true;
 
 	return 0;
 }
@@ -29,6 +29,7 @@ extern "C" {
 
 #include <linux/input.h>
 #include <stdarg.h>
+#include <stdint.h>
 
 #define LIBEVDEV_ATTRIBUTE_PRINTF(_format, _args) __attribute__ ((format (printf, _format, _args)))
 
@@ -795,6 +796,83 @@ struct libevdev* libevdev_new(void);
  */
 int libevdev_new_from_fd(int fd, struct libevdev **dev);
 
+/**
+ * @ingroup init
+ *
+ * The formats supported by libevdev_serialize_description().
+ */
+enum libevdev_description_format {
+	/**
+	 * A compact binary format, independent of the host's endianness
+	 * and word size.
+	 */
+	LIBEVDEV_DESCRIPTION_BINARY = 1,
+	/**
+	 * A line-based, human-readable text format. Event types, codes
+	 * and properties are written by name.
+	 */
+	LIBEVDEV_DESCRIPTION_TEXT
+};
+
+/**
+ * @ingroup init
+ *
+ * Initialize a new libevdev device from a description previously created
+ * with libevdev_serialize_description(). The format of the description is
+ * detected automatically.
+ *
+ * The device has the name, phys, uniq, ids, driver version, properties,
+ * event codes, absinfo, repeat values and number of slots of the
+ * serialized device. It is not associated with a kernel device, no ioctls
+ * are issued and libevdev_set_fd() may not be called on it. Such a device
+ * can be passed to libevdev_uinput_create_from_device() or used to query
+ * and compare capabilities. All slots start without a touch, i.e. with a
+ * tracking ID of -1.
+ *
+ * @param data The serialized description
+ * @param len The length of data in bytes
+ * @param[out] dev The newly initialized evdev device.
+ *
+ * @return On success, 0 is returned and dev is set to the newly
+ * allocated struct. On failure, a negative errno is returned and the value
+ * of dev is undefined. -EINVAL is returned if the description is malformed
+ * or of an unsupported version.
+ *
+ * @see libevdev_serialize_description
+ * @see libevdev_free
+ */
+int libevdev_new_from_description(const void *data, size_t len, struct libevdev **dev);
+
+/**
+ * @ingroup init
+ *
+ * Serialize the identity and capabilities of the device into buf: the
+ * name, phys, uniq, ids, driver version, properties, all enabled event
+ * types and codes, the absinfo of each axis and the repeat values. Event
+ * state such as key values is not serialized.
+ *
+ * This function behaves like snprintf(): at most len bytes are written
+ * and the return value is the size of the full description. A return value
+ * larger than len means the output was truncated, call again with a
+ * larger buffer. buf may be NULL if len is 0. In the text format, the
+ * description is followed by a null byte if there is space for it, this
+ * byte is not included in the return value.
+ *
+ * @param dev The evdev device
+ * @param format The format to serialize into
+ * @param buf The buffer to write into
+ * @param len The size of buf in bytes
+ *
+ * @return The size of the description in bytes, or a negative errno on
+ * failure. -EINVAL is returned for an invalid format or if the name,
+ * phys or uniq contain a newline in the text format.
+ *
+ * @see libevdev_new_from_description
+ */
+int libevdev_serialize_description(const struct libevdev *dev,
+				   enum libevdev_description_format format,
+				   void *buf, size_t len);
+
 /**
  * @ingroup init
  *
@@ -1048,6 +1126,76 @@ int libevdev_set_fd(struct libevdev* dev, int fd);
  */
 int libevdev_change_fd(struct libevdev* dev, int fd);
 
+/**
+ * @ingroup init
+ *
+ * Return values of libevdev_reattach_fd().
+ */
+enum libevdev_reattach_status {
+	/**
+	 * The new fd is the same device, a state sync is pending.
+	 */
+	LIBEVDEV_REATTACH_SAME_DEVICE = 0,
+	/**
+	 * The device behind the new fd has different capabilities, the
+	 * device was re-initialized as if with libevdev_set_fd().
+	 */
+	LIBEVDEV_REATTACH_NEW_DEVICE = 1
+};
+
+/**
+ * @ingroup init
+ *
+ * Re-attach the device to a newly opened fd, e.g. after the device node
+ * was re-opened on resume or a session switch. This is a middle ground
+ * between libevdev_change_fd(), which assumes nothing has changed, and a
+ * new libevdev_set_fd(), which re-reads everything.
+ *
+ * The ids, properties, event codes and axis ranges, including the number
+ * of slots, of the device behind fd are compared to the current device.
+ * The name, phys and uniq are not compared. If these match, only the fd
+ * is changed and the device is put into the same state as after a
+ * SYN_DROPPED: the caller must fetch the state changes with
+ * @ref LIBEVDEV_READ_FLAG_SYNC, see libevdev_next_event(). Events still
+ * in libevdev's queue from the old fd are discarded.
+ *
+ * @code
+ *     struct input_event ev;
+ *     rc = libevdev_reattach_fd(dev, new_fd);
+ *     if (rc == LIBEVDEV_REATTACH_SAME_DEVICE) {
+ *         while (libevdev_next_event(dev, LIBEVDEV_READ_FLAG_SYNC, &ev) == LIBEVDEV_READ_STATUS_SYNC)
+ *             process_event(&ev);
+ *     } else if (rc == LIBEVDEV_REATTACH_NEW_DEVICE) {
+ *         reconfigure_device(dev);
+ *     }
+ * @endcode
+ *
+ * If the capabilities differ, including modifications made with
+ * libevdev_enable_event_code() and friends, the device is re-initialized
+ * from fd as if with libevdev_set_fd(). If the re-initialization fails,
+ * the device is left uninitialized. The touch history, see
+ * libevdev_enable_touch_history(), and the protocol A conversion, see
+ * libevdev_enable_mt_protocol_a_conversion(), are re-enabled with the
+ * same settings if the new device supports them; the recorded touch
+ * frames are discarded. If re-enabling either fails, a negative errno is
+ * returned and the device stays initialized without it.
+ *
+ * In both cases, the device is assumed ungrabbed afterwards and the clock
+ * id is that of the new fd.
+ *
+ * It is an error to call this function before calling libevdev_set_fd().
+ *
+ * @param dev The evdev device, already initialized with libevdev_set_fd()
+ * @param fd The new fd
+ *
+ * @return One of @ref libevdev_reattach_status on success, or a negative
+ * errno on failure.
+ *
+ * @see libevdev_change_fd
+ * @see libevdev_set_fd
+ */
+int libevdev_reattach_fd(struct libevdev *dev, int fd);
+
 /**
  * @ingroup init
  *
@@ -1398,6 +1546,57 @@ int libevdev_has_event_type(const struct libevdev *dev, unsigned int type);
  */
 int libevdev_has_event_code(const struct libevdev *dev, unsigned int type, unsigned int code);
 
+/**
+ * @ingroup bits
+ *
+ * Share the capability data of another device with this device. If both
+ * devices have identical event types, event codes and properties, the
+ * device drops its own copy of the capability bits and references the
+ * other device's copy instead. This reduces the memory footprint where a
+ * large number of identical devices is used.
+ *
+ * Sharing is transparent to the caller. Enabling or disabling an event
+ * type, code or property on either device later gives that device a
+ * private copy again, the other device is not affected.
+ *
+ * The abs_info of a device is not shared, it carries the device's current
+ * axis values.
+ *
+ * @param dev The evdev device
+ * @param other The device to share the capabilities with
+ *
+ * @return 0 if the two devices now share their capabilities, or -EINVAL
+ * if the capabilities differ. In the latter case, the device remains
+ * unmodified.
+ */
+int libevdev_share_capabilities(struct libevdev *dev, const struct libevdev *other);
+
+/**
+ * @ingroup bits
+ *
+ * Get a 128-bit fingerprint of the device's capabilities: the enabled
+ * event types and codes, the properties and the minimum, maximum, fuzz,
+ * flat and resolution of each axis. The name, ids, axis values and other
+ * state do not contribute to the fingerprint.
+ *
+ * Two devices with equal fingerprints have the same capabilities with a
+ * very high probability, making this suitable to compare devices or to
+ * key a cache of per-device configuration. The fingerprint is stable
+ * across processes, hosts and versions of libevdev. Either half on its
+ * own may be used as a 64-bit fingerprint.
+ *
+ * The fingerprint is computed when the device is initialized. After the
+ * capabilities or axis ranges were changed, it is recomputed by this
+ * function on every call until the device is initialized or reattached
+ * again.
+ *
+ * @param dev The evdev device
+ * @param[out] fingerprint Set to the fingerprint of the device
+ *
+ * @note This function is signal-safe.
+ */
+void libevdev_get_fingerprint(const struct libevdev *dev, uint64_t fingerprint[2]);
+
 /**
  * @ingroup bits
  *
@@ -1473,6 +1672,11 @@ int libevdev_get_abs_resolution(const struct libevdev *dev, unsigned int code);
  *
  * Get the axis info for the given axis, as advertised by the kernel.
  *
+ * For the multitouch axes on a device with slots, the value is that of
+ * the current slot when this function is called. It is not updated when
+ * the current slot changes, call this function again or use
+ * libevdev_get_event_value() instead.
+ *
  * @param dev The evdev device, already initialized with libevdev_set_fd()
  * @param code The EV_ABS event code to query for, one of ABS_X, ABS_Y, etc.
  *
@@ -1644,6 +1848,56 @@ int libevdev_set_slot_value(struct libevdev *dev, unsigned int slot, unsigned in
  */
 int libevdev_fetch_slot_value(const struct libevdev *dev, unsigned int slot, unsigned int code, int *value);
 
+/**
+ * @ingroup mt
+ *
+ * Copy the current value of the code for all slots into values, in slot
+ * order. At most nvalues values are copied, call libevdev_get_num_slots()
+ * to size the array.
+ *
+ * This is the equivalent of calling libevdev_get_slot_value() for each
+ * slot, without the per-call checks.
+ *
+ * @param dev The evdev device, already initialized with libevdev_set_fd()
+ * @param code The event code to query for, one of ABS_MT_POSITION_X, etc.
+ * @param[out] values Set to the values of each slot
+ * @param nvalues The number of elements in values
+ *
+ * @return The number of values copied, or -EINVAL if the device does not
+ * have slots, does not support the code or the code is not an ABS_MT_*
+ * event code
+ *
+ * @note This function is signal-safe.
+ * @see libevdev_get_slot_values_ptr
+ */
+int libevdev_get_slot_values(const struct libevdev *dev, unsigned int code,
+			     int *values, size_t nvalues);
+
+/**
+ * @ingroup mt
+ *
+ * Return a pointer to the current value of the code for all slots. The
+ * array has libevdev_get_num_slots() elements in slot order. The values
+ * of one code are contiguous in memory, so a loop over all slots reads
+ * sequential memory.
+ *
+ * The array is updated in place by libevdev_next_event() and the other
+ * functions that change slot values. The pointer is valid until the
+ * device is freed or re-initialized.
+ *
+ * @param dev The evdev device, already initialized with libevdev_set_fd()
+ * @param code The event code to query for, one of ABS_MT_POSITION_X, etc.
+ *
+ * @return A pointer to the value of each slot, or NULL if the device does
+ * not have slots, does not support the code or the code is not an ABS_MT_*
+ * event code
+ *
+ * @note This function is signal-safe.
+ * @see libevdev_get_slot_values
+ */
+const int *libevdev_get_slot_values_ptr(const struct libevdev *dev,
+					unsigned int code);
+
 /**
  * @ingroup mt
  *
@@ -1659,6 +1913,217 @@ int libevdev_fetch_slot_value(const struct libevdev *dev, unsigned int slot, uns
  */
 int libevdev_get_num_slots(const struct libevdev *dev);
 
+/**
+ * @ingroup mt
+ *
+ * Iterate over the slots that currently have a touch, i.e. whose
+ * ABS_MT_TRACKING_ID is not -1. The set of active slots is maintained
+ * as events are processed, so iterating costs time proportional to the
+ * number of touches, not the number of slots.
+ *
+ * @code
+ * int slot;
+ *
+ * for (slot = libevdev_next_active_slot(dev, -1);
+ *      slot != -1;
+ *      slot = libevdev_next_active_slot(dev, slot))
+ *     handle_touch(slot);
+ * @endcode
+ *
+ * A device without ABS_MT_TRACKING_ID never has an active slot.
+ *
+ * @param dev The evdev device, already initialized with libevdev_set_fd()
+ * @param slot The previous active slot, or -1 to get the first active slot
+ *
+ * @return The next active slot after slot, or -1 if there is none
+ *
+ * @note This function is signal-safe.
+ * @see libevdev_get_num_active_slots
+ */
+int libevdev_next_active_slot(const struct libevdev *dev, int slot);
+
+/**
+ * @ingroup mt
+ *
+ * @param dev The evdev device, already initialized with libevdev_set_fd()
+ *
+ * @return The number of slots whose ABS_MT_TRACKING_ID is not -1
+ *
+ * @note This function is signal-safe.
+ * @see libevdev_next_active_slot
+ */
+int libevdev_get_num_active_slots(const struct libevdev *dev);
+
+/**
+ * @ingroup mt
+ *
+ * Check whether the value of the code in the given slot changed in the
+ * last frame, i.e. in the events up to and including the most recent
+ * SYN_REPORT processed by libevdev_next_event(). The changes of a frame
+ * become visible when its SYN_REPORT is processed and stay visible until
+ * the next SYN_REPORT is processed.
+ *
+ * @param dev The evdev device, already initialized with libevdev_set_fd()
+ * @param slot The numerical slot number
+ * @param code The event code, one of ABS_MT_POSITION_X, etc. ABS_MT_SLOT
+ * checks whether any code changed in this slot.
+ *
+ * @return 1 if the value changed in the last frame, 0 otherwise or if the
+ * slot or code is invalid
+ *
+ * @note This function is signal-safe.
+ * @see libevdev_next_changed_slot
+ */
+int libevdev_slot_value_changed(const struct libevdev *dev, unsigned int slot, unsigned int code);
+
+/**
+ * @ingroup mt
+ *
+ * Iterate over the slots with at least one changed value in the last
+ * frame, see libevdev_slot_value_changed().
+ *
+ * @code
+ * int slot;
+ *
+ * for (slot = libevdev_next_changed_slot(dev, -1);
+ *      slot != -1;
+ *      slot = libevdev_next_changed_slot(dev, slot)) {
+ *     if (libevdev_slot_value_changed(dev, slot, ABS_MT_POSITION_X))
+ *         update_x(slot);
+ * }
+ * @endcode
+ *
+ * @param dev The evdev device, already initialized with libevdev_set_fd()
+ * @param slot The previous changed slot, or -1 to get the first changed slot
+ *
+ * @return The next changed slot after slot, or -1 if there is none
+ *
+ * @note This function is signal-safe.
+ */
+int libevdev_next_changed_slot(const struct libevdev *dev, int slot);
+
+/**
+ * @ingroup mt
+ *
+ * One touch in a struct libevdev_touch_frame. Axes the device does not
+ * support are 0.
+ */
+struct libevdev_touch {
+	int slot;
+	int tracking_id;
+	int x;        /**< ABS_MT_POSITION_X */
+	int y;        /**< ABS_MT_POSITION_Y */
+	int pressure; /**< ABS_MT_PRESSURE */
+};
+
+/**
+ * @ingroup mt
+ *
+ * The active touches at the end of a frame, see
+ * libevdev_enable_touch_history().
+ */
+struct libevdev_touch_frame {
+	struct timeval time;                  /**< time of the SYN_REPORT */
+	int ntouches;                         /**< number of elements in touches */
+	const struct libevdev_touch *touches; /**< in slot order */
+};
+
+/**
+ * @ingroup mt
+ *
+ * Keep a history of the last nframes touch frames. Whenever
+ * libevdev_next_event() processes a SYN_REPORT, a struct
+ * libevdev_touch_frame with all active touches (see
+ * libevdev_next_active_slot()) is recorded, overwriting the oldest frame
+ * once nframes are recorded.
+ *
+ * The history is stored in memory allocated once by this function, the
+ * frames are read in place with libevdev_get_touch_frame(). Enabling the
+ * history again discards all recorded frames, an nframes of 0 disables
+ * it. The history is disabled when the device is re-initialized.
+ *
+ * @code
+ * const struct libevdev_touch_frame *now, *before;
+ *
+ * libevdev_enable_touch_history(dev, 8);
+ * ...
+ * now = libevdev_get_touch_frame(dev, 0);
+ * before = libevdev_get_touch_frame(dev, 4);
+ * if (now && before)
+ *     estimate_velocity(before, now);
+ * @endcode
+ *
+ * @param dev The evdev device, already initialized with libevdev_set_fd()
+ * @param nframes The number of frames to keep, or 0 to disable the history
+ *
+ * @return 0 on success, -EINVAL if the device has no slots or no
+ * ABS_MT_TRACKING_ID, or -ENOMEM
+ */
+int libevdev_enable_touch_history(struct libevdev *dev, unsigned int nframes);
+
+/**
+ * @ingroup mt
+ *
+ * @param dev The evdev device, already initialized with libevdev_set_fd()
+ *
+ * @return The number of frames in the touch history, at most the number
+ * of frames passed to libevdev_enable_touch_history()
+ *
+ * @note This function is signal-safe.
+ */
+int libevdev_get_num_touch_frames(const struct libevdev *dev);
+
+/**
+ * @ingroup mt
+ *
+ * Get a frame from the touch history. The frame is not copied and is
+ * valid until it is overwritten by a newer frame or the history is
+ * disabled.
+ *
+ * @param dev The evdev device, already initialized with libevdev_set_fd()
+ * @param age 0 for the most recent frame, 1 for the one before, etc.
+ *
+ * @return The frame, or NULL if age is not smaller than
+ * libevdev_get_num_touch_frames()
+ *
+ * @note This function is signal-safe.
+ */
+const struct libevdev_touch_frame *
+libevdev_get_touch_frame(const struct libevdev *dev, unsigned int age);
+
+/**
+ * @ingroup mt
+ *
+ * Convert the events of a device that uses the multitouch protocol A
+ * into protocol B events. Protocol A devices send anonymous contacts,
+ * each terminated by a SYN_MT_REPORT, and have no ABS_MT_SLOT. Once
+ * conversion is enabled, the device has nslots slots and an
+ * ABS_MT_SLOT and ABS_MT_TRACKING_ID axis, and all slot functions
+ * behave as for a protocol B device.
+ *
+ * The ABS_MT_* and SYN_MT_REPORT events of a frame are not returned by
+ * libevdev_next_event(). When the frame's SYN_REPORT is read, its contacts
+ * are matched to the touches of the previous frame and the ABS_MT_SLOT,
+ * ABS_MT_TRACKING_ID and ABS_MT_* events that describe the difference are
+ * returned instead, followed by the SYN_REPORT. Contacts are matched by
+ * the device's ABS_MT_TRACKING_ID if the device sends one, otherwise by
+ * the smallest distance between ABS_MT_POSITION_X/Y. A contact further
+ * than an eighth of the axis ranges from all previous touches starts a
+ * new touch. Contacts that do not
+ * fit into nslots slots are dropped. Events of other types are returned
+ * in order, before the MT events of their frame.
+ *
+ * Conversion ends when the device is re-initialized.
+ *
+ * @param dev The evdev device, already initialized with libevdev_set_fd()
+ * @param nslots The number of slots to assign contacts to, at most 1024
+ *
+ * @return 0 on success, -EINVAL if the device already has slots or no
+ * ABS_MT_POSITION_X and ABS_MT_POSITION_Y, or if nslots is 0 or too large,
+ * or -ENOMEM
+ */
+int libevdev_enable_mt_protocol_a_conversion(struct libevdev *dev, unsigned int nslots);
+
 /**
  * @ingroup mt
  *
@@ -2034,6 +2499,49 @@ const char * libevdev_event_code_get_name(unsigned int type, unsigned int code);
  */
 const char* libevdev_property_get_name(unsigned int prop);
 
+/**
+ * @ingroup misc
+ *
+ * Format an event as one line of text, e.g.
+ * "1387781040.123456 EV_ABS ABS_X 100\n": the timestamp, the type and
+ * code names and the value. A type or code without a name is written as
+ * a decimal number.
+ *
+ * This function does not allocate memory and does not use stdio, it is
+ * meant for tracing events at a high rate.
+ *
+ * @param ev The event to format
+ * @param buf The buffer to write the null-terminated line to
+ * @param size The size of buf in bytes
+ *
+ * @return The length of the line excluding the terminating null byte,
+ * or -ENOSPC if it does not fit into buf
+ *
+ * @note This function is signal-safe.
+ */
+int libevdev_event_format(const struct input_event *ev, char *buf, size_t size);
+
+/**
+ * @ingroup misc
+ *
+ * Format events as lines of text, see libevdev_event_format(). The lines
+ * are written back to back into buf until all events are formatted or
+ * the next line does not fit. buf is null-terminated unless size is 0.
+ *
+ * @param events The events to format
+ * @param nevents The number of events
+ * @param buf The buffer to write the lines to
+ * @param size The size of buf in bytes
+ * @param[out] len Set to the length of the text in buf excluding the
+ * terminating null byte, may be NULL
+ *
+ * @return The number of events formatted
+ *
+ * @note This function is signal-safe.
+ */
+int libevdev_events_format(const struct input_event *events, size_t nevents,
+			   char *buf, size_t size, size_t *len);
+
 /**
  * @ingroup misc
  *
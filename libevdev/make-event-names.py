@@ -73,6 +73,16 @@ def print_bits(bits, prefix):
 	print("};")
 	print("")
 
+	# the lengths of the names above, for libevdev_event_format()
+	print("static const unsigned char %s_len_map[%s_MAX + 1] = {" % (prefix, prefix.upper()))
+	for val, name in list(getattr(bits, prefix).items()):
+		print("	[%s] = %d," % (name, len(name)))
+	if prefix == "key":
+		for val, name in list(getattr(bits, "btn").items()):
+			print("	[%s] = %d," % (name, len(name)))
+	print("};")
+	print("")
+
 def print_map(bits):
 	print("static const char * const * const event_type_map[EV_MAX + 1] = {")
 
@@ -84,6 +94,22 @@ def print_map(bits):
 	print("};")
 	print("")
 
+	print("static const unsigned char * const event_type_len_map[EV_MAX + 1] = {")
+	for prefix in prefixes:
+		if prefix == "BTN_" or prefix == "EV_" or prefix == "INPUT_PROP_":
+			continue
+		print("	[EV_%s] = %s_len_map," % (prefix[:-1], prefix[:-1].lower()))
+	print("};")
+	print("")
+
+	longest = 0
+	for prefix in prefixes:
+		attr = prefix[:-1].lower()
+		if hasattr(bits, attr):
+			longest = max([longest] + [len(n) for n in getattr(bits, attr).values()])
+	print("#define EVENT_NAME_MAX_LEN %d" % longest)
+	print("")
+
 	print("#if __clang__")
 	print("#pragma clang diagnostic push")
 	print("#pragma clang diagnostic ignored \"-Winitializer-overrides\"")
@@ -105,35 +131,122 @@ def print_map(bits):
 	print("#endif");
 	print("")
 
-def print_lookup(bits, prefix):
-	if not hasattr(bits, prefix):
-		return
-
-	names = list(getattr(bits, prefix).items())
-	if prefix == "btn":
-		names = names + btn_additional;
-
-	for val, name in sorted(names, key=lambda e: e[1]):
-		print("	{ .name = \"%s\", .value = %s }," % (name, name))
+# Name lookup uses a perfect hash built with "hash and displace": the
+# 64-bit FNV-1a hash of a name selects a bucket by its upper half, the
+# bucket's displacement is mixed into the lower half to get the slot.
+# The displacements are chosen here so that no two names share a slot,
+# libevdev-names.c must hash the same way.
+FNV_OFFSET = 0xcbf29ce484222325
+FNV_PRIME = 0x100000001b3
+MASK32 = 0xffffffff
+MASK64 = 0xffffffffffffffff
+
+def fnv1a(name):
+	h = FNV_OFFSET
+	for c in name:
+		h = ((h ^ ord(c)) * FNV_PRIME) & MASK64
+	return h
+
+def fmix32(h):
+	h ^= h >> 16
+	h = (h * 0x85ebca6b) & MASK32
+	h ^= h >> 13
+	h = (h * 0xc2b2ae35) & MASK32
+	h ^= h >> 16
+	return h
+
+def name_type(name):
+	# same rules as libevdev_event_code_from_name() always had: BTN_ is
+	# EV_KEY and FF_STATUS_ must be tested before FF_
+	if name.startswith("EV_"):
+		return "NAME_TYPE_EVENT_TYPE"
+	if name.startswith("INPUT_PROP_"):
+		return "NAME_TYPE_PROPERTY"
+	if name.startswith("BTN_"):
+		return "EV_KEY"
+	if name.startswith("FF_STATUS_"):
+		return "EV_FF_STATUS"
+	return "EV_" + name.split("_")[0]
+
+def all_names(bits):
+	entries = []
+	for prefix in prefixes:
+		attr = prefix[:-1].lower()
+		if not hasattr(bits, attr):
+			continue
+		entries += [name for val, name in getattr(bits, attr).items()]
+		if attr == "btn":
+			entries += [name for val, name in btn_additional]
+	return sorted(set(entries))
+
+def build_hash(names):
+	size = 1
+	while size < len(names):
+		size *= 2
+
+	while True:
+		nbuckets = size // 4
+		buckets = [[] for i in range(nbuckets)]
+		for name in names:
+			h = fnv1a(name)
+			buckets[(h >> 32) & (nbuckets - 1)].append(h & MASK32)
+
+		slots = [None] * size
+		displacements = [0] * nbuckets
+		ok = True
+		for b in sorted(range(nbuckets), key=lambda b: -len(buckets[b])):
+			if not buckets[b]:
+				continue
+			for d in range(0x10000):
+				idx = [fmix32(h ^ d) & (size - 1) for h in buckets[b]]
+				if len(set(idx)) == len(idx) and \
+				   all(slots[i] is None for i in idx):
+					break
+			else:
+				ok = False
+				break
+			displacements[b] = d
+			for i, h in zip(idx, buckets[b]):
+				slots[i] = h
+		if ok:
+			break
+		size *= 2
+
+	table = [None] * size
+	for name in names:
+		h = fnv1a(name)
+		d = displacements[(h >> 32) & (nbuckets - 1)]
+		table[fmix32((h & MASK32) ^ d) & (size - 1)] = name
+
+	return table, displacements
 
 def print_lookup_table(bits):
+	table, displacements = build_hash(all_names(bits))
+
+	print("#define NAME_TYPE_EVENT_TYPE -1")
+	print("#define NAME_TYPE_PROPERTY -2")
+	print("")
 	print("struct name_entry {")
-	print("	const char *name;")
+	print("	const char *name; /* NULL for an empty slot */")
+	print("	unsigned short len;")
+	print("	short type; /* EV_* for codes or NAME_TYPE_* */")
 	print("	unsigned int value;")
 	print("};")
 	print("")
-	print("static const struct name_entry ev_names[] = {")
-	print_lookup(bits, "ev")
-	print("};")
+	print("#define NAME_HASH_SIZE %d" % len(table))
+	print("#define NAME_HASH_BUCKETS %d" % len(displacements))
 	print("")
-
-	print("static const struct name_entry code_names[] = {")
-	for prefix in sorted(names, key=lambda e: e):
-		print_lookup(bits, prefix[:-1].lower())
+	print("static const unsigned short name_hash_displacements[NAME_HASH_BUCKETS] = {")
+	for i in range(0, len(displacements), 8):
+		print("	" + " ".join("%d," % d for d in displacements[i:i + 8]))
 	print("};")
 	print("")
-	print("static const struct name_entry prop_names[] = {")
-	print_lookup(bits, "input_prop")
+	print("static const struct name_entry name_hash_table[NAME_HASH_SIZE] = {")
+	for idx, name in enumerate(table):
+		if name is None:
+			continue
+		print("	[%d] = { .name = \"%s\", .len = %d, .type = %s, .value = %s }," %
+		      (idx, name, len(name), name_type(name), name))
 	print("};")
 	print("")
 
@@ -0,0 +1,161 @@
+/*
+ * Copyright © 2026 The libevdev contributors
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided that
+ * the above copyright notice appear in all copies and that both that copyright
+ * notice and this permission notice appear in supporting documentation, and
+ * that the name of the copyright holders not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  The copyright holders make no representations
+ * about the suitability of this software for any purpose.  It is provided "as
+ * is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN NO
+ * EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+ * TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE
+ * OF THIS SOFTWARE.
+ */
+
+/*
+ * Measures the time libevdev_next_event() takes to process touch frames
+ * from a 10-finger touchscreen. Each frame moves all ten touches, i.e.
+ * ten slot switches with x, y, pressure and touch major each. The frames
+ * are generated through uinput, so this needs write access to
+ * /dev/uinput.
+ *
+ * Usage: bench-mt-frames [number of frames]
+ */
+
+#include <config.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <libevdev/libevdev.h>
+#include <libevdev/libevdev-uinput.h>
+
+#define NFINGERS 10
+
+static const unsigned int axes[] = {
+	ABS_MT_POSITION_X,
+	ABS_MT_POSITION_Y,
+	ABS_MT_PRESSURE,
+	ABS_MT_TOUCH_MAJOR,
+};
+
+static uint64_t
+now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static struct libevdev *
+create_template(void)
+{
+	struct libevdev *dev = libevdev_new();
+	struct input_absinfo abs = { 0, 0, 4095, 0, 0, 0 };
+	size_t i;
+
+	libevdev_set_name(dev, "libevdev bench touchscreen");
+	libevdev_enable_event_code(dev, EV_KEY, BTN_TOUCH, NULL);
+
+	abs.maximum = NFINGERS - 1;
+	libevdev_enable_event_code(dev, EV_ABS, ABS_MT_SLOT, &abs);
+	abs.maximum = 0xffff;
+	libevdev_enable_event_code(dev, EV_ABS, ABS_MT_TRACKING_ID, &abs);
+	abs.maximum = 4095;
+	for (i = 0; i < sizeof(axes)/sizeof(axes[0]); i++)
+		libevdev_enable_event_code(dev, EV_ABS, axes[i], &abs);
+	libevdev_enable_property(dev, INPUT_PROP_DIRECT);
+
+	return dev;
+}
+
+static void
+write_frame(struct libevdev_uinput *uidev, int frame)
+{
+	int slot;
+	size_t i;
+
+	for (slot = 0; slot < NFINGERS; slot++) {
+		libevdev_uinput_write_event(uidev, EV_ABS, ABS_MT_SLOT, slot);
+		if (frame == 0)
+			libevdev_uinput_write_event(uidev, EV_ABS,
+						    ABS_MT_TRACKING_ID, slot);
+		for (i = 0; i < sizeof(axes)/sizeof(axes[0]); i++)
+			libevdev_uinput_write_event(uidev, EV_ABS, axes[i],
+						    (frame + slot * 100 + i) % 4096);
+	}
+	libevdev_uinput_write_event(uidev, EV_SYN, SYN_REPORT, 0);
+}
+
+int
+main(int argc, char **argv)
+{
+	struct libevdev *template, *dev;
+	struct libevdev_uinput *uidev;
+	struct input_event ev;
+	const char *devnode;
+	int nframes = argc > 1 ? atoi(argv[1]) : 20000;
+	int frame, fd, rc;
+	int nevents = 0;
+	uint64_t elapsed = 0;
+
+	template = create_template();
+	rc = libevdev_uinput_create_from_device(template,
+						LIBEVDEV_UINPUT_OPEN_MANAGED,
+						&uidev);
+	if (rc < 0) {
+		fprintf(stderr, "Failed to create uinput device: %s\n",
+			strerror(-rc));
+		return 1;
+	}
+
+	devnode = libevdev_uinput_get_devnode(uidev);
+	fd = devnode ? open(devnode, O_RDONLY|O_NONBLOCK) : -1;
+	if (fd < 0 || libevdev_new_from_fd(fd, &dev) < 0) {
+		fprintf(stderr, "Failed to open the device\n");
+		return 1;
+	}
+
+	for (frame = 0; frame < nframes; frame++) {
+		uint64_t start;
+
+		write_frame(uidev, frame);
+
+		start = now();
+		while ((rc = libevdev_next_event(dev,
+						 LIBEVDEV_READ_FLAG_NORMAL,
+						 &ev)) == LIBEVDEV_READ_STATUS_SUCCESS)
+			nevents++;
+		elapsed += now() - start;
+
+		if (rc != -EAGAIN) {
+			fprintf(stderr, "Unexpected read status %d\n", rc);
+			break;
+		}
+	}
+
+	printf("%d frames, %d events: %.1f ns/frame, %.1f ns/event\n",
+	       frame, nevents,
+	       (double)elapsed / frame,
+	       (double)elapsed / nevents);
+
+	libevdev_free(dev);
+	close(fd);
+	libevdev_uinput_destroy(uidev);
+	libevdev_free(template);
+
+	return 0;
+}
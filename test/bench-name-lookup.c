@@ -0,0 +1,156 @@
+/*
+ * Copyright © 2026 The libevdev contributors
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided that
+ * the above copyright notice appear in all copies and that both that copyright
+ * notice and this permission notice appear in supporting documentation, and
+ * that the name of the copyright holders not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  The copyright holders make no representations
+ * about the suitability of this software for any purpose.  It is provided "as
+ * is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN NO
+ * EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+ * TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE
+ * OF THIS SOFTWARE.
+ */
+
+/*
+ * Measures libevdev_event_code_from_name() for every event code name
+ * against a bsearch() over a sorted copy of the names, the way the
+ * lookup used to work. The bsearch is timed without the walk over the
+ * type prefixes the old lookup did first, so the real difference was
+ * larger than shown.
+ *
+ * Usage: bench-name-lookup [number of rounds]
+ */
+
+#include <config.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <libevdev/libevdev.h>
+
+struct name {
+	const char *name;
+	size_t len;
+	unsigned int type;
+	unsigned int code;
+};
+
+static uint64_t
+now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static int
+cmp_sort(const void *a, const void *b)
+{
+	return strcmp(((const struct name *)a)->name,
+		      ((const struct name *)b)->name);
+}
+
+static int
+cmp_lookup(const void *vlookup, const void *ventry)
+{
+	const struct name *lookup = vlookup;
+	const struct name *entry = ventry;
+	int r;
+
+	r = strncmp(lookup->name, entry->name, lookup->len);
+	if (!r && entry->name[lookup->len])
+		r = -1;
+
+	return r;
+}
+
+static int
+bsearch_from_name(const struct name *sorted, size_t n,
+		  unsigned int type, const char *name, size_t len)
+{
+	struct name lookup = { name, len, 0, 0 };
+	const struct name *entry;
+
+	entry = bsearch(&lookup, sorted, n, sizeof(*sorted), cmp_lookup);
+	if (!entry || entry->type != type)
+		return -1;
+
+	return entry->code;
+}
+
+int
+main(int argc, char **argv)
+{
+	int nrounds = argc > 1 ? atoi(argv[1]) : 2000;
+	struct name *names, *sorted;
+	size_t n = 0, i;
+	unsigned int type, code;
+	uint64_t start, hashed, searched;
+	int round;
+	long sum = 0;
+
+	names = calloc(KEY_CNT * EV_CNT, sizeof(*names));
+	for (type = 0; type <= EV_MAX; type++) {
+		int max = libevdev_event_type_get_max(type);
+
+		for (code = 0; max != -1 && code <= (unsigned int)max; code++) {
+			const char *name = libevdev_event_code_get_name(type, code);
+
+			if (!name)
+				continue;
+
+			/* FF_STATUS_ names are in the FF_ map */
+			if (type == EV_FF && strncmp(name, "FF_STATUS_", 10) == 0)
+				continue;
+
+			names[n].name = name;
+			names[n].len = strlen(name);
+			names[n].type = type;
+			names[n].code = code;
+			n++;
+		}
+	}
+
+	sorted = malloc(n * sizeof(*sorted));
+	memcpy(sorted, names, n * sizeof(*sorted));
+	qsort(sorted, n, sizeof(*sorted), cmp_sort);
+
+	start = now();
+	for (round = 0; round < nrounds; round++) {
+		for (i = 0; i < n; i++)
+			sum += libevdev_event_code_from_name_n(names[i].type,
+							       names[i].name,
+							       names[i].len);
+	}
+	hashed = now() - start;
+
+	start = now();
+	for (round = 0; round < nrounds; round++) {
+		for (i = 0; i < n; i++)
+			sum -= bsearch_from_name(sorted, n, names[i].type,
+						 names[i].name, names[i].len);
+	}
+	searched = now() - start;
+
+	printf("%zu names, %d rounds\n", n, nrounds);
+	printf("libevdev_event_code_from_name_n: %.1f ns/lookup\n",
+	       (double)hashed / (n * nrounds));
+	printf("bsearch:                         %.1f ns/lookup\n",
+	       (double)searched / (n * nrounds));
+
+	free(names);
+	free(sorted);
+
+	return sum == 0 ? 0 : 1;
+}
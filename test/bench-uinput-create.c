@@ -0,0 +1,150 @@
+/*
+ * Copyright © 2026 The libevdev contributors
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided that
+ * the above copyright notice appear in all copies and that both that copyright
+ * notice and this permission notice appear in supporting documentation, and
+ * that the name of the copyright holders not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  The copyright holders make no representations
+ * about the suitability of this software for any purpose.  It is provided "as
+ * is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN NO
+ * EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+ * TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE
+ * OF THIS SOFTWARE.
+ */
+
+/*
+ * Measures uinput device creation for a full keyboard: one device at a
+ * time with libevdev_uinput_create_from_device() and all at once with
+ * libevdev_uinput_create_from_devices(). The lookup of the device node,
+ * done on the first libevdev_uinput_get_devnode() call, is timed
+ * separately. This needs write access to /dev/uinput.
+ *
+ * Usage: bench-uinput-create [number of devices]
+ */
+
+#include <config.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <libevdev/libevdev.h>
+#include <libevdev/libevdev-uinput.h>
+
+static uint64_t
+now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static struct libevdev *
+create_template(void)
+{
+	struct libevdev *dev = libevdev_new();
+	unsigned int code;
+
+	libevdev_set_name(dev, "libevdev bench keyboard");
+	for (code = 0; code < BTN_MISC; code++)
+		libevdev_enable_event_code(dev, EV_KEY, code, NULL);
+	for (code = KEY_OK; code <= KEY_MAX; code++)
+		libevdev_enable_event_code(dev, EV_KEY, code, NULL);
+	libevdev_enable_event_code(dev, EV_MSC, MSC_SCAN, NULL);
+	libevdev_enable_event_code(dev, EV_LED, LED_CAPSL, NULL);
+	libevdev_enable_event_code(dev, EV_LED, LED_NUML, NULL);
+
+	return dev;
+}
+
+static int
+lookup_all(struct libevdev_uinput **uidevs, int n, uint64_t *elapsed)
+{
+	uint64_t start = now();
+	int i;
+
+	for (i = 0; i < n; i++) {
+		if (!libevdev_uinput_get_devnode(uidevs[i])) {
+			fprintf(stderr, "Failed to find the device node\n");
+			return -1;
+		}
+	}
+
+	*elapsed += now() - start;
+
+	return 0;
+}
+
+int
+main(int argc, char **argv)
+{
+	struct libevdev *template;
+	struct libevdev_uinput **uidevs;
+	const struct libevdev **templates;
+	int ndevices = argc > 1 ? atoi(argv[1]) : 100;
+	uint64_t start, single = 0, bulk = 0, lookup = 0;
+	int i, rc;
+
+	template = create_template();
+	uidevs = calloc(ndevices, sizeof(*uidevs));
+	templates = calloc(ndevices, sizeof(*templates));
+	for (i = 0; i < ndevices; i++)
+		templates[i] = template;
+
+	for (i = 0; i < ndevices; i++) {
+		start = now();
+		rc = libevdev_uinput_create_from_device(template,
+							LIBEVDEV_UINPUT_OPEN_MANAGED,
+							&uidevs[i]);
+		single += now() - start;
+		if (rc < 0) {
+			fprintf(stderr, "Failed to create uinput device: %s\n",
+				strerror(-rc));
+			return 1;
+		}
+	}
+
+	if (lookup_all(uidevs, ndevices, &lookup) < 0)
+		return 1;
+
+	for (i = 0; i < ndevices; i++)
+		libevdev_uinput_destroy(uidevs[i]);
+
+	start = now();
+	rc = libevdev_uinput_create_from_devices(templates, ndevices, uidevs);
+	bulk += now() - start;
+	if (rc < 0) {
+		fprintf(stderr, "Failed to create uinput devices: %s\n",
+			strerror(-rc));
+		return 1;
+	}
+
+	if (lookup_all(uidevs, ndevices, &lookup) < 0)
+		return 1;
+
+	for (i = 0; i < ndevices; i++)
+		libevdev_uinput_destroy(uidevs[i]);
+
+	printf("%d devices\n", ndevices);
+	printf("libevdev_uinput_create_from_device:  %.1f us/device\n",
+	       (double)single / ndevices / 1000);
+	printf("libevdev_uinput_create_from_devices: %.1f us/device\n",
+	       (double)bulk / ndevices / 1000);
+	printf("libevdev_uinput_get_devnode:         %.1f us/device\n",
+	       (double)lookup / (2 * ndevices) / 1000);
+
+	free(uidevs);
+	free(templates);
+	libevdev_free(template);
+
+	return 0;
+}
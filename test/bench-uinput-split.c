@@ -0,0 +1,241 @@
+/*
+ * Copyright © 2026 The libevdev contributors
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided that
+ * the above copyright notice appear in all copies and that both that copyright
+ * notice and this permission notice appear in supporting documentation, and
+ * that the name of the copyright holders not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  The copyright holders make no representations
+ * about the suitability of this software for any purpose.  It is provided "as
+ * is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN NO
+ * EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+ * TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE
+ * OF THIS SOFTWARE.
+ */
+
+/*
+ * Measures the latency a libevdev_uinput_splitter adds. A frame with a
+ * button and a motion event is posted on a uinput device; the time until
+ * the frame is read is taken once from the device itself and once from
+ * the two devices the splitter routes the button and the motion to,
+ * including the splitter's dispatch. This needs write access to
+ * /dev/uinput.
+ *
+ * Usage: bench-uinput-split [number of frames]
+ */
+
+#include <config.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <libevdev/libevdev.h>
+#include <libevdev/libevdev-uinput.h>
+
+static uint64_t
+now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static int
+cmp_u64(const void *a, const void *b)
+{
+	uint64_t ua = *(const uint64_t *)a, ub = *(const uint64_t *)b;
+
+	return ua < ub ? -1 : ua > ub;
+}
+
+/**
+ * Post the frame-th frame, BTN_0 toggles in every frame.
+ */
+static void
+post_frame(struct libevdev_uinput *uinput, int frame)
+{
+	struct input_event events[3];
+
+	memset(events, 0, sizeof(events));
+	events[0].type = EV_KEY;
+	events[0].code = BTN_0;
+	events[0].value = frame % 2;
+	events[1].type = EV_REL;
+	events[1].code = REL_X;
+	events[1].value = 1;
+	events[2].type = EV_SYN;
+	events[2].code = SYN_REPORT;
+
+	libevdev_uinput_write_events(uinput, events, 3);
+}
+
+/**
+ * Read from dev until its SYN_REPORT, waiting for the fd if needed.
+ */
+static int
+read_frame(struct libevdev *dev)
+{
+	struct pollfd fds = { libevdev_get_fd(dev), POLLIN, 0 };
+	struct input_event ev;
+	int rc;
+
+	while (true) {
+		rc = libevdev_next_event(dev, LIBEVDEV_READ_FLAG_NORMAL, &ev);
+		if (rc == -EAGAIN) {
+			if (poll(&fds, 1, 1000) <= 0)
+				return -ETIMEDOUT;
+			continue;
+		} else if (rc < 0) {
+			return rc;
+		}
+
+		if (ev.type == EV_SYN && ev.code == SYN_REPORT)
+			return 0;
+	}
+}
+
+static int
+split_frame(struct libevdev_uinput_splitter *splitter,
+	    struct libevdev *source, struct libevdev **sinks)
+{
+	struct pollfd fds = { libevdev_get_fd(source), POLLIN, 0 };
+	int rc;
+
+	if (poll(&fds, 1, 1000) <= 0)
+		return -ETIMEDOUT;
+
+	rc = libevdev_uinput_splitter_dispatch(splitter);
+	if (rc == 0)
+		rc = read_frame(sinks[0]);
+	if (rc == 0)
+		rc = read_frame(sinks[1]);
+
+	return rc;
+}
+
+static void
+print_latency(const char *what, uint64_t *latency, int n)
+{
+	qsort(latency, n, sizeof(*latency), cmp_u64);
+	printf("%s median %.1f us, 99th percentile %.1f us\n", what,
+	       latency[n / 2] / 1000.0, latency[n * 99 / 100] / 1000.0);
+}
+
+int
+main(int argc, char **argv)
+{
+	struct libevdev_uinput_split_rule rules[] = {
+		{ EV_KEY, 0, KEY_MAX, 0 },
+		{ EV_REL, 0, REL_MAX, 1 },
+	};
+	struct libevdev *template, *source, *sinks[2];
+	struct libevdev_uinput *uinput;
+	struct libevdev_uinput_splitter *splitter;
+	int nframes = argc > 1 ? atoi(argv[1]) : 10000;
+	uint64_t *direct, *split, start;
+	const char *devnode;
+	int nposted = 0;
+	int fd, i, rc;
+
+	if (nframes < 1)
+		nframes = 1;
+
+	template = libevdev_new();
+	libevdev_set_name(template, "libevdev bench splitter source");
+	libevdev_enable_event_code(template, EV_KEY, BTN_0, NULL);
+	libevdev_enable_event_code(template, EV_REL, REL_X, NULL);
+	libevdev_enable_event_code(template, EV_REL, REL_Y, NULL);
+
+	rc = libevdev_uinput_create_from_device(template,
+						LIBEVDEV_UINPUT_OPEN_MANAGED,
+						&uinput);
+	libevdev_free(template);
+	if (rc < 0) {
+		fprintf(stderr, "Failed to create uinput device: %s\n",
+			strerror(-rc));
+		return 1;
+	}
+
+	devnode = libevdev_uinput_get_devnode(uinput);
+	fd = devnode ? open(devnode, O_RDONLY|O_NONBLOCK) : -1;
+	if (fd < 0 || libevdev_new_from_fd(fd, &source) < 0) {
+		fprintf(stderr, "Failed to open the uinput device\n");
+		return 1;
+	}
+
+	direct = calloc(nframes, sizeof(*direct));
+	split = calloc(nframes, sizeof(*split));
+
+	for (i = 0; i < nframes; i++) {
+		start = now();
+		post_frame(uinput, nposted++);
+		if (read_frame(source) < 0) {
+			fprintf(stderr, "Failed to read a frame\n");
+			return 1;
+		}
+		direct[i] = now() - start;
+	}
+
+	rc = libevdev_uinput_splitter_new(source, rules, 2, NULL, 2,
+					  LIBEVDEV_UINPUT_OPEN_MANAGED,
+					  &splitter);
+	if (rc < 0) {
+		fprintf(stderr, "Failed to create the splitter: %s\n",
+			strerror(-rc));
+		return 1;
+	}
+
+	for (i = 0; i < 2; i++) {
+		struct libevdev_uinput *sink;
+		int sink_fd;
+
+		sink = libevdev_uinput_splitter_get_uinput(splitter, i);
+		devnode = libevdev_uinput_get_devnode(sink);
+		sink_fd = devnode ? open(devnode, O_RDONLY|O_NONBLOCK) : -1;
+		if (sink_fd < 0 || libevdev_new_from_fd(sink_fd, &sinks[i]) < 0) {
+			fprintf(stderr, "Failed to open the split devices\n");
+			return 1;
+		}
+	}
+
+	for (i = 0; i < nframes; i++) {
+		start = now();
+		post_frame(uinput, nposted++);
+		if (split_frame(splitter, source, sinks) < 0) {
+			fprintf(stderr, "Failed to read a split frame\n");
+			return 1;
+		}
+		split[i] = now() - start;
+	}
+
+	printf("%d frames\n", nframes);
+	print_latency("direct:", direct, nframes);
+	print_latency("split: ", split, nframes);
+
+	for (i = 0; i < 2; i++) {
+		close(libevdev_get_fd(sinks[i]));
+		libevdev_free(sinks[i]);
+	}
+	libevdev_uinput_splitter_free(splitter);
+	libevdev_free(source);
+	close(fd);
+	libevdev_uinput_destroy(uinput);
+	free(direct);
+	free(split);
+
+	return 0;
+}
@@ -1,5 +1,7 @@
 #include <libevdev/libevdev.h>
 #include <libevdev/libevdev-uinput.h>
+#include <libevdev/libevdev-enumerate.h>
+#include <libevdev/libevdev-device-set.h>
 
 int main(void) {
 	return 0;
@@ -0,0 +1,208 @@
+/*
+ * Copyright © 2026 The libevdev contributors
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided that
+ * the above copyright notice appear in all copies and that both that copyright
+ * notice and this permission notice appear in supporting documentation, and
+ * that the name of the copyright holders not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  The copyright holders make no representations
+ * about the suitability of this software for any purpose.  It is provided "as
+ * is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN NO
+ * EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+ * TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE
+ * OF THIS SOFTWARE.
+ */
+
+#include <config.h>
+#include <errno.h>
+#include <libevdev/libevdev-device-set.h>
+
+#include "test-common.h"
+
+static struct libevdev *
+new_device(unsigned int type, unsigned int code, int prop)
+{
+	struct libevdev *dev = libevdev_new();
+	struct input_absinfo abs = { 0, 0, 100, 0, 0, 0 };
+
+	ck_assert(dev != NULL);
+	ck_assert_int_eq(libevdev_enable_event_code(dev, type, code,
+						    type == EV_ABS ? &abs : NULL), 0);
+	if (prop != -1)
+		ck_assert_int_eq(libevdev_enable_property(dev, prop), 0);
+
+	return dev;
+}
+
+START_TEST(test_device_set_invalid)
+{
+	struct libevdev_device_set *set;
+	const unsigned int bad_type[] = { EV_MAX + 1, 0 };
+	const unsigned int bad_code[] = { EV_ABS, ABS_MAX + 1 };
+	const unsigned int no_codes[] = { EV_PWR, 0 };
+	const unsigned int bad_prop[] = { INPUT_PROP_MAX + 1 };
+	struct libevdev *dev = libevdev_new();
+
+	ck_assert_int_eq(libevdev_device_set_new(&set), 0);
+	ck_assert_int_eq(libevdev_device_set_get_num_devices(set), 0);
+
+	ck_assert_int_eq(libevdev_device_set_query(set, bad_type, 1, NULL, 0, NULL, 0), -EINVAL);
+	ck_assert_int_eq(libevdev_device_set_query(set, bad_code, 1, NULL, 0, NULL, 0), -EINVAL);
+	ck_assert_int_eq(libevdev_device_set_query(set, no_codes, 1, NULL, 0, NULL, 0), -EINVAL);
+	ck_assert_int_eq(libevdev_device_set_query(set, NULL, 0, bad_prop, 1, NULL, 0), -EINVAL);
+	ck_assert_int_eq(libevdev_device_set_query(set, NULL, 0, NULL, 0, NULL, 0), 0);
+
+	ck_assert_int_eq(libevdev_device_set_remove(set, dev), -ENOENT);
+	ck_assert_int_eq(libevdev_device_set_update(set, dev), -ENOENT);
+	ck_assert_int_eq(libevdev_device_set_add(set, dev), 0);
+	ck_assert_int_eq(libevdev_device_set_add(set, dev), -EEXIST);
+	ck_assert_int_eq(libevdev_device_set_get_num_devices(set), 1);
+
+	libevdev_device_set_free(set);
+	libevdev_device_set_free(NULL);
+	libevdev_free(dev);
+}
+END_TEST
+
+START_TEST(test_device_set_query)
+{
+	struct libevdev_device_set *set;
+	struct libevdev *touchscreen, *touchpad, *keyboard, *matches[4];
+	const unsigned int mt[] = { EV_ABS, ABS_MT_POSITION_X };
+	const unsigned int key[] = { EV_KEY, LIBEVDEV_DEVICE_SET_ANY_CODE };
+	const unsigned int syn[] = { EV_SYN, SYN_REPORT };
+	const unsigned int mt_and_key[] = { EV_ABS, ABS_MT_POSITION_X,
+					    EV_KEY, KEY_A };
+	const unsigned int direct[] = { INPUT_PROP_DIRECT };
+
+	touchscreen = new_device(EV_ABS, ABS_MT_POSITION_X, INPUT_PROP_DIRECT);
+	touchpad = new_device(EV_ABS, ABS_MT_POSITION_X, INPUT_PROP_POINTER);
+	keyboard = new_device(EV_KEY, KEY_A, -1);
+
+	ck_assert_int_eq(libevdev_device_set_new(&set), 0);
+	ck_assert_int_eq(libevdev_device_set_add(set, touchscreen), 0);
+	ck_assert_int_eq(libevdev_device_set_add(set, touchpad), 0);
+	ck_assert_int_eq(libevdev_device_set_add(set, keyboard), 0);
+	ck_assert_int_eq(libevdev_device_set_get_num_devices(set), 3);
+
+	ck_assert_int_eq(libevdev_device_set_query(set, NULL, 0, NULL, 0, NULL, 0), 3);
+	ck_assert_int_eq(libevdev_device_set_query(set, syn, 1, NULL, 0, NULL, 0), 3);
+	ck_assert_int_eq(libevdev_device_set_query(set, mt, 1, NULL, 0, NULL, 0), 2);
+	ck_assert_int_eq(libevdev_device_set_query(set, mt_and_key, 2, NULL, 0, NULL, 0), 0);
+
+	ck_assert_int_eq(libevdev_device_set_query(set, mt, 1, direct, 1, matches, 4), 1);
+	ck_assert(matches[0] == touchscreen);
+
+	ck_assert_int_eq(libevdev_device_set_query(set, key, 1, NULL, 0, matches, 4), 1);
+	ck_assert(matches[0] == keyboard);
+
+	/* more matches than space */
+	matches[1] = NULL;
+	ck_assert_int_eq(libevdev_device_set_query(set, mt, 1, NULL, 0, matches, 1), 2);
+	ck_assert(matches[0] == touchscreen || matches[0] == touchpad);
+	ck_assert(matches[1] == NULL);
+
+	libevdev_device_set_free(set);
+	libevdev_free(touchscreen);
+	libevdev_free(touchpad);
+	libevdev_free(keyboard);
+}
+END_TEST
+
+START_TEST(test_device_set_update)
+{
+	struct libevdev_device_set *set;
+	struct libevdev *dev, *other, *matches[2];
+	const unsigned int key[] = { EV_KEY, KEY_A };
+	const unsigned int direct[] = { INPUT_PROP_DIRECT };
+
+	dev = new_device(EV_ABS, ABS_X, -1);
+	other = new_device(EV_KEY, KEY_B, -1);
+
+	ck_assert_int_eq(libevdev_device_set_new(&set), 0);
+	ck_assert_int_eq(libevdev_device_set_add(set, dev), 0);
+	ck_assert_int_eq(libevdev_device_set_query(set, key, 1, NULL, 0, NULL, 0), 0);
+
+	/* not re-indexed until updated */
+	libevdev_enable_event_code(dev, EV_KEY, KEY_A, NULL);
+	libevdev_enable_property(dev, INPUT_PROP_DIRECT);
+	ck_assert_int_eq(libevdev_device_set_query(set, key, 1, NULL, 0, NULL, 0), 0);
+	ck_assert_int_eq(libevdev_device_set_update(set, dev), 0);
+	ck_assert_int_eq(libevdev_device_set_query(set, key, 1, direct, 1, matches, 2), 1);
+	ck_assert(matches[0] == dev);
+
+	libevdev_disable_event_type(dev, EV_KEY);
+	ck_assert_int_eq(libevdev_device_set_update(set, dev), 0);
+	ck_assert_int_eq(libevdev_device_set_query(set, key, 1, NULL, 0, NULL, 0), 0);
+	ck_assert_int_eq(libevdev_device_set_query(set, NULL, 0, direct, 1, NULL, 0), 1);
+
+	/* the removed device's column is reused, its bits must not leak */
+	ck_assert_int_eq(libevdev_device_set_remove(set, dev), 0);
+	ck_assert_int_eq(libevdev_device_set_query(set, NULL, 0, direct, 1, NULL, 0), 0);
+	ck_assert_int_eq(libevdev_device_set_add(set, other), 0);
+	ck_assert_int_eq(libevdev_device_set_query(set, NULL, 0, direct, 1, NULL, 0), 0);
+	ck_assert_int_eq(libevdev_device_set_query(set, NULL, 0, NULL, 0, matches, 2), 1);
+	ck_assert(matches[0] == other);
+
+	libevdev_device_set_free(set);
+	libevdev_free(dev);
+	libevdev_free(other);
+}
+END_TEST
+
+START_TEST(test_device_set_many)
+{
+	struct libevdev_device_set *set;
+	struct libevdev *devices[1100];
+	const unsigned int rel[] = { EV_REL, REL_X };
+	const unsigned int abs[] = { EV_ABS, ABS_X };
+	size_t i;
+
+	ck_assert_int_eq(libevdev_device_set_new(&set), 0);
+
+	for (i = 0; i < sizeof(devices)/sizeof(devices[0]); i++) {
+		if (i % 3 == 0)
+			devices[i] = new_device(EV_REL, REL_X, -1);
+		else
+			devices[i] = new_device(EV_ABS, ABS_X, -1);
+		ck_assert_int_eq(libevdev_device_set_add(set, devices[i]), 0);
+	}
+
+	ck_assert_int_eq(libevdev_device_set_get_num_devices(set), 1100);
+	ck_assert_int_eq(libevdev_device_set_query(set, rel, 1, NULL, 0, NULL, 0), 367);
+	ck_assert_int_eq(libevdev_device_set_query(set, abs, 1, NULL, 0, NULL, 0), 733);
+
+	for (i = 0; i < sizeof(devices)/sizeof(devices[0]); i += 2)
+		ck_assert_int_eq(libevdev_device_set_remove(set, devices[i]), 0);
+
+	ck_assert_int_eq(libevdev_device_set_get_num_devices(set), 550);
+	ck_assert_int_eq(libevdev_device_set_query(set, rel, 1, NULL, 0, NULL, 0), 183);
+	ck_assert_int_eq(libevdev_device_set_query(set, abs, 1, NULL, 0, NULL, 0), 367);
+
+	libevdev_device_set_free(set);
+	for (i = 0; i < sizeof(devices)/sizeof(devices[0]); i++)
+		libevdev_free(devices[i]);
+}
+END_TEST
+
+Suite *
+device_set_suite(void)
+{
+	Suite *s = suite_create("libevdev device set tests");
+
+	TCase *tc = tcase_create("device set");
+	tcase_add_test(tc, test_device_set_invalid);
+	tcase_add_test(tc, test_device_set_query);
+	tcase_add_test(tc, test_device_set_update);
+	tcase_add_test(tc, test_device_set_many);
+	suite_add_tcase(s, tc);
+
+	return s;
+}
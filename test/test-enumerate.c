@@ -0,0 +1,261 @@
+/*
+ * Copyright © 2026 The libevdev contributors
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and its
+ * documentation for any purpose is hereby granted without fee, provided that
+ * the above copyright notice appear in all copies and that both that copyright
+ * notice and this permission notice appear in supporting documentation, and
+ * that the name of the copyright holders not be used in advertising or
+ * publicity pertaining to distribution of the software without specific,
+ * written prior permission.  The copyright holders make no representations
+ * about the suitability of this software for any purpose.  It is provided "as
+ * is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN NO
+ * EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE,
+ * DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+ * TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE
+ * OF THIS SOFTWARE.
+ */
+
+#include <config.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <libevdev/libevdev-enumerate.h>
+#include <libevdev/libevdev-uinput.h>
+
+#include "test-common.h"
+
+START_TEST(test_enumerate_invalid)
+{
+	struct libevdev_enumerate *e;
+
+	ck_assert_int_eq(libevdev_enumerate_new(&e), 0);
+	ck_assert_int_eq(libevdev_enumerate_get_fd(e), -1);
+
+	ck_assert_int_eq(libevdev_enumerate_require_event_type(e, EV_MAX + 1), -EINVAL);
+	ck_assert_int_eq(libevdev_enumerate_require_event_code(e, EV_ABS, ABS_MAX + 1), -EINVAL);
+	ck_assert_int_eq(libevdev_enumerate_require_event_code(e, EV_SYN, SYN_REPORT), -EINVAL);
+	ck_assert_int_eq(libevdev_enumerate_require_event_code(e, EV_REP, REP_DELAY), -EINVAL);
+	ck_assert_int_eq(libevdev_enumerate_require_property(e, INPUT_PROP_MAX + 1), -EINVAL);
+
+	ck_assert_int_eq(libevdev_enumerate_require_event_type(e, EV_KEY), 0);
+	ck_assert_int_eq(libevdev_enumerate_require_event_code(e, EV_ABS, ABS_X), 0);
+	ck_assert_int_eq(libevdev_enumerate_require_property(e, INPUT_PROP_DIRECT), 0);
+
+	libevdev_enumerate_free(e);
+	libevdev_enumerate_free(NULL);
+}
+END_TEST
+
+START_TEST(test_enumerate_directory)
+{
+	struct libevdev_enumerate *e;
+	struct libevdev *dev;
+	const char *devnode;
+	char dir[] = "/tmp/libevdev-test-XXXXXX";
+	char path[64];
+	int fd;
+
+	ck_assert(mkdtemp(dir) != NULL);
+
+	ck_assert_int_eq(libevdev_enumerate_new(&e), 0);
+	ck_assert_int_eq(libevdev_enumerate_set_directory(e, dir), 0);
+	ck_assert_int_eq(libevdev_enumerate_scan(e), 0);
+	ck_assert_int_gt(libevdev_enumerate_get_fd(e), -1);
+
+	libevdev_set_log_function(test_logfunc_ignore_error, NULL);
+	ck_assert_int_eq(libevdev_enumerate_set_directory(e, "/dev/input"), -EINVAL);
+	libevdev_set_log_function(test_logfunc_abort_on_error, NULL);
+
+	ck_assert_int_eq(libevdev_enumerate_next(e, &dev, &devnode), -EAGAIN);
+
+	/* not evdev nodes, they must be skipped */
+	snprintf(path, sizeof(path), "%s/event0", dir);
+	fd = open(path, O_CREAT|O_WRONLY, 0600);
+	ck_assert_int_gt(fd, -1);
+	close(fd);
+	ck_assert_int_eq(libevdev_enumerate_next(e, &dev, &devnode), -EAGAIN);
+	ck_assert(dev == NULL);
+	ck_assert(devnode == NULL);
+	unlink(path);
+
+	snprintf(path, sizeof(path), "%s/mouse0", dir);
+	fd = open(path, O_CREAT|O_WRONLY, 0600);
+	ck_assert_int_gt(fd, -1);
+	close(fd);
+	ck_assert_int_eq(libevdev_enumerate_next(e, &dev, &devnode), -EAGAIN);
+	unlink(path);
+
+	ck_assert_int_eq(libevdev_enumerate_next(e, &dev, &devnode), -EAGAIN);
+
+	libevdev_enumerate_free(e);
+	rmdir(dir);
+}
+END_TEST
+
+static struct libevdev_uinput *
+create_mouse(void)
+{
+	struct libevdev *dev;
+	struct libevdev_uinput *uidev;
+	int rc;
+
+	dev = libevdev_new();
+	libevdev_set_name(dev, TEST_DEVICE_NAME);
+	libevdev_enable_event_code(dev, EV_REL, REL_X, NULL);
+	libevdev_enable_event_code(dev, EV_REL, REL_Y, NULL);
+	libevdev_enable_event_code(dev, EV_KEY, BTN_LEFT, NULL);
+	libevdev_enable_property(dev, INPUT_PROP_POINTER);
+
+	rc = libevdev_uinput_create_from_device(dev, LIBEVDEV_UINPUT_OPEN_MANAGED, &uidev);
+	ck_assert_msg(rc == 0, "Failed to create uinput device: %s", strerror(-rc));
+	libevdev_free(dev);
+
+	return uidev;
+}
+
+/**
+ * @return true if our test device was returned as added
+ */
+static bool
+find_test_device(struct libevdev_enumerate *e, const char *expected_devnode)
+{
+	struct libevdev *dev;
+	const char *devnode;
+	bool found = false;
+	int rc;
+
+	while ((rc = libevdev_enumerate_next(e, &dev, &devnode)) > 0) {
+		if (rc != LIBEVDEV_ENUMERATE_DEVICE_ADDED)
+			continue;
+
+		ck_assert(dev != NULL);
+		ck_assert(libevdev_has_event_code(dev, EV_REL, REL_X));
+		if (strcmp(devnode, expected_devnode) == 0) {
+			ck_assert_str_eq(libevdev_get_name(dev), TEST_DEVICE_NAME);
+			found = true;
+		}
+		close(libevdev_get_fd(dev));
+		libevdev_free(dev);
+	}
+	ck_assert_int_eq(rc, -EAGAIN);
+
+	return found;
+}
+
+START_TEST(test_enumerate_scan)
+{
+	struct libevdev_uinput *uidev;
+	struct libevdev_enumerate *e, *e2;
+	struct libevdev *dev;
+	const char *devnode, *removed;
+	char *expected;
+	int rc;
+
+	uidev = create_mouse();
+	devnode = libevdev_uinput_get_devnode(uidev);
+	ck_assert(devnode != NULL);
+	expected = strdup(devnode);
+
+	ck_assert_int_eq(libevdev_enumerate_new(&e), 0);
+	libevdev_enumerate_require_event_code(e, EV_REL, REL_X);
+	libevdev_enumerate_require_property(e, INPUT_PROP_POINTER);
+	ck_assert_int_eq(libevdev_enumerate_scan(e), 0);
+	ck_assert(find_test_device(e, devnode));
+
+	/* a rescan doesn't return it again */
+	ck_assert_int_eq(libevdev_enumerate_scan(e), 0);
+	ck_assert(!find_test_device(e, devnode));
+
+	ck_assert_int_eq(libevdev_enumerate_new(&e2), 0);
+	libevdev_enumerate_require_event_code(e2, EV_REL, REL_X);
+	libevdev_enumerate_require_event_code(e2, EV_ABS, ABS_MT_POSITION_X);
+	ck_assert_int_eq(libevdev_enumerate_scan(e2), 0);
+	ck_assert(!find_test_device(e2, devnode));
+	libevdev_enumerate_free(e2);
+
+	libevdev_uinput_destroy(uidev);
+
+	/* a rescan returns it as removed, whether or not the inotify
+	   event was seen */
+	ck_assert_int_eq(libevdev_enumerate_scan(e), 0);
+	do {
+		rc = libevdev_enumerate_next(e, &dev, &removed);
+	} while (rc == LIBEVDEV_ENUMERATE_DEVICE_REMOVED &&
+		 strcmp(removed, expected) != 0);
+	ck_assert_int_eq(rc, LIBEVDEV_ENUMERATE_DEVICE_REMOVED);
+	ck_assert(dev == NULL);
+
+	free(expected);
+	libevdev_enumerate_free(e);
+}
+END_TEST
+
+START_TEST(test_enumerate_hotplug)
+{
+	struct libevdev_uinput *uidev;
+	struct libevdev_enumerate *e;
+	struct libevdev *dev;
+	const char *devnode;
+	char *expected;
+	struct pollfd fds;
+	int rc;
+
+	ck_assert_int_eq(libevdev_enumerate_new(&e), 0);
+	libevdev_enumerate_require_event_code(e, EV_REL, REL_X);
+	ck_assert_int_eq(libevdev_enumerate_scan(e), 0);
+	find_test_device(e, "");
+
+	uidev = create_mouse();
+	devnode = libevdev_uinput_get_devnode(uidev);
+	ck_assert(devnode != NULL);
+	expected = strdup(devnode);
+
+	fds.fd = libevdev_enumerate_get_fd(e);
+	fds.events = POLLIN;
+	ck_assert_int_eq(poll(&fds, 1, 1000), 1);
+
+	/* udev may not have set the permissions yet, retry on IN_ATTRIB */
+	while (!find_test_device(e, expected))
+		ck_assert_int_eq(poll(&fds, 1, 1000), 1);
+
+	libevdev_uinput_destroy(uidev);
+
+	do {
+		ck_assert_int_eq(poll(&fds, 1, 1000), 1);
+		rc = libevdev_enumerate_next(e, &dev, &devnode);
+	} while (rc == -EAGAIN);
+	ck_assert_int_eq(rc, LIBEVDEV_ENUMERATE_DEVICE_REMOVED);
+	ck_assert(dev == NULL);
+	ck_assert_str_eq(devnode, expected);
+
+	free(expected);
+	libevdev_enumerate_free(e);
+}
+END_TEST
+
+Suite *
+enumerate_suite(void)
+{
+	Suite *s = suite_create("libevdev enumerate tests");
+
+	TCase *tc = tcase_create("enumerate setup");
+	tcase_add_test(tc, test_enumerate_invalid);
+	tcase_add_test(tc, test_enumerate_directory);
+	suite_add_tcase(s, tc);
+
+	tc = tcase_create("enumerate devices");
+	tcase_add_test(tc, test_enumerate_scan);
+	tcase_add_test(tc, test_enumerate_hotplug);
+	suite_add_tcase(s, tc);
+
+	return s;
+}
@@ -99,6 +99,43 @@ START_TEST(test_key_invalid)
 }
 END_TEST
 
+START_TEST(test_names_round_trip)
+{
+	unsigned int type, name_type, code, prop;
+	const char *name;
+
+	for (type = 0; type <= EV_MAX; type++) {
+		int max = libevdev_event_type_get_max(type);
+
+		name = libevdev_event_type_get_name(type);
+		if (name)
+			ck_assert_int_eq(libevdev_event_type_from_name(name), type);
+
+		for (code = 0; max != -1 && code <= (unsigned int)max; code++) {
+			name = libevdev_event_code_get_name(type, code);
+			if (!name)
+				continue;
+
+			/* the FF_STATUS_ names share the FF_ map but are
+			   EV_FF_STATUS codes */
+			name_type = type;
+			if (type == EV_FF && strncmp(name, "FF_STATUS_", 10) == 0)
+				name_type = EV_FF_STATUS;
+
+			ck_assert_int_eq(libevdev_event_code_from_name(name_type, name), code);
+			ck_assert_int_eq(libevdev_event_type_from_name(name), -1);
+			ck_assert_int_eq(libevdev_property_from_name(name), -1);
+		}
+	}
+
+	for (prop = 0; prop <= INPUT_PROP_MAX; prop++) {
+		name = libevdev_property_get_name(prop);
+		if (name)
+			ck_assert_int_eq(libevdev_property_from_name(name), prop);
+	}
+}
+END_TEST
+
 START_TEST(test_properties)
 {
 	struct prop {
@@ -144,6 +181,7 @@ event_code_suite(void)
 	tc = tcase_create("key tests");
 	tcase_add_test(tc, test_key_codes);
 	tcase_add_test(tc, test_key_invalid);
+	tcase_add_test(tc, test_names_round_trip);
 	suite_add_tcase(s, tc);
 
 	tc = tcase_create("property tests");
@@ -21,6 +21,7 @@
  */
 
 #include <config.h>
+#include <errno.h>
 #include "test-common.h"
 
 START_TEST(test_limits)
@@ -271,6 +272,82 @@ START_TEST(test_event_code)
 }
 END_TEST
 
+static void
+set_event(struct input_event *ev, long sec, long usec,
+	  unsigned int type, unsigned int code, int value)
+{
+	ev->input_event_sec = sec;
+	ev->input_event_usec = usec;
+	ev->type = type;
+	ev->code = code;
+	ev->value = value;
+}
+
+START_TEST(test_event_format)
+{
+	struct input_event ev;
+	char buf[128];
+
+	set_event(&ev, 1387781040, 123, EV_ABS, ABS_X, 100);
+	ck_assert_int_eq(libevdev_event_format(&ev, buf, sizeof(buf)), 35);
+	ck_assert_str_eq(buf, "1387781040.000123 EV_ABS ABS_X 100\n");
+
+	set_event(&ev, 0, 999999, EV_KEY, BTN_LEFT, 0);
+	libevdev_event_format(&ev, buf, sizeof(buf));
+	ck_assert_str_eq(buf, "0.999999 EV_KEY BTN_LEFT 0\n");
+
+	set_event(&ev, 5, 0, EV_REL, REL_WHEEL, -2147483647 - 1);
+	libevdev_event_format(&ev, buf, sizeof(buf));
+	ck_assert_str_eq(buf, "5.000000 EV_REL REL_WHEEL -2147483648\n");
+
+	/* no names */
+	set_event(&ev, 1, 1, EV_MAX + 1, 7, 1);
+	libevdev_event_format(&ev, buf, sizeof(buf));
+	ck_assert_str_eq(buf, "1.000001 32 7 1\n");
+	set_event(&ev, 1, 1, EV_ABS, ABS_MAX + 1, 1);
+	libevdev_event_format(&ev, buf, sizeof(buf));
+	ck_assert_str_eq(buf, "1.000001 EV_ABS 64 1\n");
+
+	/* exactly fits, one byte short */
+	set_event(&ev, 1, 0, EV_SYN, SYN_REPORT, 0);
+	ck_assert_int_eq(libevdev_event_format(&ev, buf, 30), 29);
+	ck_assert_str_eq(buf, "1.000000 EV_SYN SYN_REPORT 0\n");
+	ck_assert_int_eq(libevdev_event_format(&ev, buf, 29), -ENOSPC);
+	ck_assert_int_eq(libevdev_event_format(&ev, buf, 0), -ENOSPC);
+}
+END_TEST
+
+START_TEST(test_events_format)
+{
+	struct input_event ev[3];
+	char buf[4096];
+	size_t len;
+
+	set_event(&ev[0], 1, 0, EV_ABS, ABS_X, 1);
+	set_event(&ev[1], 1, 0, EV_ABS, ABS_Y, 2);
+	set_event(&ev[2], 1, 0, EV_SYN, SYN_REPORT, 0);
+
+	ck_assert_int_eq(libevdev_events_format(ev, 3, buf, sizeof(buf), &len), 3);
+	ck_assert_str_eq(buf,
+			 "1.000000 EV_ABS ABS_X 1\n"
+			 "1.000000 EV_ABS ABS_Y 2\n"
+			 "1.000000 EV_SYN SYN_REPORT 0\n");
+	ck_assert_int_eq(len, strlen(buf));
+
+	/* room for two lines only */
+	ck_assert_int_eq(libevdev_events_format(ev, 3, buf, 60, &len), 2);
+	ck_assert_str_eq(buf,
+			 "1.000000 EV_ABS ABS_X 1\n"
+			 "1.000000 EV_ABS ABS_Y 2\n");
+	ck_assert_int_eq(len, 48);
+
+	ck_assert_int_eq(libevdev_events_format(ev, 3, buf, 1, &len), 0);
+	ck_assert_str_eq(buf, "");
+	ck_assert_int_eq(len, 0);
+	ck_assert_int_eq(libevdev_events_format(ev, 0, buf, sizeof(buf), NULL), 0);
+}
+END_TEST
+
 Suite *
 event_name_suite(void)
 {
@@ -307,5 +384,10 @@ event_name_suite(void)
 	tcase_add_test(tc, test_event_code);
 	suite_add_tcase(s, tc);
 
+	tc = tcase_create("event formatting");
+	tcase_add_test(tc, test_event_format);
+	tcase_add_test(tc, test_events_format);
+	suite_add_tcase(s, tc);
+
 	return s;
 }
@@ -27,7 +27,7 @@
 
 START_TEST(test_queue_alloc)
 {
-	struct libevdev dev;
+	struct libevdev dev = {0};
 	int rc;
 
 	rc = queue_alloc(&dev, 0);
@@ -1601,6 +1601,13 @@ START_TEST(test_mt_event_values)
 	ck_assert_int_eq(libevdev_fetch_slot_value(dev, 1, ABS_MT_POSITION_Y, &value), 1);
 	ck_assert_int_eq(value, 5);
 
+	/* MT axes report the value of the current slot */
+	ck_assert_int_eq(libevdev_get_event_value(dev, EV_ABS, ABS_MT_POSITION_X), 1);
+	ck_assert_int_eq(libevdev_get_abs_info(dev, ABS_MT_POSITION_Y)->value, 5);
+	ck_assert_int_eq(libevdev_set_slot_value(dev, 0, ABS_MT_SLOT, 0), 0);
+	ck_assert_int_eq(libevdev_get_event_value(dev, EV_ABS, ABS_MT_POSITION_X), 100);
+	ck_assert_int_eq(libevdev_get_abs_info(dev, ABS_MT_POSITION_Y)->value, 500);
+
 	uinput_device_free(uidev);
 	libevdev_free(dev);
 
@@ -1647,6 +1654,358 @@ START_TEST(test_mt_event_values_invalid)
 }
 END_TEST
 
+START_TEST(test_mt_event_bulk_values)
+{
+	struct uinput_device* uidev;
+	struct libevdev *dev;
+	int rc;
+	struct input_event ev;
+	struct input_absinfo abs[3];
+	int values[4] = { 0xab, 0xab, 0xab, 0xab };
+	const int *ptr;
+
+	memset(abs, 0, sizeof(abs));
+	abs[0].value = ABS_MT_POSITION_X;
+	abs[0].maximum = 1000;
+	abs[1].value = ABS_MT_POSITION_Y;
+	abs[1].maximum = 1000;
+	abs[2].value = ABS_MT_SLOT;
+	abs[2].maximum = 2;
+
+	test_create_abs_device(&uidev, &dev,
+			       3, abs,
+			       EV_SYN, SYN_REPORT,
+			       -1);
+
+	uinput_device_event(uidev, EV_ABS, ABS_MT_SLOT, 0);
+	uinput_device_event(uidev, EV_ABS, ABS_MT_POSITION_X, 100);
+	uinput_device_event(uidev, EV_ABS, ABS_MT_POSITION_Y, 500);
+	uinput_device_event(uidev, EV_ABS, ABS_MT_SLOT, 2);
+	uinput_device_event(uidev, EV_ABS, ABS_MT_POSITION_X, 1);
+	uinput_device_event(uidev, EV_ABS, ABS_MT_POSITION_Y, 5);
+	uinput_device_event(uidev, EV_SYN, SYN_REPORT, 0);
+
+	do {
+		rc = libevdev_next_event(dev, LIBEVDEV_READ_FLAG_NORMAL, &ev);
+	} while (rc == LIBEVDEV_READ_STATUS_SUCCESS);
+	ck_assert_int_eq(rc, -EAGAIN);
+
+	ck_assert_int_eq(libevdev_get_slot_values(dev, ABS_MT_POSITION_X, values, 4), 3);
+	ck_assert_int_eq(values[0], 100);
+	ck_assert_int_eq(values[1], 0);
+	ck_assert_int_eq(values[2], 1);
+	ck_assert_int_eq(values[3], 0xab);
+
+	ck_assert_int_eq(libevdev_get_slot_values(dev, ABS_MT_POSITION_Y, values, 2), 2);
+	ck_assert_int_eq(values[0], 500);
+	ck_assert_int_eq(values[1], 0);
+	ck_assert_int_eq(values[2], 1);
+
+	ptr = libevdev_get_slot_values_ptr(dev, ABS_MT_POSITION_Y);
+	ck_assert(ptr != NULL);
+	ck_assert_int_eq(ptr[0], 500);
+	ck_assert_int_eq(ptr[1], 0);
+	ck_assert_int_eq(ptr[2], 5);
+
+	/* the pointer follows updates */
+	ck_assert_int_eq(libevdev_set_slot_value(dev, 1, ABS_MT_POSITION_Y, 7), 0);
+	ck_assert_int_eq(ptr[1], 7);
+
+	ck_assert_int_eq(libevdev_get_slot_values(dev, ABS_MT_TOUCH_MINOR, values, 4), -EINVAL);
+	ck_assert_int_eq(libevdev_get_slot_values(dev, ABS_X, values, 4), -EINVAL);
+	ck_assert(libevdev_get_slot_values_ptr(dev, ABS_MT_TOUCH_MINOR) == NULL);
+	ck_assert(libevdev_get_slot_values_ptr(dev, ABS_X) == NULL);
+
+	uinput_device_free(uidev);
+	libevdev_free(dev);
+}
+END_TEST
+
+START_TEST(test_mt_active_slots)
+{
+	struct uinput_device* uidev;
+	struct libevdev *dev;
+	int rc;
+	struct input_event ev;
+	struct input_absinfo abs[3];
+
+	memset(abs, 0, sizeof(abs));
+	abs[0].value = ABS_MT_POSITION_X;
+	abs[0].maximum = 1000;
+	abs[1].value = ABS_MT_TRACKING_ID;
+	abs[1].maximum = 0xffff;
+	abs[2].value = ABS_MT_SLOT;
+	abs[2].maximum = 4;
+
+	test_create_abs_device(&uidev, &dev,
+			       3, abs,
+			       EV_SYN, SYN_REPORT,
+			       -1);
+
+	ck_assert_int_eq(libevdev_get_num_active_slots(dev), 0);
+	ck_assert_int_eq(libevdev_next_active_slot(dev, -1), -1);
+
+	uinput_device_event(uidev, EV_ABS, ABS_MT_SLOT, 1);
+	uinput_device_event(uidev, EV_ABS, ABS_MT_TRACKING_ID, 1);
+	uinput_device_event(uidev, EV_ABS, ABS_MT_SLOT, 4);
+	uinput_device_event(uidev, EV_ABS, ABS_MT_TRACKING_ID, 2);
+	uinput_device_event(uidev, EV_SYN, SYN_REPORT, 0);
+
+	do {
+		rc = libevdev_next_event(dev, LIBEVDEV_READ_FLAG_NORMAL, &ev);
+	} while (rc == LIBEVDEV_READ_STATUS_SUCCESS);
+	ck_assert_int_eq(rc, -EAGAIN);
+
+	ck_assert_int_eq(libevdev_get_num_active_slots(dev), 2);
+	ck_assert_int_eq(libevdev_next_active_slot(dev, -1), 1);
+	ck_assert_int_eq(libevdev_next_active_slot(dev, 1), 4);
+	ck_assert_int_eq(libevdev_next_active_slot(dev, 4), -1);
+
+	uinput_device_event(uidev, EV_ABS, ABS_MT_SLOT, 1);
+	uinput_device_event(uidev, EV_ABS, ABS_MT_TRACKING_ID, -1);
+	uinput_device_event(uidev, EV_SYN, SYN_REPORT, 0);
+
+	do {
+		rc = libevdev_next_event(dev, LIBEVDEV_READ_FLAG_NORMAL, &ev);
+	} while (rc == LIBEVDEV_READ_STATUS_SUCCESS);
+	ck_assert_int_eq(rc, -EAGAIN);
+
+	ck_assert_int_eq(libevdev_get_num_active_slots(dev), 1);
+	ck_assert_int_eq(libevdev_next_active_slot(dev, -1), 4);
+
+	ck_assert_int_eq(libevdev_set_slot_value(dev, 0, ABS_MT_TRACKING_ID, 3), 0);
+	ck_assert_int_eq(libevdev_get_num_active_slots(dev), 2);
+	ck_assert_int_eq(libevdev_next_active_slot(dev, -1), 0);
+
+	uinput_device_free(uidev);
+	libevdev_free(dev);
+}
+END_TEST
+
+START_TEST(test_mt_changed_slots)
+{
+	struct uinput_device* uidev;
+	struct libevdev *dev;
+	int rc;
+	struct input_event ev;
+	struct input_absinfo abs[3];
+
+	memset(abs, 0, sizeof(abs));
+	abs[0].value = ABS_MT_POSITION_X;
+	abs[0].maximum = 1000;
+	abs[1].value = ABS_MT_POSITION_Y;
+	abs[1].maximum = 1000;
+	abs[2].value = ABS_MT_SLOT;
+	abs[2].maximum = 4;
+
+	test_create_abs_device(&uidev, &dev,
+			       3, abs,
+			       EV_SYN, SYN_REPORT,
+			       -1);
+
+	ck_assert_int_eq(libevdev_next_changed_slot(dev, -1), -1);
+
+	uinput_device_event(uidev, EV_ABS, ABS_MT_SLOT, 1);
+	uinput_device_event(uidev, EV_ABS, ABS_MT_POSITION_X, 100);
+	uinput_device_event(uidev, EV_ABS, ABS_MT_SLOT, 3);
+	uinput_device_event(uidev, EV_ABS, ABS_MT_POSITION_Y, 200);
+	uinput_device_event(uidev, EV_SYN, SYN_REPORT, 0);
+
+	/* not visible until the SYN_REPORT was processed */
+	do {
+		rc = libevdev_next_event(dev, LIBEVDEV_READ_FLAG_NORMAL, &ev);
+		ck_assert_int_eq(rc, LIBEVDEV_READ_STATUS_SUCCESS);
+		if (ev.type != EV_SYN)
+			ck_assert_int_eq(libevdev_next_changed_slot(dev, -1), -1);
+	} while (ev.type != EV_SYN);
+
+	ck_assert_int_eq(libevdev_next_changed_slot(dev, -1), 1);
+	ck_assert_int_eq(libevdev_next_changed_slot(dev, 1), 3);
+	ck_assert_int_eq(libevdev_next_changed_slot(dev, 3), -1);
+	ck_assert_int_eq(libevdev_slot_value_changed(dev, 1, ABS_MT_SLOT), 1);
+	ck_assert_int_eq(libevdev_slot_value_changed(dev, 1, ABS_MT_POSITION_X), 1);
+	ck_assert_int_eq(libevdev_slot_value_changed(dev, 1, ABS_MT_POSITION_Y), 0);
+	ck_assert_int_eq(libevdev_slot_value_changed(dev, 3, ABS_MT_POSITION_X), 0);
+	ck_assert_int_eq(libevdev_slot_value_changed(dev, 3, ABS_MT_POSITION_Y), 1);
+	ck_assert_int_eq(libevdev_slot_value_changed(dev, 2, ABS_MT_SLOT), 0);
+	ck_assert_int_eq(libevdev_slot_value_changed(dev, 10, ABS_MT_SLOT), 0);
+	ck_assert_int_eq(libevdev_slot_value_changed(dev, 1, ABS_X), 0);
+
+	uinput_device_event(uidev, EV_ABS, ABS_MT_POSITION_X, 300);
+	uinput_device_event(uidev, EV_SYN, SYN_REPORT, 0);
+
+	do {
+		rc = libevdev_next_event(dev, LIBEVDEV_READ_FLAG_NORMAL, &ev);
+	} while (rc == LIBEVDEV_READ_STATUS_SUCCESS);
+	ck_assert_int_eq(rc, -EAGAIN);
+
+	ck_assert_int_eq(libevdev_next_changed_slot(dev, -1), 3);
+	ck_assert_int_eq(libevdev_next_changed_slot(dev, 3), -1);
+	ck_assert_int_eq(libevdev_slot_value_changed(dev, 3, ABS_MT_POSITION_X), 1);
+	ck_assert_int_eq(libevdev_slot_value_changed(dev, 3, ABS_MT_POSITION_Y), 0);
+
+	uinput_device_free(uidev);
+	libevdev_free(dev);
+}
+END_TEST
+
+START_TEST(test_mt_touch_history)
+{
+	struct uinput_device* uidev;
+	struct libevdev *dev;
+	int rc;
+	struct input_event ev, last;
+	struct input_absinfo abs[4];
+	const struct libevdev_touch_frame *frame;
+
+	memset(abs, 0, sizeof(abs));
+	abs[0].value = ABS_MT_POSITION_X;
+	abs[0].maximum = 1000;
+	abs[1].value = ABS_MT_POSITION_Y;
+	abs[1].maximum = 1000;
+	abs[2].value = ABS_MT_TRACKING_ID;
+	abs[2].maximum = 0xffff;
+	abs[3].value = ABS_MT_SLOT;
+	abs[3].maximum = 4;
+
+	test_create_abs_device(&uidev, &dev,
+			       4, abs,
+			       EV_SYN, SYN_REPORT,
+			       -1);
+
+	ck_assert_int_eq(libevdev_get_num_touch_frames(dev), 0);
+	ck_assert_int_eq(libevdev_enable_touch_history(dev, 2), 0);
+	ck_assert(libevdev_get_touch_frame(dev, 0) == NULL);
+
+	uinput_device_event(uidev, EV_ABS, ABS_MT_SLOT, 1);
+	uinput_device_event(uidev, EV_ABS, ABS_MT_TRACKING_ID, 10);
+	uinput_device_event(uidev, EV_ABS, ABS_MT_POSITION_X, 100);
+	uinput_device_event(uidev, EV_ABS, ABS_MT_POSITION_Y, 200);
+	uinput_device_event(uidev, EV_SYN, SYN_REPORT, 0);
+	uinput_device_event(uidev, EV_ABS, ABS_MT_SLOT, 3);
+	uinput_device_event(uidev, EV_ABS, ABS_MT_TRACKING_ID, 11);
+	uinput_device_event(uidev, EV_ABS, ABS_MT_POSITION_X, 300);
+	uinput_device_event(uidev, EV_SYN, SYN_REPORT, 0);
+	uinput_device_event(uidev, EV_ABS, ABS_MT_SLOT, 1);
+	uinput_device_event(uidev, EV_ABS, ABS_MT_TRACKING_ID, -1);
+	uinput_device_event(uidev, EV_SYN, SYN_REPORT, 0);
+
+	while ((rc = libevdev_next_event(dev, LIBEVDEV_READ_FLAG_NORMAL, &ev)) == LIBEVDEV_READ_STATUS_SUCCESS)
+		last = ev;
+	ck_assert_int_eq(rc, -EAGAIN);
+	ck_assert_int_eq(last.type, EV_SYN);
+
+	/* three frames, the first one was overwritten */
+	ck_assert_int_eq(libevdev_get_num_touch_frames(dev), 2);
+	ck_assert(libevdev_get_touch_frame(dev, 2) == NULL);
+
+	frame = libevdev_get_touch_frame(dev, 0);
+	ck_assert(frame != NULL);
+	ck_assert_int_eq(frame->ntouches, 1);
+	ck_assert_int_eq(frame->touches[0].slot, 3);
+	ck_assert_int_eq(frame->touches[0].tracking_id, 11);
+	ck_assert_int_eq(frame->touches[0].x, 300);
+	ck_assert_int_eq(frame->touches[0].pressure, 0);
+	ck_assert_int_eq(frame->time.tv_sec, last.input_event_sec);
+	ck_assert_int_eq(frame->time.tv_usec, last.input_event_usec);
+
+	frame = libevdev_get_touch_frame(dev, 1);
+	ck_assert(frame != NULL);
+	ck_assert_int_eq(frame->ntouches, 2);
+	ck_assert_int_eq(frame->touches[0].slot, 1);
+	ck_assert_int_eq(frame->touches[0].tracking_id, 10);
+	ck_assert_int_eq(frame->touches[0].x, 100);
+	ck_assert_int_eq(frame->touches[0].y, 200);
+	ck_assert_int_eq(frame->touches[1].slot, 3);
+	ck_assert_int_eq(frame->touches[1].x, 300);
+
+	ck_assert_int_eq(libevdev_enable_touch_history(dev, 0), 0);
+	ck_assert_int_eq(libevdev_get_num_touch_frames(dev), 0);
+
+	uinput_device_free(uidev);
+	libevdev_free(dev);
+}
+END_TEST
+
+START_TEST(test_mt_protocol_a_conversion)
+{
+	struct uinput_device* uidev;
+	struct libevdev *dev;
+	int rc;
+	struct input_event ev;
+	struct input_absinfo abs[2];
+	const unsigned int expected[][3] = {
+		{ EV_ABS, ABS_MT_SLOT, 0 },
+		{ EV_ABS, ABS_MT_TRACKING_ID, 0 },
+		{ EV_ABS, ABS_MT_POSITION_X, 100 },
+		{ EV_ABS, ABS_MT_POSITION_Y, 100 },
+		{ EV_ABS, ABS_MT_SLOT, 1 },
+		{ EV_ABS, ABS_MT_TRACKING_ID, 1 },
+		{ EV_ABS, ABS_MT_POSITION_X, 900 },
+		{ EV_ABS, ABS_MT_POSITION_Y, 900 },
+		{ EV_SYN, SYN_REPORT, 0 },
+		/* second frame, the second contact was lifted */
+		{ EV_ABS, ABS_MT_SLOT, 0 },
+		{ EV_ABS, ABS_MT_POSITION_X, 110 },
+		{ EV_ABS, ABS_MT_SLOT, 1 },
+		{ EV_ABS, ABS_MT_TRACKING_ID, -1 },
+		{ EV_SYN, SYN_REPORT, 0 },
+	};
+	size_t i;
+
+	memset(abs, 0, sizeof(abs));
+	abs[0].value = ABS_MT_POSITION_X;
+	abs[0].maximum = 1000;
+	abs[1].value = ABS_MT_POSITION_Y;
+	abs[1].maximum = 1000;
+
+	test_create_abs_device(&uidev, &dev,
+			       2, abs,
+			       EV_SYN, SYN_REPORT,
+			       EV_SYN, SYN_MT_REPORT,
+			       -1);
+
+	ck_assert_int_eq(libevdev_enable_mt_protocol_a_conversion(dev, 0), -EINVAL);
+	ck_assert_int_eq(libevdev_enable_mt_protocol_a_conversion(dev, 3), 0);
+	ck_assert_int_eq(libevdev_enable_mt_protocol_a_conversion(dev, 3), -EINVAL);
+	ck_assert_int_eq(libevdev_get_num_slots(dev), 3);
+	ck_assert(libevdev_has_event_code(dev, EV_ABS, ABS_MT_SLOT));
+	ck_assert(libevdev_has_event_code(dev, EV_ABS, ABS_MT_TRACKING_ID));
+	ck_assert_int_eq(libevdev_get_num_active_slots(dev), 0);
+
+	uinput_device_event(uidev, EV_ABS, ABS_MT_POSITION_X, 100);
+	uinput_device_event(uidev, EV_ABS, ABS_MT_POSITION_Y, 100);
+	uinput_device_event(uidev, EV_SYN, SYN_MT_REPORT, 0);
+	uinput_device_event(uidev, EV_ABS, ABS_MT_POSITION_X, 900);
+	uinput_device_event(uidev, EV_ABS, ABS_MT_POSITION_Y, 900);
+	uinput_device_event(uidev, EV_SYN, SYN_MT_REPORT, 0);
+	uinput_device_event(uidev, EV_SYN, SYN_REPORT, 0);
+	uinput_device_event(uidev, EV_ABS, ABS_MT_POSITION_X, 110);
+	uinput_device_event(uidev, EV_ABS, ABS_MT_POSITION_Y, 100);
+	uinput_device_event(uidev, EV_SYN, SYN_MT_REPORT, 0);
+	uinput_device_event(uidev, EV_SYN, SYN_REPORT, 0);
+
+	for (i = 0; i < ARRAY_LENGTH(expected); i++) {
+		rc = libevdev_next_event(dev, LIBEVDEV_READ_FLAG_NORMAL, &ev);
+		ck_assert_int_eq(rc, LIBEVDEV_READ_STATUS_SUCCESS);
+		ck_assert_int_eq(ev.type, expected[i][0]);
+		ck_assert_int_eq(ev.code, expected[i][1]);
+		ck_assert_int_eq(ev.value, (int)expected[i][2]);
+	}
+
+	rc = libevdev_next_event(dev, LIBEVDEV_READ_FLAG_NORMAL, &ev);
+	ck_assert_int_eq(rc, -EAGAIN);
+
+	ck_assert_int_eq(libevdev_get_num_active_slots(dev), 1);
+	ck_assert_int_eq(libevdev_get_slot_value(dev, 0, ABS_MT_TRACKING_ID), 0);
+	ck_assert_int_eq(libevdev_get_slot_value(dev, 0, ABS_MT_POSITION_X), 110);
+	ck_assert_int_eq(libevdev_get_slot_value(dev, 1, ABS_MT_TRACKING_ID), -1);
+
+	uinput_device_free(uidev);
+	libevdev_free(dev);
+}
+END_TEST
+
 START_TEST(test_mt_slot_ranges_invalid)
 {
 	struct uinput_device* uidev;
@@ -2180,6 +2539,11 @@ libevdev_events(void)
 	tcase_add_test(tc, test_event_values_invalid);
 	tcase_add_test(tc, test_mt_event_values);
 	tcase_add_test(tc, test_mt_event_values_invalid);
+	tcase_add_test(tc, test_mt_event_bulk_values);
+	tcase_add_test(tc, test_mt_active_slots);
+	tcase_add_test(tc, test_mt_changed_slots);
+	tcase_add_test(tc, test_mt_touch_history);
+	tcase_add_test(tc, test_mt_protocol_a_conversion);
 	tcase_add_test(tc, test_mt_slot_ranges_invalid);
 	tcase_add_test(tc, test_mt_tracking_id_discard);
 	tcase_add_test(tc, test_mt_tracking_id_discard_neg_1);
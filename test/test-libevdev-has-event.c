@@ -866,6 +866,183 @@ START_TEST(test_device_disable_bit_invalid)
 }
 END_TEST
 
+START_TEST(test_device_enable_disable_abs)
+{
+	struct libevdev *dev;
+	struct input_absinfo abs = {0};
+	unsigned int code;
+
+	dev = libevdev_new();
+
+	/* enable out of order so axes are enabled in between */
+	for (code = ABS_X; code <= ABS_MAX; code += 2) {
+		abs.maximum = code;
+		ck_assert_int_eq(libevdev_enable_event_code(dev, EV_ABS, code, &abs), 0);
+	}
+	for (code = ABS_X + 1; code <= ABS_MAX; code += 2) {
+		abs.maximum = code;
+		ck_assert_int_eq(libevdev_enable_event_code(dev, EV_ABS, code, &abs), 0);
+	}
+
+	for (code = ABS_X; code <= ABS_MAX; code++)
+		ck_assert_int_eq(libevdev_get_abs_maximum(dev, code), code);
+
+	for (code = ABS_X; code <= ABS_MAX; code += 3)
+		ck_assert_int_eq(libevdev_disable_event_code(dev, EV_ABS, code), 0);
+
+	for (code = ABS_X; code <= ABS_MAX; code++) {
+		if (code % 3 == 0) {
+			ck_assert(libevdev_get_abs_info(dev, code) == NULL);
+		} else {
+			ck_assert_int_eq(libevdev_get_abs_maximum(dev, code), code);
+			libevdev_set_abs_minimum(dev, code, -(int)code);
+		}
+	}
+
+	for (code = ABS_X; code <= ABS_MAX; code++) {
+		if (code % 3 != 0) {
+			ck_assert_int_eq(libevdev_get_abs_minimum(dev, code), -(int)code);
+			ck_assert_int_eq(libevdev_get_abs_maximum(dev, code), code);
+		}
+	}
+
+	libevdev_free(dev);
+}
+END_TEST
+
+START_TEST(test_device_abs_info_pointer)
+{
+	struct libevdev *dev;
+	struct input_absinfo abs = {0};
+	const struct input_absinfo *y;
+	unsigned int code;
+
+	dev = libevdev_new();
+
+	abs.maximum = 100;
+	ck_assert_int_eq(libevdev_enable_event_code(dev, EV_ABS, ABS_Y, &abs), 0);
+	y = libevdev_get_abs_info(dev, ABS_Y);
+	ck_assert(y != NULL);
+
+	/* copying from the device's own abs_info while enabling */
+	ck_assert_int_eq(libevdev_enable_event_code(dev, EV_ABS, ABS_X, y), 0);
+	ck_assert_int_eq(libevdev_get_abs_maximum(dev, ABS_X), 100);
+
+	abs.maximum = 200;
+	for (code = ABS_Z; code <= ABS_MAX; code++)
+		ck_assert_int_eq(libevdev_enable_event_code(dev, EV_ABS, code, &abs), 0);
+	ck_assert_int_eq(libevdev_disable_event_code(dev, EV_ABS, ABS_X), 0);
+	ck_assert_int_eq(libevdev_disable_event_code(dev, EV_ABS, ABS_Z), 0);
+
+	/* a pointer taken earlier still points at ABS_Y */
+	ck_assert(y == libevdev_get_abs_info(dev, ABS_Y));
+	ck_assert_int_eq(y->maximum, 100);
+
+	libevdev_free(dev);
+}
+END_TEST
+
+START_TEST(test_device_share_capabilities)
+{
+	struct libevdev *dev, *dev2;
+	struct input_absinfo abs = {0, 0, 100};
+
+	dev = libevdev_new();
+	dev2 = libevdev_new();
+
+	ck_assert_int_eq(libevdev_share_capabilities(dev, dev2), 0);
+
+	libevdev_enable_event_code(dev, EV_REL, REL_X, NULL);
+	libevdev_enable_event_code(dev, EV_ABS, ABS_X, &abs);
+	libevdev_enable_property(dev, INPUT_PROP_DIRECT);
+	ck_assert_int_eq(libevdev_share_capabilities(dev2, dev), -EINVAL);
+	ck_assert(!libevdev_has_event_type(dev2, EV_REL));
+
+	libevdev_enable_event_code(dev2, EV_REL, REL_X, NULL);
+	libevdev_enable_event_code(dev2, EV_ABS, ABS_X, &abs);
+	ck_assert_int_eq(libevdev_share_capabilities(dev2, dev), -EINVAL);
+	libevdev_enable_property(dev2, INPUT_PROP_DIRECT);
+	ck_assert_int_eq(libevdev_share_capabilities(dev2, dev), 0);
+	ck_assert_int_eq(libevdev_share_capabilities(dev2, dev), 0);
+
+	/* modifying one device must not affect the other */
+	libevdev_enable_event_code(dev, EV_REL, REL_Y, NULL);
+	ck_assert(libevdev_has_event_code(dev, EV_REL, REL_Y));
+	ck_assert(!libevdev_has_event_code(dev2, EV_REL, REL_Y));
+
+	libevdev_disable_event_code(dev, EV_REL, REL_Y);
+	ck_assert_int_eq(libevdev_share_capabilities(dev, dev2), 0);
+	libevdev_disable_event_type(dev2, EV_REL);
+	ck_assert(!libevdev_has_event_type(dev2, EV_REL));
+	ck_assert(libevdev_has_event_code(dev, EV_REL, REL_X));
+
+	/* abs_info is per-device */
+	libevdev_set_abs_maximum(dev, ABS_X, 200);
+	ck_assert_int_eq(libevdev_get_abs_maximum(dev, ABS_X), 200);
+	ck_assert_int_eq(libevdev_get_abs_maximum(dev2, ABS_X), 100);
+
+	libevdev_free(dev);
+	ck_assert(libevdev_has_event_code(dev2, EV_ABS, ABS_X));
+	ck_assert(libevdev_has_property(dev2, INPUT_PROP_DIRECT));
+	libevdev_free(dev2);
+}
+END_TEST
+
+START_TEST(test_device_fingerprint)
+{
+	struct libevdev *dev, *dev2;
+	struct input_absinfo abs = {0, 0, 100};
+	uint64_t fp[2], fp2[2], empty[2];
+
+	dev = libevdev_new();
+	dev2 = libevdev_new();
+
+	libevdev_get_fingerprint(dev, empty);
+	libevdev_get_fingerprint(dev2, fp2);
+	ck_assert(empty[0] == fp2[0] && empty[1] == fp2[1]);
+
+	libevdev_enable_event_code(dev, EV_REL, REL_X, NULL);
+	libevdev_enable_event_code(dev, EV_ABS, ABS_X, &abs);
+	libevdev_enable_property(dev, INPUT_PROP_DIRECT);
+	libevdev_get_fingerprint(dev, fp);
+	ck_assert(fp[0] != empty[0] && fp[1] != empty[1]);
+
+	/* same capabilities in a different order, name and ids don't matter */
+	libevdev_enable_property(dev2, INPUT_PROP_DIRECT);
+	libevdev_enable_event_code(dev2, EV_ABS, ABS_X, &abs);
+	libevdev_enable_event_code(dev2, EV_REL, REL_X, NULL);
+	libevdev_set_name(dev2, "other name");
+	libevdev_set_id_vendor(dev2, 0x1234);
+	libevdev_get_fingerprint(dev2, fp2);
+	ck_assert(fp[0] == fp2[0] && fp[1] == fp2[1]);
+
+	/* axis ranges count, axis values don't */
+	libevdev_set_abs_maximum(dev2, ABS_X, 200);
+	libevdev_get_fingerprint(dev2, fp2);
+	ck_assert(fp[0] != fp2[0]);
+	libevdev_set_abs_maximum(dev2, ABS_X, 100);
+	libevdev_set_event_value(dev2, EV_ABS, ABS_X, 50);
+	libevdev_get_fingerprint(dev2, fp2);
+	ck_assert(fp[0] == fp2[0] && fp[1] == fp2[1]);
+
+	libevdev_enable_event_code(dev2, EV_KEY, BTN_LEFT, NULL);
+	libevdev_get_fingerprint(dev2, fp2);
+	ck_assert(fp[0] != fp2[0]);
+
+	/* codes of a disabled type are ignored */
+	libevdev_disable_event_type(dev2, EV_KEY);
+	libevdev_get_fingerprint(dev2, fp2);
+	ck_assert(fp[0] == fp2[0] && fp[1] == fp2[1]);
+
+	libevdev_disable_event_code(dev2, EV_REL, REL_X);
+	libevdev_get_fingerprint(dev2, fp2);
+	ck_assert(fp[0] != fp2[0]);
+
+	libevdev_free(dev);
+	libevdev_free(dev2);
+}
+END_TEST
+
 START_TEST(test_device_kernel_change_axis)
 {
 	struct uinput_device* uidev;
@@ -1187,6 +1364,10 @@ libevdev_has_event_test(void)
 	tcase_add_test(tc, test_device_enable_bit_invalid);
 	tcase_add_test(tc, test_device_disable_bit);
 	tcase_add_test(tc, test_device_disable_bit_invalid);
+	tcase_add_test(tc, test_device_enable_disable_abs);
+	tcase_add_test(tc, test_device_abs_info_pointer);
+	tcase_add_test(tc, test_device_fingerprint);
+	tcase_add_test(tc, test_device_share_capabilities);
 	tcase_add_test(tc, test_device_kernel_change_axis);
 	tcase_add_test(tc, test_device_kernel_change_axis_invalid);
 	tcase_add_test(tc, test_device_kernel_set_abs_invalid_fd);
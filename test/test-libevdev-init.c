@@ -105,6 +105,203 @@ START_TEST(test_init_and_change_fd)
 }
 END_TEST
 
+START_TEST(test_reattach_invalid)
+{
+	struct libevdev *dev;
+
+	dev = libevdev_new();
+	libevdev_set_log_function(test_logfunc_ignore_error, NULL);
+	ck_assert_int_eq(libevdev_reattach_fd(dev, 0), -EBADF);
+	libevdev_set_log_function(test_logfunc_abort_on_error, NULL);
+	libevdev_free(dev);
+}
+END_TEST
+
+START_TEST(test_reattach_same_device)
+{
+	struct uinput_device* uidev;
+	struct libevdev *dev;
+	struct input_event ev;
+	int rc, fd;
+
+	test_create_device(&uidev, &dev,
+			   EV_SYN, SYN_REPORT,
+			   EV_REL, REL_X,
+			   EV_REL, REL_Y,
+			   EV_KEY, BTN_LEFT,
+			   EV_KEY, BTN_RIGHT,
+			   -1);
+
+	fd = open(uinput_device_get_devnode(uidev), O_RDONLY|O_NONBLOCK);
+	ck_assert_int_gt(fd, -1);
+
+	uinput_device_event(uidev, EV_KEY, BTN_LEFT, 1);
+	uinput_device_event(uidev, EV_SYN, SYN_REPORT, 0);
+
+	rc = libevdev_reattach_fd(dev, fd);
+	ck_assert_int_eq(rc, LIBEVDEV_REATTACH_SAME_DEVICE);
+	ck_assert_int_eq(libevdev_get_fd(dev), fd);
+	ck_assert_int_eq(libevdev_get_event_value(dev, EV_KEY, BTN_LEFT), 0);
+
+	rc = libevdev_next_event(dev, LIBEVDEV_READ_FLAG_SYNC, &ev);
+	ck_assert_int_eq(rc, LIBEVDEV_READ_STATUS_SYNC);
+	ck_assert_int_eq(ev.type, EV_KEY);
+	ck_assert_int_eq(ev.code, BTN_LEFT);
+	ck_assert_int_eq(ev.value, 1);
+	rc = libevdev_next_event(dev, LIBEVDEV_READ_FLAG_SYNC, &ev);
+	ck_assert_int_eq(rc, LIBEVDEV_READ_STATUS_SYNC);
+	ck_assert_int_eq(ev.type, EV_SYN);
+	ck_assert_int_eq(ev.code, SYN_REPORT);
+	ck_assert_int_eq(ev.value, 0);
+	rc = libevdev_next_event(dev, LIBEVDEV_READ_FLAG_SYNC, &ev);
+	ck_assert_int_eq(rc, -EAGAIN);
+
+	ck_assert_int_eq(libevdev_get_event_value(dev, EV_KEY, BTN_LEFT), 1);
+
+	uinput_device_free(uidev);
+	libevdev_free(dev);
+	close(fd);
+}
+END_TEST
+
+START_TEST(test_reattach_new_device)
+{
+	struct uinput_device* uidev, *uidev2;
+	struct libevdev *dev;
+	int rc;
+
+	test_create_device(&uidev, &dev,
+			   EV_SYN, SYN_REPORT,
+			   EV_REL, REL_X,
+			   EV_REL, REL_Y,
+			   EV_KEY, BTN_LEFT,
+			   -1);
+
+	rc = uinput_device_new_with_events(&uidev2,
+					   TEST_DEVICE_NAME, DEFAULT_IDS,
+					   EV_SYN, SYN_REPORT,
+					   EV_KEY, KEY_A,
+					   -1);
+	ck_assert_msg(rc == 0, "Failed to create uinput device: %s", strerror(-rc));
+
+	rc = libevdev_reattach_fd(dev, uinput_device_get_fd(uidev2));
+	ck_assert_int_eq(rc, LIBEVDEV_REATTACH_NEW_DEVICE);
+	ck_assert_int_eq(libevdev_get_fd(dev), uinput_device_get_fd(uidev2));
+	ck_assert(libevdev_has_event_code(dev, EV_KEY, KEY_A));
+	ck_assert(!libevdev_has_event_type(dev, EV_REL));
+	ck_assert(!libevdev_has_event_code(dev, EV_KEY, BTN_LEFT));
+
+	uinput_device_free(uidev);
+	uinput_device_free(uidev2);
+	libevdev_free(dev);
+}
+END_TEST
+
+START_TEST(test_reattach_new_axis_range)
+{
+	struct uinput_device* uidev, *uidev2;
+	struct libevdev *dev;
+	struct input_absinfo abs = {
+		.value = ABS_X,
+		.maximum = 1000,
+	};
+	int rc;
+
+	test_create_abs_device(&uidev, &dev,
+			       1, &abs,
+			       EV_SYN, SYN_REPORT,
+			       -1);
+
+	uidev2 = uinput_device_new(TEST_DEVICE_NAME);
+	ck_assert(uidev2 != NULL);
+	abs.value = 0;
+	abs.maximum = 2000;
+	rc = uinput_device_set_abs_bit(uidev2, ABS_X, &abs);
+	ck_assert_int_eq(rc, 0);
+	rc = uinput_device_create(uidev2);
+	ck_assert_msg(rc == 0, "Failed to create uinput device: %s", strerror(-rc));
+
+	rc = libevdev_reattach_fd(dev, uinput_device_get_fd(uidev2));
+	ck_assert_int_eq(rc, LIBEVDEV_REATTACH_NEW_DEVICE);
+	ck_assert_int_eq(libevdev_get_abs_maximum(dev, ABS_X), 2000);
+
+	uinput_device_free(uidev);
+	uinput_device_free(uidev2);
+	libevdev_free(dev);
+}
+END_TEST
+
+START_TEST(test_reattach_mt_protocol_a)
+{
+	struct uinput_device* uidev, *uidev2;
+	struct libevdev *dev;
+	struct input_absinfo abs[2] = {
+		{ .value = ABS_MT_POSITION_X, .maximum = 1000 },
+		{ .value = ABS_MT_POSITION_Y, .maximum = 1000 },
+	};
+	struct input_event ev;
+	int rc, fd;
+
+	test_create_abs_device(&uidev, &dev,
+			       2, abs,
+			       EV_SYN, SYN_REPORT,
+			       EV_SYN, SYN_MT_REPORT,
+			       -1);
+	rc = libevdev_enable_mt_protocol_a_conversion(dev, 4);
+	ck_assert_int_eq(rc, 0);
+	rc = libevdev_enable_touch_history(dev, 8);
+	ck_assert_int_eq(rc, 0);
+
+	fd = open(uinput_device_get_devnode(uidev), O_RDONLY|O_NONBLOCK);
+	ck_assert_int_gt(fd, -1);
+	rc = libevdev_reattach_fd(dev, fd);
+	ck_assert_int_eq(rc, LIBEVDEV_REATTACH_SAME_DEVICE);
+	ck_assert_int_eq(libevdev_get_num_slots(dev), 4);
+
+	/* a new device still gets the conversion and the history */
+	uidev2 = uinput_device_new(TEST_DEVICE_NAME);
+	ck_assert(uidev2 != NULL);
+	rc = uinput_device_set_event_bits(uidev2,
+					  EV_SYN, SYN_REPORT,
+					  EV_SYN, SYN_MT_REPORT,
+					  EV_KEY, BTN_TOUCH,
+					  -1);
+	ck_assert_int_eq(rc, 0);
+	abs[0].value = 0;
+	abs[1].value = 0;
+	rc = uinput_device_set_abs_bit(uidev2, ABS_MT_POSITION_X, &abs[0]);
+	ck_assert_int_eq(rc, 0);
+	rc = uinput_device_set_abs_bit(uidev2, ABS_MT_POSITION_Y, &abs[1]);
+	ck_assert_int_eq(rc, 0);
+	rc = uinput_device_create(uidev2);
+	ck_assert_msg(rc == 0, "Failed to create uinput device: %s", strerror(-rc));
+
+	rc = libevdev_reattach_fd(dev, uinput_device_get_fd(uidev2));
+	ck_assert_int_eq(rc, LIBEVDEV_REATTACH_NEW_DEVICE);
+	ck_assert(libevdev_has_event_code(dev, EV_KEY, BTN_TOUCH));
+	ck_assert(libevdev_has_event_code(dev, EV_ABS, ABS_MT_SLOT));
+	ck_assert_int_eq(libevdev_get_num_slots(dev), 4);
+	ck_assert_int_eq(libevdev_get_num_touch_frames(dev), 0);
+
+	uinput_device_event(uidev2, EV_ABS, ABS_MT_POSITION_X, 100);
+	uinput_device_event(uidev2, EV_ABS, ABS_MT_POSITION_Y, 100);
+	uinput_device_event(uidev2, EV_SYN, SYN_MT_REPORT, 0);
+	uinput_device_event(uidev2, EV_SYN, SYN_REPORT, 0);
+
+	do {
+		rc = libevdev_next_event(dev, LIBEVDEV_READ_FLAG_NORMAL, &ev);
+	} while (rc == LIBEVDEV_READ_STATUS_SUCCESS);
+	ck_assert_int_eq(rc, -EAGAIN);
+	ck_assert_int_eq(libevdev_get_num_active_slots(dev), 1);
+	ck_assert_int_eq(libevdev_get_num_touch_frames(dev), 1);
+
+	uinput_device_free(uidev);
+	uinput_device_free(uidev2);
+	libevdev_free(dev);
+	close(fd);
+}
+END_TEST
+
 static int log_fn_called = 0;
 static char *logdata = "test";
 static void logfunc(enum libevdev_log_priority priority,
@@ -683,6 +880,211 @@ START_TEST(test_clock_id_events)
 }
 END_TEST
 
+static struct libevdev *
+create_description_device(void)
+{
+	struct libevdev *dev = libevdev_new();
+	struct input_absinfo abs = {
+		.value = 12,
+		.minimum = -100,
+		.maximum = 4095,
+		.fuzz = 2,
+		.flat = 4,
+		.resolution = 40,
+	};
+	struct input_absinfo slot = { .maximum = 9 };
+	struct input_absinfo tracking = { .minimum = -1, .maximum = 0xffff };
+	int delay = 250, period = 33;
+
+	libevdev_set_name(dev, "description test device");
+	libevdev_set_phys(dev, "usb-0000:00:14.0-1/input0");
+	libevdev_set_id_bustype(dev, BUS_USB);
+	libevdev_set_id_vendor(dev, 0x46d);
+	libevdev_set_id_product(dev, 0xc077);
+	libevdev_set_id_version(dev, 0x111);
+	libevdev_enable_property(dev, INPUT_PROP_DIRECT);
+	libevdev_enable_event_code(dev, EV_KEY, BTN_TOUCH, NULL);
+	libevdev_enable_event_code(dev, EV_KEY, KEY_MAX, NULL);
+	libevdev_enable_event_code(dev, EV_REL, REL_WHEEL, NULL);
+	libevdev_enable_event_code(dev, EV_ABS, ABS_X, &abs);
+	libevdev_enable_event_code(dev, EV_ABS, ABS_MT_SLOT, &slot);
+	libevdev_enable_event_code(dev, EV_ABS, ABS_MT_POSITION_X, &abs);
+	libevdev_enable_event_code(dev, EV_ABS, ABS_MT_TRACKING_ID, &tracking);
+	libevdev_enable_event_code(dev, EV_MSC, MSC_TIMESTAMP, NULL);
+	libevdev_enable_event_code(dev, EV_REP, REP_DELAY, &delay);
+	libevdev_enable_event_code(dev, EV_REP, REP_PERIOD, &period);
+	libevdev_enable_event_type(dev, EV_SW);
+
+	return dev;
+}
+
+static void
+assert_description_equal(const struct libevdev *a, const struct libevdev *b)
+{
+	unsigned int type, code;
+	int delay_a, period_a, delay_b, period_b;
+
+	ck_assert_str_eq(libevdev_get_name(a), libevdev_get_name(b));
+	ck_assert_str_eq(libevdev_get_phys(a), libevdev_get_phys(b));
+	ck_assert(libevdev_get_uniq(b) == NULL);
+	ck_assert_int_eq(libevdev_get_id_bustype(a), libevdev_get_id_bustype(b));
+	ck_assert_int_eq(libevdev_get_id_vendor(a), libevdev_get_id_vendor(b));
+	ck_assert_int_eq(libevdev_get_id_product(a), libevdev_get_id_product(b));
+	ck_assert_int_eq(libevdev_get_id_version(a), libevdev_get_id_version(b));
+	ck_assert_int_eq(libevdev_get_driver_version(a), libevdev_get_driver_version(b));
+
+	for (code = 0; code <= INPUT_PROP_MAX; code++)
+		ck_assert_int_eq(libevdev_has_property(a, code),
+				 libevdev_has_property(b, code));
+
+	for (type = 0; type <= EV_MAX; type++) {
+		int max = libevdev_event_type_get_max(type);
+
+		ck_assert_int_eq(libevdev_has_event_type(a, type),
+				 libevdev_has_event_type(b, type));
+
+		for (code = 0; max > 0 && code <= (unsigned int)max; code++) {
+			const struct input_absinfo *absa, *absb;
+
+			ck_assert_int_eq(libevdev_has_event_code(a, type, code),
+					 libevdev_has_event_code(b, type, code));
+			if (type != EV_ABS || !libevdev_has_event_code(a, type, code))
+				continue;
+
+			absa = libevdev_get_abs_info(a, code);
+			absb = libevdev_get_abs_info(b, code);
+			ck_assert_int_eq(absa->minimum, absb->minimum);
+			ck_assert_int_eq(absa->maximum, absb->maximum);
+			ck_assert_int_eq(absa->fuzz, absb->fuzz);
+			ck_assert_int_eq(absa->flat, absb->flat);
+			ck_assert_int_eq(absa->resolution, absb->resolution);
+		}
+	}
+
+	ck_assert_int_eq(libevdev_get_repeat(a, &delay_a, &period_a), 0);
+	ck_assert_int_eq(libevdev_get_repeat(b, &delay_b, &period_b), 0);
+	ck_assert_int_eq(delay_a, delay_b);
+	ck_assert_int_eq(period_a, period_b);
+}
+
+START_TEST(test_description_roundtrip)
+{
+	enum libevdev_description_format formats[] = {
+		LIBEVDEV_DESCRIPTION_BINARY,
+		LIBEVDEV_DESCRIPTION_TEXT,
+	};
+	struct libevdev *dev, *dev2;
+	size_t i;
+	int rc, len;
+	char buf[4096];
+
+	dev = create_description_device();
+
+	for (i = 0; i < sizeof(formats)/sizeof(formats[0]); i++) {
+		len = libevdev_serialize_description(dev, formats[i], NULL, 0);
+		ck_assert_int_gt(len, 0);
+		ck_assert_int_lt(len, (int)sizeof(buf));
+
+		rc = libevdev_serialize_description(dev, formats[i], buf, sizeof(buf));
+		ck_assert_int_eq(rc, len);
+
+		rc = libevdev_new_from_description(buf, len, &dev2);
+		ck_assert_int_eq(rc, 0);
+		assert_description_equal(dev, dev2);
+
+		ck_assert_int_eq(libevdev_get_num_slots(dev2), 10);
+		ck_assert_int_eq(libevdev_get_slot_value(dev2, 9, ABS_MT_TRACKING_ID), -1);
+		ck_assert_int_eq(libevdev_get_fd(dev2), -1);
+
+		/* and the serialized copy is identical */
+		rc = libevdev_serialize_description(dev2, formats[i], buf, sizeof(buf));
+		ck_assert_int_eq(rc, len);
+		libevdev_free(dev2);
+	}
+
+	libevdev_free(dev);
+}
+END_TEST
+
+START_TEST(test_description_truncated)
+{
+	struct libevdev *dev, *dev2;
+	char buf[4096];
+	int rc, len;
+
+	dev = create_description_device();
+
+	len = libevdev_serialize_description(dev, LIBEVDEV_DESCRIPTION_TEXT, buf, 10);
+	ck_assert_int_gt(len, 10);
+	ck_assert_int_eq(buf[9], '\0');
+
+	len = libevdev_serialize_description(dev, LIBEVDEV_DESCRIPTION_BINARY, buf, sizeof(buf));
+	ck_assert_int_gt(len, 0);
+
+	libevdev_set_log_function(test_logfunc_ignore_error, NULL);
+
+	/* every prefix of a binary description is either invalid or
+	 * missing data, but never crashes */
+	for (rc = 0; rc < len; rc++) {
+		if (libevdev_new_from_description(buf, rc, &dev2) == 0)
+			libevdev_free(dev2);
+	}
+
+	rc = libevdev_serialize_description(dev, 0, buf, sizeof(buf));
+	ck_assert_int_eq(rc, -EINVAL);
+	libevdev_set_log_function(test_logfunc_abort_on_error, NULL);
+
+	libevdev_free(dev);
+}
+END_TEST
+
+START_TEST(test_description_invalid)
+{
+	struct libevdev *dev;
+	const char *invalid[] = {
+		"this is not a description",
+		"version: 2\nname: foo\n",
+		"event: EV_FOO\n",
+		"event: EV_KEY KEY_FOO\n",
+		"event: EV_KEY 10000\n",
+		"event: EV_KEY KEY_A 1\n",
+		"event: EV_ABS ABS_X 0 1 2\n",
+		"event: EV_REP REP_DELAY\n",
+		"event: EV_ABS ABS_MT_SLOT 0 0 100000 0 0 0\n",
+		"id: 1 2 3\n",
+	};
+	const char binary[] = "LEVD\2\0\0\0";
+	const char text[] = "# comment\n"
+			    "name: text device\n"
+			    "id: 0x3 0x1 0x2 0x3\n"
+			    "property: INPUT_PROP_POINTER\n"
+			    "event: EV_KEY BTN_LEFT\n"
+			    "event: EV_ABS ABS_Y 0 0 100 0 0 0\n"
+			    "unknown: ignored\n";
+	size_t i;
+	int rc;
+
+	for (i = 0; i < sizeof(invalid)/sizeof(invalid[0]); i++) {
+		rc = libevdev_new_from_description(invalid[i], strlen(invalid[i]), &dev);
+		ck_assert_int_eq(rc, -EINVAL);
+	}
+
+	rc = libevdev_new_from_description(binary, sizeof(binary) - 1, &dev);
+	ck_assert_int_eq(rc, -EINVAL);
+
+	rc = libevdev_new_from_description(text, strlen(text), &dev);
+	ck_assert_int_eq(rc, 0);
+	ck_assert_str_eq(libevdev_get_name(dev), "text device");
+	ck_assert_int_eq(libevdev_get_id_bustype(dev), 3);
+	ck_assert(libevdev_has_property(dev, INPUT_PROP_POINTER));
+	ck_assert(libevdev_has_event_code(dev, EV_KEY, BTN_LEFT));
+	ck_assert(libevdev_has_event_type(dev, EV_SYN));
+	ck_assert_int_eq(libevdev_get_abs_maximum(dev, ABS_Y), 100);
+	ck_assert_int_eq(libevdev_get_num_slots(dev), -1);
+	libevdev_free(dev);
+}
+END_TEST
+
 Suite *
 libevdev_init_test(void)
 {
@@ -695,6 +1097,14 @@ libevdev_init_test(void)
 	tcase_add_test(tc, test_init_and_change_fd);
 	suite_add_tcase(s, tc);
 
+	tc = tcase_create("device reattach");
+	tcase_add_test(tc, test_reattach_invalid);
+	tcase_add_test(tc, test_reattach_same_device);
+	tcase_add_test(tc, test_reattach_new_device);
+	tcase_add_test(tc, test_reattach_new_axis_range);
+	tcase_add_test(tc, test_reattach_mt_protocol_a);
+	suite_add_tcase(s, tc);
+
 	tc = tcase_create("log init");
 	tcase_add_test(tc, test_log_init);
 	tcase_add_test(tc, test_log_priority);
@@ -721,5 +1131,11 @@ libevdev_init_test(void)
 	tcase_add_test(tc, test_clock_id_events);
 	suite_add_tcase(s, tc);
 
+	tc = tcase_create("device description");
+	tcase_add_test(tc, test_description_roundtrip);
+	tcase_add_test(tc, test_description_truncated);
+	tcase_add_test(tc, test_description_invalid);
+	suite_add_tcase(s, tc);
+
 	return s;
 }
@@ -39,6 +39,8 @@ extern Suite *queue_suite(void);
 extern Suite *libevdev_has_event_test(void);
 extern Suite *libevdev_events(void);
 extern Suite *uinput_suite(void);
+extern Suite *enumerate_suite(void);
+extern Suite *device_set_suite(void);
 
 static int
 is_debugger_attached(void)
@@ -94,6 +96,8 @@ int main(void)
 	srunner_add_suite(sr, event_name_suite());
 	srunner_add_suite(sr, event_code_suite());
 	srunner_add_suite(sr, uinput_suite());
+	srunner_add_suite(sr, enumerate_suite());
+	srunner_add_suite(sr, device_set_suite());
 	srunner_run_all(sr, CK_NORMAL);
 
 	failed = srunner_ntests_failed(sr);
@@ -25,8 +25,11 @@
 #include <errno.h>
 #include <unistd.h>
 #include <stdlib.h>
+#include <string.h>
 #include <fcntl.h>
+#include <time.h>
 #include <libevdev/libevdev-uinput.h>
+#include <libevdev/libevdev-util.h>
 
 #include "test-common.h"
 #define UINPUT_NODE "/dev/uinput"
@@ -111,6 +114,167 @@ START_TEST(test_uinput_create_device_invalid)
 }
 END_TEST
 
+START_TEST(test_uinput_create_devices)
+{
+	struct libevdev *dev, *dev2;
+	const struct libevdev *devs[2];
+	struct libevdev_uinput *uidevs[2] = { NULL, NULL };
+	const char *devnode;
+	int rc, fd, i;
+
+	dev = libevdev_new();
+	ck_assert(dev != NULL);
+	libevdev_set_name(dev, TEST_DEVICE_NAME);
+	libevdev_enable_event_code(dev, EV_REL, REL_X, NULL);
+	libevdev_enable_event_code(dev, EV_REL, REL_Y, NULL);
+
+	dev2 = libevdev_new();
+	ck_assert(dev2 != NULL);
+	libevdev_set_name(dev2, TEST_DEVICE_NAME " 2");
+	libevdev_enable_event_code(dev2, EV_KEY, KEY_A, NULL);
+
+	devs[0] = dev;
+	devs[1] = dev2;
+
+	ck_assert_int_eq(libevdev_uinput_create_from_devices(devs, 0, uidevs), 0);
+	ck_assert(uidevs[0] == NULL);
+
+	rc = libevdev_uinput_create_from_devices(devs, 2, uidevs);
+	ck_assert_int_eq(rc, 0);
+
+	for (i = 0; i < 2; i++) {
+		struct libevdev *created;
+
+		ck_assert(uidevs[i] != NULL);
+		devnode = libevdev_uinput_get_devnode(uidevs[i]);
+		ck_assert(devnode != NULL);
+		fd = open(devnode, O_RDONLY);
+		ck_assert_int_gt(fd, -1);
+		rc = libevdev_new_from_fd(fd, &created);
+		ck_assert_int_eq(rc, 0);
+		ck_assert_str_eq(libevdev_get_name(created), libevdev_get_name(devs[i]));
+		libevdev_free(created);
+		close(fd);
+
+		libevdev_uinput_destroy(uidevs[i]);
+	}
+
+	libevdev_free(dev);
+	libevdev_free(dev2);
+}
+END_TEST
+
+START_TEST(test_uinput_pool)
+{
+	struct libevdev *dev, *dev2;
+	struct libevdev_uinput_pool *pool;
+	struct libevdev_uinput *uidev, *uidev2, *uidev3;
+	struct input_event ev[4];
+	const char *devnode;
+	int fd, rc;
+
+	dev = libevdev_new();
+	ck_assert(dev != NULL);
+	libevdev_set_name(dev, TEST_DEVICE_NAME);
+	libevdev_enable_event_code(dev, EV_KEY, BTN_LEFT, NULL);
+	libevdev_enable_event_code(dev, EV_REL, REL_X, NULL);
+
+	dev2 = libevdev_new();
+	ck_assert(dev2 != NULL);
+	libevdev_set_name(dev2, TEST_DEVICE_NAME);
+	libevdev_enable_event_code(dev2, EV_KEY, BTN_RIGHT, NULL);
+
+	rc = libevdev_uinput_pool_new(&pool);
+	ck_assert_int_eq(rc, 0);
+
+	rc = libevdev_uinput_pool_acquire(pool, dev, &uidev);
+	ck_assert_int_eq(rc, 0);
+
+	/* in use, a second device is created */
+	rc = libevdev_uinput_pool_acquire(pool, dev, &uidev2);
+	ck_assert_int_eq(rc, 0);
+	ck_assert(uidev != uidev2);
+	libevdev_uinput_pool_release(pool, uidev2);
+
+	devnode = libevdev_uinput_get_devnode(uidev);
+	ck_assert(devnode != NULL);
+	fd = open(devnode, O_RDONLY|O_NONBLOCK);
+	ck_assert_int_gt(fd, -1);
+
+	libevdev_uinput_write_event(uidev, EV_KEY, BTN_LEFT, 1);
+	libevdev_uinput_write_event(uidev, EV_SYN, SYN_REPORT, 0);
+	libevdev_uinput_pool_release(pool, uidev);
+
+	/* the press and the reset */
+	rc = read(fd, ev, sizeof(ev));
+	ck_assert_int_eq(rc, sizeof(ev));
+	ck_assert_int_eq(ev[2].type, EV_KEY);
+	ck_assert_int_eq(ev[2].code, BTN_LEFT);
+	ck_assert_int_eq(ev[2].value, 0);
+	ck_assert_int_eq(ev[3].type, EV_SYN);
+	close(fd);
+
+	/* same description, same device */
+	rc = libevdev_uinput_pool_acquire(pool, dev, &uidev3);
+	ck_assert_int_eq(rc, 0);
+	ck_assert(uidev3 == uidev || uidev3 == uidev2);
+
+	rc = libevdev_uinput_pool_acquire(pool, dev2, &uidev);
+	ck_assert_int_eq(rc, 0);
+	ck_assert(uidev != uidev2);
+	ck_assert(uidev != uidev3);
+
+	libevdev_uinput_pool_free(pool);
+	libevdev_free(dev);
+	libevdev_free(dev2);
+}
+END_TEST
+
+START_TEST(test_uinput_pool_axis_values)
+{
+	struct libevdev *dev;
+	struct libevdev_uinput_pool *pool;
+	struct libevdev_uinput *uidev, *uidev2;
+	struct input_absinfo abs = { .value = 10, .maximum = 100 };
+	struct input_event ev[2];
+	const char *devnode;
+	int fd, rc;
+
+	dev = libevdev_new();
+	ck_assert(dev != NULL);
+	libevdev_set_name(dev, TEST_DEVICE_NAME);
+	libevdev_enable_event_code(dev, EV_ABS, ABS_X, &abs);
+
+	rc = libevdev_uinput_pool_new(&pool);
+	ck_assert_int_eq(rc, 0);
+
+	rc = libevdev_uinput_pool_acquire(pool, dev, &uidev);
+	ck_assert_int_eq(rc, 0);
+	devnode = libevdev_uinput_get_devnode(uidev);
+	ck_assert(devnode != NULL);
+	fd = open(devnode, O_RDONLY|O_NONBLOCK);
+	ck_assert_int_gt(fd, -1);
+	libevdev_uinput_pool_release(pool, uidev);
+
+	/* the axis value is state, the device is reused with the new value */
+	libevdev_set_event_value(dev, EV_ABS, ABS_X, 20);
+	rc = libevdev_uinput_pool_acquire(pool, dev, &uidev2);
+	ck_assert_int_eq(rc, 0);
+	ck_assert(uidev2 == uidev);
+
+	rc = read(fd, ev, sizeof(ev));
+	ck_assert_int_eq(rc, sizeof(ev));
+	ck_assert_int_eq(ev[0].type, EV_ABS);
+	ck_assert_int_eq(ev[0].code, ABS_X);
+	ck_assert_int_eq(ev[0].value, 20);
+	ck_assert_int_eq(ev[1].type, EV_SYN);
+	close(fd);
+
+	libevdev_uinput_pool_free(pool);
+	libevdev_free(dev);
+}
+END_TEST
+
 START_TEST(test_uinput_create_device_from_fd)
 {
 	struct libevdev *dev, *dev2;
@@ -326,6 +490,627 @@ START_TEST(test_uinput_events)
 }
 END_TEST
 
+START_TEST(test_uinput_write_events)
+{
+	struct libevdev *dev;
+	struct libevdev_uinput *uidev;
+	int fd, fd2;
+	int rc;
+	const char *devnode;
+	int i;
+	const int nevents = 5;
+	struct input_event events[] = { {{0, 0}, EV_REL, REL_X, 1},
+					{{0, 0}, EV_REL, REL_Y, -1},
+					{{0, 0}, EV_SYN, SYN_REPORT, 0},
+					{{0, 0}, EV_KEY, BTN_LEFT, 1},
+					{{0, 0}, EV_SYN, SYN_REPORT, 0}};
+	struct input_event invalid[] = { {{0, 0}, EV_REL, REL_X, 1},
+					 {{0, 0}, EV_REL, REL_MAX + 1, 1},
+					 {{0, 0}, EV_SYN, SYN_REPORT, 0}};
+	struct input_event events_read[nevents];
+
+	dev = libevdev_new();
+	ck_assert(dev != NULL);
+	libevdev_set_name(dev, TEST_DEVICE_NAME);
+	libevdev_enable_event_type(dev, EV_SYN);
+	libevdev_enable_event_type(dev, EV_REL);
+	libevdev_enable_event_type(dev, EV_KEY);
+	libevdev_enable_event_code(dev, EV_REL, REL_X, NULL);
+	libevdev_enable_event_code(dev, EV_REL, REL_Y, NULL);
+	libevdev_enable_event_code(dev, EV_KEY, BTN_LEFT, NULL);
+
+	fd = open(UINPUT_NODE, O_RDWR);
+	ck_assert_int_gt(fd, -1);
+
+	rc = libevdev_uinput_create_from_device(dev, fd, &uidev);
+	ck_assert_int_eq(rc, 0);
+	ck_assert(uidev != NULL);
+
+	devnode = libevdev_uinput_get_devnode(uidev);
+	ck_assert(devnode != NULL);
+
+	fd2 = open(devnode, O_RDONLY|O_NONBLOCK);
+
+	/* nothing is written if one event is invalid */
+	rc = libevdev_uinput_write_events(uidev, invalid, 3);
+	ck_assert_int_eq(rc, -EINVAL);
+	rc = read(fd2, events_read, sizeof(events_read));
+	ck_assert_int_eq(rc, -1);
+	ck_assert_int_eq(errno, EAGAIN);
+
+	rc = libevdev_uinput_write_events(uidev, events, nevents);
+	ck_assert_int_eq(rc, 0);
+
+	rc = read(fd2, events_read, sizeof(events_read));
+	ck_assert_int_eq(rc, sizeof(events_read));
+
+	for (i = 0; i < nevents; i++) {
+		ck_assert_int_eq(events[i].type, events_read[i].type);
+		ck_assert_int_eq(events[i].code, events_read[i].code);
+		ck_assert_int_eq(events[i].value, events_read[i].value);
+	}
+
+	ck_assert_int_eq(libevdev_uinput_write_events(uidev, events, 0), 0);
+
+	libevdev_free(dev);
+	libevdev_uinput_destroy(uidev);
+	close(fd);
+	close(fd2);
+}
+END_TEST
+
+START_TEST(test_uinput_frame)
+{
+	struct libevdev *dev;
+	struct libevdev_uinput *uidev;
+	int fd, fd2;
+	int rc;
+	const char *devnode;
+	int i;
+	struct input_absinfo abs = { 0, 0, 100, 0, 0, 0 };
+	struct input_event expected[] = { {{0, 0}, EV_REL, REL_X, 1},
+					  {{0, 0}, EV_KEY, BTN_LEFT, 1},
+					  {{0, 0}, EV_ABS, ABS_X, 50},
+					  {{0, 0}, EV_SYN, SYN_REPORT, 0},
+					  {{0, 0}, EV_ABS, ABS_X, 51},
+					  {{0, 0}, EV_SYN, SYN_REPORT, 0}};
+	struct input_event events_read[ARRAY_LENGTH(expected)];
+
+	dev = libevdev_new();
+	ck_assert(dev != NULL);
+	libevdev_set_name(dev, TEST_DEVICE_NAME);
+	libevdev_enable_event_code(dev, EV_REL, REL_X, NULL);
+	libevdev_enable_event_code(dev, EV_KEY, BTN_LEFT, NULL);
+	libevdev_enable_event_code(dev, EV_ABS, ABS_X, &abs);
+
+	fd = open(UINPUT_NODE, O_RDWR);
+	ck_assert_int_gt(fd, -1);
+
+	rc = libevdev_uinput_create_from_device(dev, fd, &uidev);
+	ck_assert_int_eq(rc, 0);
+	ck_assert(uidev != NULL);
+
+	devnode = libevdev_uinput_get_devnode(uidev);
+	ck_assert(devnode != NULL);
+
+	fd2 = open(devnode, O_RDONLY|O_NONBLOCK);
+
+	ck_assert_int_eq(libevdev_uinput_frame_add(uidev, EV_SYN, SYN_REPORT, 0), -EINVAL);
+	ck_assert_int_eq(libevdev_uinput_frame_add(uidev, EV_REL, REL_MAX + 1, 1), -EINVAL);
+
+	/* an empty frame posts nothing */
+	ck_assert_int_eq(libevdev_uinput_frame_flush(uidev), 0);
+
+	ck_assert_int_eq(libevdev_uinput_frame_add(uidev, EV_REL, REL_X, 1), 0);
+	ck_assert_int_eq(libevdev_uinput_frame_add(uidev, EV_KEY, BTN_LEFT, 1), 0);
+	ck_assert_int_eq(libevdev_uinput_frame_add(uidev, EV_ABS, ABS_X, 50), 0);
+	ck_assert_int_eq(libevdev_uinput_frame_flush(uidev), 0);
+
+	/* everything but ABS_X is unchanged */
+	ck_assert_int_eq(libevdev_uinput_frame_add(uidev, EV_REL, REL_X, 0), 0);
+	ck_assert_int_eq(libevdev_uinput_frame_add(uidev, EV_KEY, BTN_LEFT, 1), 0);
+	ck_assert_int_eq(libevdev_uinput_frame_add(uidev, EV_ABS, ABS_X, 50), 0);
+	ck_assert_int_eq(libevdev_uinput_frame_add(uidev, EV_ABS, ABS_X, 51), 0);
+	ck_assert_int_eq(libevdev_uinput_frame_flush(uidev), 0);
+
+	/* nothing changed at all */
+	ck_assert_int_eq(libevdev_uinput_frame_add(uidev, EV_ABS, ABS_X, 51), 0);
+	ck_assert_int_eq(libevdev_uinput_frame_flush(uidev), 0);
+
+	rc = read(fd2, events_read, sizeof(events_read));
+	ck_assert_int_eq(rc, sizeof(events_read));
+
+	for (i = 0; i < (int)ARRAY_LENGTH(expected); i++) {
+		ck_assert_int_eq(expected[i].type, events_read[i].type);
+		ck_assert_int_eq(expected[i].code, events_read[i].code);
+		ck_assert_int_eq(expected[i].value, events_read[i].value);
+	}
+
+	rc = read(fd2, events_read, sizeof(events_read));
+	ck_assert_int_eq(rc, -1);
+	ck_assert_int_eq(errno, EAGAIN);
+
+	libevdev_free(dev);
+	libevdev_uinput_destroy(uidev);
+	close(fd);
+	close(fd2);
+}
+END_TEST
+
+START_TEST(test_uinput_replay)
+{
+	struct libevdev *dev;
+	struct libevdev_uinput *uidev;
+	struct libevdev_uinput_replay *replay;
+	const char *devnode;
+	int fd, rc, i;
+	struct input_event events[6];
+	struct input_event events_read[6];
+	struct timespec start, end;
+	long elapsed_ms;
+
+	memset(events, 0, sizeof(events));
+	for (i = 0; i < 3; i++) {
+		events[2 * i].input_event_usec = i * 10000;
+		events[2 * i].type = EV_REL;
+		events[2 * i].code = REL_X;
+		events[2 * i].value = i + 1;
+		events[2 * i + 1] = events[2 * i];
+		events[2 * i + 1].type = EV_SYN;
+		events[2 * i + 1].code = SYN_REPORT;
+		events[2 * i + 1].value = 0;
+	}
+
+	dev = libevdev_new();
+	ck_assert(dev != NULL);
+	libevdev_set_name(dev, TEST_DEVICE_NAME);
+	libevdev_enable_event_code(dev, EV_REL, REL_X, NULL);
+
+	rc = libevdev_uinput_create_from_device(dev,
+						LIBEVDEV_UINPUT_OPEN_MANAGED,
+						&uidev);
+	ck_assert_int_eq(rc, 0);
+
+	devnode = libevdev_uinput_get_devnode(uidev);
+	ck_assert(devnode != NULL);
+	fd = open(devnode, O_RDONLY|O_NONBLOCK);
+	ck_assert_int_gt(fd, -1);
+
+	ck_assert_int_eq(libevdev_uinput_replay_new(uidev, events, 6, -1.0, &replay),
+			 -EINVAL);
+
+	rc = libevdev_uinput_replay_new(uidev, events, 6, 1.0, &replay);
+	ck_assert_int_eq(rc, 0);
+	ck_assert_int_eq(libevdev_uinput_replay_get_num_frames(replay), 3);
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	rc = libevdev_uinput_replay_run(replay);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	ck_assert_int_eq(rc, 0);
+	ck_assert_int_eq(libevdev_uinput_replay_get_num_frames_written(replay), 3);
+
+	/* the last frame is 20ms after the first */
+	elapsed_ms = (end.tv_sec - start.tv_sec) * 1000 +
+		     (end.tv_nsec - start.tv_nsec) / 1000000;
+	ck_assert_int_ge(elapsed_ms, 20);
+	ck_assert_int_ge(libevdev_uinput_replay_get_timing_error(replay, 0), 0);
+	ck_assert_int_le(libevdev_uinput_replay_get_timing_error(replay, 0),
+			 libevdev_uinput_replay_get_timing_error(replay, 100));
+	libevdev_uinput_replay_free(replay);
+
+	rc = read(fd, events_read, sizeof(events_read));
+	ck_assert_int_eq(rc, sizeof(events_read));
+	for (i = 0; i < 6; i++) {
+		ck_assert_int_eq(events_read[i].type, events[i].type);
+		ck_assert_int_eq(events_read[i].code, events[i].code);
+		ck_assert_int_eq(events_read[i].value, events[i].value);
+	}
+
+	/* as fast as possible */
+	rc = libevdev_uinput_replay_new(uidev, events, 6, 0, &replay);
+	ck_assert_int_eq(rc, 0);
+	ck_assert_int_eq(libevdev_uinput_replay_dispatch(replay), 0);
+	ck_assert_int_eq(libevdev_uinput_replay_get_num_frames_written(replay), 3);
+	ck_assert_int_eq(libevdev_uinput_replay_get_timing_error(replay, 100), 0);
+	libevdev_uinput_replay_free(replay);
+
+	rc = read(fd, events_read, sizeof(events_read));
+	ck_assert_int_eq(rc, sizeof(events_read));
+
+	close(fd);
+	libevdev_uinput_destroy(uidev);
+	libevdev_free(dev);
+}
+END_TEST
+
+static unsigned int
+proxy_drop_rel_y(struct input_event *events, unsigned int nevents, void *data)
+{
+	unsigned int i, n = 0;
+
+	for (i = 0; i < nevents; i++) {
+		if (!libevdev_event_is_code(&events[i], EV_REL, REL_Y))
+			events[n++] = events[i];
+	}
+
+	return n;
+}
+
+START_TEST(test_uinput_proxy)
+{
+	struct uinput_device *uidev;
+	struct libevdev *source, *sink;
+	struct libevdev_uinput_proxy *proxy;
+	struct input_event ev;
+	const char *devnode;
+	int fd, rc;
+
+	test_create_device(&uidev, &source,
+			   EV_REL, REL_X,
+			   EV_REL, REL_Y,
+			   EV_KEY, BTN_LEFT,
+			   -1);
+
+	rc = libevdev_uinput_proxy_new(source, LIBEVDEV_UINPUT_OPEN_MANAGED, &proxy);
+	ck_assert_int_eq(rc, 0);
+	libevdev_uinput_proxy_set_filter(proxy, proxy_drop_rel_y, NULL);
+
+	devnode = libevdev_uinput_get_devnode(libevdev_uinput_proxy_get_uinput(proxy));
+	ck_assert(devnode != NULL);
+	fd = open(devnode, O_RDONLY|O_NONBLOCK);
+	ck_assert_int_gt(fd, -1);
+	rc = libevdev_new_from_fd(fd, &sink);
+	ck_assert_int_eq(rc, 0);
+	ck_assert(libevdev_has_event_code(sink, EV_REL, REL_Y));
+
+	uinput_device_event_multiple(uidev,
+				     EV_REL, REL_X, 1,
+				     EV_REL, REL_Y, 2,
+				     EV_SYN, SYN_REPORT, 0,
+				     EV_KEY, BTN_LEFT, 1,
+				     EV_SYN, SYN_REPORT, 0,
+				     -1, -1);
+
+	rc = libevdev_uinput_proxy_dispatch(proxy);
+	ck_assert_int_eq(rc, 0);
+
+	rc = libevdev_next_event(sink, LIBEVDEV_READ_FLAG_NORMAL, &ev);
+	ck_assert_int_eq(rc, LIBEVDEV_READ_STATUS_SUCCESS);
+	ck_assert(libevdev_event_is_code(&ev, EV_REL, REL_X));
+	ck_assert_int_eq(ev.value, 1);
+	rc = libevdev_next_event(sink, LIBEVDEV_READ_FLAG_NORMAL, &ev);
+	ck_assert_int_eq(rc, LIBEVDEV_READ_STATUS_SUCCESS);
+	ck_assert(libevdev_event_is_code(&ev, EV_SYN, SYN_REPORT));
+	rc = libevdev_next_event(sink, LIBEVDEV_READ_FLAG_NORMAL, &ev);
+	ck_assert_int_eq(rc, LIBEVDEV_READ_STATUS_SUCCESS);
+	ck_assert(libevdev_event_is_code(&ev, EV_KEY, BTN_LEFT));
+	ck_assert_int_eq(ev.value, 1);
+	rc = libevdev_next_event(sink, LIBEVDEV_READ_FLAG_NORMAL, &ev);
+	ck_assert_int_eq(rc, LIBEVDEV_READ_STATUS_SUCCESS);
+	ck_assert(libevdev_event_is_code(&ev, EV_SYN, SYN_REPORT));
+	rc = libevdev_next_event(sink, LIBEVDEV_READ_FLAG_NORMAL, &ev);
+	ck_assert_int_eq(rc, -EAGAIN);
+
+	libevdev_free(sink);
+	close(fd);
+	libevdev_uinput_proxy_free(proxy);
+	libevdev_free(source);
+	uinput_device_free(uidev);
+}
+END_TEST
+
+START_TEST(test_uinput_proxy_syn_dropped)
+{
+	struct uinput_device *uidev;
+	struct libevdev *source, *sink;
+	struct libevdev_uinput_proxy *proxy;
+	struct input_event ev;
+	const char *devnode;
+	int fd, rc, i;
+
+	test_create_device(&uidev, &source,
+			   EV_REL, REL_X,
+			   EV_REL, REL_Y,
+			   EV_KEY, BTN_LEFT,
+			   -1);
+
+	rc = libevdev_uinput_proxy_new(source, LIBEVDEV_UINPUT_OPEN_MANAGED, &proxy);
+	ck_assert_int_eq(rc, 0);
+
+	devnode = libevdev_uinput_get_devnode(libevdev_uinput_proxy_get_uinput(proxy));
+	ck_assert(devnode != NULL);
+	fd = open(devnode, O_RDONLY|O_NONBLOCK);
+	ck_assert_int_gt(fd, -1);
+	rc = libevdev_new_from_fd(fd, &sink);
+	ck_assert_int_eq(rc, 0);
+
+	/* the press is dropped by the kernel, only the sync restores it */
+	uinput_device_event_multiple(uidev,
+				     EV_KEY, BTN_LEFT, 1,
+				     EV_SYN, SYN_REPORT, 0,
+				     -1, -1);
+
+	/* force enough events to trigger a SYN_DROPPED, but few enough
+	   that the sink's buffer doesn't overflow too */
+	for (i = 0; i < 30; i++) {
+		uinput_device_event_multiple(uidev,
+					     EV_REL, REL_X, 1,
+					     EV_REL, REL_Y, 1,
+					     EV_SYN, SYN_REPORT, 0,
+					     -1, -1);
+	}
+
+	rc = libevdev_uinput_proxy_dispatch(proxy);
+	ck_assert_int_eq(rc, 0);
+
+	rc = libevdev_next_event(sink, LIBEVDEV_READ_FLAG_NORMAL, &ev);
+	ck_assert_int_eq(rc, LIBEVDEV_READ_STATUS_SUCCESS);
+	ck_assert(libevdev_event_is_code(&ev, EV_KEY, BTN_LEFT));
+	ck_assert_int_eq(ev.value, 1);
+	rc = libevdev_next_event(sink, LIBEVDEV_READ_FLAG_NORMAL, &ev);
+	ck_assert_int_eq(rc, LIBEVDEV_READ_STATUS_SUCCESS);
+	ck_assert(libevdev_event_is_code(&ev, EV_SYN, SYN_REPORT));
+
+	while ((rc = libevdev_next_event(sink, LIBEVDEV_READ_FLAG_NORMAL, &ev)) != -EAGAIN) {
+		ck_assert_int_eq(rc, LIBEVDEV_READ_STATUS_SUCCESS);
+		ck_assert(!libevdev_event_is_code(&ev, EV_SYN, SYN_DROPPED));
+		ck_assert(!libevdev_event_is_type(&ev, EV_KEY));
+	}
+
+	ck_assert_int_eq(libevdev_get_event_value(sink, EV_KEY, BTN_LEFT), 1);
+
+	libevdev_free(sink);
+	close(fd);
+	libevdev_uinput_proxy_free(proxy);
+	libevdev_free(source);
+	uinput_device_free(uidev);
+}
+END_TEST
+
+START_TEST(test_uinput_aggregator)
+{
+	struct uinput_device *uidev1, *uidev2;
+	struct libevdev *sources[2], *sink;
+	struct libevdev_uinput_aggregator *agg;
+	struct input_event ev;
+	const char *devnode;
+	int fd, rc;
+
+	test_create_device(&uidev1, &sources[0],
+			   EV_KEY, KEY_A,
+			   -1);
+	test_create_device(&uidev2, &sources[1],
+			   EV_KEY, KEY_A,
+			   EV_KEY, KEY_B,
+			   -1);
+
+	rc = libevdev_uinput_aggregator_new(sources, 2, TEST_DEVICE_NAME,
+					    LIBEVDEV_UINPUT_OPEN_MANAGED, &agg);
+	ck_assert_int_eq(rc, 0);
+
+	devnode = libevdev_uinput_get_devnode(libevdev_uinput_aggregator_get_uinput(agg));
+	ck_assert(devnode != NULL);
+	fd = open(devnode, O_RDONLY|O_NONBLOCK);
+	ck_assert_int_gt(fd, -1);
+	rc = libevdev_new_from_fd(fd, &sink);
+	ck_assert_int_eq(rc, 0);
+	ck_assert(libevdev_has_event_code(sink, EV_KEY, KEY_A));
+	ck_assert(libevdev_has_event_code(sink, EV_KEY, KEY_B));
+
+	/* both press KEY_A, the first release is absorbed */
+	uinput_device_event_multiple(uidev1,
+				     EV_KEY, KEY_A, 1,
+				     EV_SYN, SYN_REPORT, 0,
+				     -1, -1);
+	uinput_device_event_multiple(uidev2,
+				     EV_KEY, KEY_A, 1,
+				     EV_SYN, SYN_REPORT, 0,
+				     EV_KEY, KEY_A, 0,
+				     EV_SYN, SYN_REPORT, 0,
+				     -1, -1);
+	rc = libevdev_uinput_aggregator_dispatch(agg);
+	ck_assert_int_eq(rc, 0);
+
+	rc = libevdev_next_event(sink, LIBEVDEV_READ_FLAG_NORMAL, &ev);
+	ck_assert_int_eq(rc, LIBEVDEV_READ_STATUS_SUCCESS);
+	ck_assert(libevdev_event_is_code(&ev, EV_KEY, KEY_A));
+	ck_assert_int_eq(ev.value, 1);
+	rc = libevdev_next_event(sink, LIBEVDEV_READ_FLAG_NORMAL, &ev);
+	ck_assert_int_eq(rc, LIBEVDEV_READ_STATUS_SUCCESS);
+	ck_assert(libevdev_event_is_code(&ev, EV_SYN, SYN_REPORT));
+	rc = libevdev_next_event(sink, LIBEVDEV_READ_FLAG_NORMAL, &ev);
+	ck_assert_int_eq(rc, -EAGAIN);
+
+	uinput_device_event_multiple(uidev1,
+				     EV_KEY, KEY_A, 0,
+				     EV_SYN, SYN_REPORT, 0,
+				     -1, -1);
+	rc = libevdev_uinput_aggregator_dispatch(agg);
+	ck_assert_int_eq(rc, 0);
+
+	rc = libevdev_next_event(sink, LIBEVDEV_READ_FLAG_NORMAL, &ev);
+	ck_assert_int_eq(rc, LIBEVDEV_READ_STATUS_SUCCESS);
+	ck_assert(libevdev_event_is_code(&ev, EV_KEY, KEY_A));
+	ck_assert_int_eq(ev.value, 0);
+	rc = libevdev_next_event(sink, LIBEVDEV_READ_FLAG_NORMAL, &ev);
+	ck_assert_int_eq(rc, LIBEVDEV_READ_STATUS_SUCCESS);
+	ck_assert(libevdev_event_is_code(&ev, EV_SYN, SYN_REPORT));
+	rc = libevdev_next_event(sink, LIBEVDEV_READ_FLAG_NORMAL, &ev);
+	ck_assert_int_eq(rc, -EAGAIN);
+
+	libevdev_free(sink);
+	close(fd);
+	libevdev_uinput_aggregator_free(agg);
+	libevdev_free(sources[0]);
+	libevdev_free(sources[1]);
+	uinput_device_free(uidev1);
+	uinput_device_free(uidev2);
+}
+END_TEST
+
+START_TEST(test_uinput_aggregator_syn_dropped)
+{
+	struct uinput_device *uidev1, *uidev2;
+	struct libevdev *sources[2], *sink;
+	struct libevdev_uinput_aggregator *agg;
+	struct input_event ev;
+	const char *devnode;
+	int fd, rc, i;
+
+	test_create_device(&uidev1, &sources[0],
+			   EV_KEY, KEY_A,
+			   EV_REL, REL_X,
+			   -1);
+	test_create_device(&uidev2, &sources[1],
+			   EV_KEY, KEY_A,
+			   -1);
+
+	rc = libevdev_uinput_aggregator_new(sources, 2, TEST_DEVICE_NAME,
+					    LIBEVDEV_UINPUT_OPEN_MANAGED, &agg);
+	ck_assert_int_eq(rc, 0);
+
+	devnode = libevdev_uinput_get_devnode(libevdev_uinput_aggregator_get_uinput(agg));
+	ck_assert(devnode != NULL);
+	fd = open(devnode, O_RDONLY|O_NONBLOCK);
+	ck_assert_int_gt(fd, -1);
+	rc = libevdev_new_from_fd(fd, &sink);
+	ck_assert_int_eq(rc, 0);
+
+	uinput_device_event_multiple(uidev1,
+				     EV_KEY, KEY_A, 1,
+				     EV_SYN, SYN_REPORT, 0,
+				     -1, -1);
+	rc = libevdev_uinput_aggregator_dispatch(agg);
+	ck_assert_int_eq(rc, 0);
+	do {
+		rc = libevdev_next_event(sink, LIBEVDEV_READ_FLAG_NORMAL, &ev);
+	} while (rc == LIBEVDEV_READ_STATUS_SUCCESS);
+	ck_assert_int_eq(rc, -EAGAIN);
+	ck_assert_int_eq(libevdev_get_event_value(sink, EV_KEY, KEY_A), 1);
+
+	/* the release is dropped by the kernel, only the sync restores it */
+	uinput_device_event_multiple(uidev1,
+				     EV_KEY, KEY_A, 0,
+				     EV_SYN, SYN_REPORT, 0,
+				     -1, -1);
+
+	/* force enough events to trigger a SYN_DROPPED, but few enough
+	   that the sink's buffer doesn't overflow too */
+	for (i = 0; i < 40; i++) {
+		uinput_device_event_multiple(uidev1,
+					     EV_REL, REL_X, 1,
+					     EV_SYN, SYN_REPORT, 0,
+					     -1, -1);
+	}
+
+	rc = libevdev_uinput_aggregator_dispatch(agg);
+	ck_assert_int_eq(rc, 0);
+
+	while ((rc = libevdev_next_event(sink, LIBEVDEV_READ_FLAG_NORMAL, &ev)) != -EAGAIN) {
+		ck_assert_int_eq(rc, LIBEVDEV_READ_STATUS_SUCCESS);
+		ck_assert(!libevdev_event_is_code(&ev, EV_SYN, SYN_DROPPED));
+	}
+
+	ck_assert_int_eq(libevdev_get_event_value(sink, EV_KEY, KEY_A), 0);
+
+	libevdev_free(sink);
+	close(fd);
+	libevdev_uinput_aggregator_free(agg);
+	libevdev_free(sources[0]);
+	libevdev_free(sources[1]);
+	uinput_device_free(uidev1);
+	uinput_device_free(uidev2);
+}
+END_TEST
+
+START_TEST(test_uinput_splitter)
+{
+	struct uinput_device *uidev;
+	struct libevdev *source, *sinks[2];
+	struct libevdev_uinput_splitter *splitter;
+	struct libevdev_uinput_split_rule rules[] = {
+		{ EV_KEY, 0, KEY_MAX, 0 },
+		{ EV_REL, 0, REL_MAX, 1 },
+	};
+	struct libevdev_uinput_split_rule invalid[] = {
+		{ EV_KEY, 0, KEY_MAX, 2 },
+	};
+	struct input_event ev;
+	const char *devnode;
+	int fds[2], rc, i;
+
+	test_create_device(&uidev, &source,
+			   EV_REL, REL_X,
+			   EV_REL, REL_Y,
+			   EV_KEY, BTN_0,
+			   -1);
+
+	rc = libevdev_uinput_splitter_new(source, invalid, 1, NULL, 2,
+					  LIBEVDEV_UINPUT_OPEN_MANAGED, &splitter);
+	ck_assert_int_eq(rc, -EINVAL);
+
+	rc = libevdev_uinput_splitter_new(source, rules, 2, NULL, 2,
+					  LIBEVDEV_UINPUT_OPEN_MANAGED, &splitter);
+	ck_assert_int_eq(rc, 0);
+	ck_assert(libevdev_uinput_splitter_get_uinput(splitter, 2) == NULL);
+
+	for (i = 0; i < 2; i++) {
+		struct libevdev_uinput *uinput;
+
+		uinput = libevdev_uinput_splitter_get_uinput(splitter, i);
+		devnode = libevdev_uinput_get_devnode(uinput);
+		ck_assert(devnode != NULL);
+		fds[i] = open(devnode, O_RDONLY|O_NONBLOCK);
+		ck_assert_int_gt(fds[i], -1);
+		rc = libevdev_new_from_fd(fds[i], &sinks[i]);
+		ck_assert_int_eq(rc, 0);
+	}
+
+	ck_assert(libevdev_has_event_code(sinks[0], EV_KEY, BTN_0));
+	ck_assert(!libevdev_has_event_type(sinks[0], EV_REL));
+	ck_assert(libevdev_has_event_code(sinks[1], EV_REL, REL_X));
+	ck_assert(libevdev_has_event_code(sinks[1], EV_REL, REL_Y));
+	ck_assert(!libevdev_has_event_type(sinks[1], EV_KEY));
+
+	uinput_device_event_multiple(uidev,
+				     EV_KEY, BTN_0, 1,
+				     EV_REL, REL_X, 1,
+				     EV_SYN, SYN_REPORT, 0,
+				     -1, -1);
+
+	rc = libevdev_uinput_splitter_dispatch(splitter);
+	ck_assert_int_eq(rc, 0);
+
+	rc = libevdev_next_event(sinks[0], LIBEVDEV_READ_FLAG_NORMAL, &ev);
+	ck_assert_int_eq(rc, LIBEVDEV_READ_STATUS_SUCCESS);
+	ck_assert(libevdev_event_is_code(&ev, EV_KEY, BTN_0));
+	ck_assert_int_eq(ev.value, 1);
+	rc = libevdev_next_event(sinks[0], LIBEVDEV_READ_FLAG_NORMAL, &ev);
+	ck_assert_int_eq(rc, LIBEVDEV_READ_STATUS_SUCCESS);
+	ck_assert(libevdev_event_is_code(&ev, EV_SYN, SYN_REPORT));
+	rc = libevdev_next_event(sinks[0], LIBEVDEV_READ_FLAG_NORMAL, &ev);
+	ck_assert_int_eq(rc, -EAGAIN);
+
+	rc = libevdev_next_event(sinks[1], LIBEVDEV_READ_FLAG_NORMAL, &ev);
+	ck_assert_int_eq(rc, LIBEVDEV_READ_STATUS_SUCCESS);
+	ck_assert(libevdev_event_is_code(&ev, EV_REL, REL_X));
+	ck_assert_int_eq(ev.value, 1);
+	rc = libevdev_next_event(sinks[1], LIBEVDEV_READ_FLAG_NORMAL, &ev);
+	ck_assert_int_eq(rc, LIBEVDEV_READ_STATUS_SUCCESS);
+	ck_assert(libevdev_event_is_code(&ev, EV_SYN, SYN_REPORT));
+	rc = libevdev_next_event(sinks[1], LIBEVDEV_READ_FLAG_NORMAL, &ev);
+	ck_assert_int_eq(rc, -EAGAIN);
+
+	for (i = 0; i < 2; i++) {
+		libevdev_free(sinks[i]);
+		close(fds[i]);
+	}
+	libevdev_uinput_splitter_free(splitter);
+	libevdev_free(source);
+	uinput_device_free(uidev);
+}
+END_TEST
+
 START_TEST(test_uinput_properties)
 {
 	struct libevdev *dev, *dev2;
@@ -376,6 +1161,9 @@ uinput_suite(void)
 	TCase *tc = tcase_create("device creation");
 	tcase_add_test(tc, test_uinput_create_device);
 	tcase_add_test(tc, test_uinput_create_device_invalid);
+	tcase_add_test(tc, test_uinput_create_devices);
+	tcase_add_test(tc, test_uinput_pool);
+	tcase_add_test(tc, test_uinput_pool_axis_values);
 	tcase_add_test(tc, test_uinput_create_device_from_fd);
 	tcase_add_test(tc, test_uinput_check_syspath_time);
 	tcase_add_test(tc, test_uinput_check_syspath_name);
@@ -383,6 +1171,14 @@ uinput_suite(void)
 
 	tc = tcase_create("device events");
 	tcase_add_test(tc, test_uinput_events);
+	tcase_add_test(tc, test_uinput_write_events);
+	tcase_add_test(tc, test_uinput_frame);
+	tcase_add_test(tc, test_uinput_replay);
+	tcase_add_test(tc, test_uinput_proxy);
+	tcase_add_test(tc, test_uinput_proxy_syn_dropped);
+	tcase_add_test(tc, test_uinput_aggregator);
+	tcase_add_test(tc, test_uinput_aggregator_syn_dropped);
+	tcase_add_test(tc, test_uinput_splitter);
 	suite_add_tcase(s, tc);
 
 	tc = tcase_create("device properties");
@@ -0,0 +1,436 @@
+/*
+ * Copyright © 2026 The libevdev contributors
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of Red Hat
+ * not be used in advertising or publicity pertaining to distribution
+ * of the software without specific, written prior permission.  Red
+ * Hat makes no representations about the suitability of this software
+ * for any purpose.  It is provided "as is" without express or implied
+ * warranty.
+ *
+ * THE AUTHORS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN
+ * NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Measures the latency from writing a frame to a uinput device to
+ * reading its SYN_REPORT with libevdev_next_event() from the device's
+ * event node. The reader's timestamps use CLOCK_MONOTONIC, so the time
+ * from the kernel's timestamp to the read is measured too.
+ *
+ * The read modes:
+ * - blocking: a blocking fd, libevdev_next_event() waits for the event
+ * - poll: a non-blocking fd, poll() waits until it is readable
+ * - batch: like poll, but several frames are written with one write()
+ *   and the latency of each is measured from that write()
+ */
+
+#define _GNU_SOURCE
+#include <config.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <poll.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/input.h>
+
+#include "libevdev.h"
+#include "libevdev-uinput.h"
+
+enum mode {
+	MODE_BLOCKING,
+	MODE_POLL,
+	MODE_BATCH,
+	MODE_CNT,
+};
+
+static const char *mode_names[MODE_CNT] = {
+	[MODE_BLOCKING] = "blocking",
+	[MODE_POLL] = "poll",
+	[MODE_BATCH] = "batch",
+};
+
+struct sample {
+	uint64_t write_to_read; /**< ns from before the write() */
+	uint64_t kernel_to_read; /**< ns from the event's timestamp */
+};
+
+struct options {
+	unsigned int count;
+	unsigned int batch;
+	unsigned int interval; /**< us between writes */
+	bool csv;
+};
+
+static void
+usage(void)
+{
+	printf("Usage: %s [options] [blocking|poll|batch ...]\n"
+	       "\n"
+	       "Measures the latency from writing a frame to a uinput device to\n"
+	       "reading it with libevdev_next_event(), for each of the given read\n"
+	       "modes, or all if none is given.\n"
+	       "\n"
+	       "Options:\n"
+	       "  --count <n>     frames to measure per mode, default: 10000\n"
+	       "  --batch <n>     frames per write() in batch mode, default: 16\n"
+	       "  --interval <us> time between writes, default: 1000\n"
+	       "  --csv           print every sample as CSV instead of percentiles\n",
+	       program_invocation_short_name);
+}
+
+static uint64_t
+now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static uint64_t
+event_time(const struct input_event *ev)
+{
+	return (uint64_t)ev->input_event_sec * 1000000000 +
+	       (uint64_t)ev->input_event_usec * 1000;
+}
+
+static int
+cmp_u64(const void *a, const void *b)
+{
+	uint64_t ua = *(const uint64_t *)a, ub = *(const uint64_t *)b;
+
+	return ua < ub ? -1 : ua > ub;
+}
+
+static bool
+parse_uint(const char *str, unsigned int *val)
+{
+	char *endptr;
+	unsigned long v;
+
+	errno = 0;
+	v = strtoul(str, &endptr, 10);
+	if (errno != 0 || str == endptr || *endptr != '\0' || v > UINT_MAX ||
+	    *str == '-')
+		return false;
+
+	*val = v;
+	return true;
+}
+
+/**
+ * Read until the next SYN_REPORT, waiting with poll() on a non-blocking
+ * fd. Returns the SYN_REPORT in ev.
+ */
+static int
+read_frame(struct libevdev *dev, bool blocking, struct input_event *ev)
+{
+	struct pollfd fds = { libevdev_get_fd(dev), POLLIN, 0 };
+	unsigned int flags = LIBEVDEV_READ_FLAG_NORMAL;
+	int rc;
+
+	/* without this flag, libevdev reads before returning the events it
+	   already has, which blocks on a blocking fd */
+	if (blocking)
+		flags |= LIBEVDEV_READ_FLAG_BLOCKING;
+
+	while (true) {
+		rc = libevdev_next_event(dev, flags, ev);
+		if (rc == -EAGAIN && !blocking) {
+			if (poll(&fds, 1, 1000) <= 0)
+				return -ETIMEDOUT;
+			continue;
+		} else if (rc < 0) {
+			return rc;
+		} else if (rc == LIBEVDEV_READ_STATUS_SYNC) {
+			/* a SYN_DROPPED means the tool can't keep up */
+			return -EOVERFLOW;
+		}
+
+		if (ev->type == EV_SYN && ev->code == SYN_REPORT)
+			return 0;
+	}
+}
+
+static int
+measure(struct libevdev_uinput *uidev, struct libevdev *dev, enum mode mode,
+	const struct options *opts, struct sample *samples)
+{
+	unsigned int batch = mode == MODE_BATCH ? opts->batch : 1;
+	struct input_event *events;
+	int flags, rc = 0;
+	unsigned int i, n;
+
+	flags = fcntl(libevdev_get_fd(dev), F_GETFL);
+	if (mode == MODE_BLOCKING)
+		flags &= ~O_NONBLOCK;
+	else
+		flags |= O_NONBLOCK;
+	if (fcntl(libevdev_get_fd(dev), F_SETFL, flags) < 0)
+		return -errno;
+
+	events = calloc(batch * 2, sizeof(*events));
+	if (!events)
+		return -ENOMEM;
+
+	for (i = 0; i < opts->count && rc == 0; i += batch) {
+		unsigned int nframes = batch;
+		uint64_t written;
+
+		if (nframes > opts->count - i)
+			nframes = opts->count - i;
+
+		/* any nonzero motion gets through the kernel, alternate
+		   the direction so the pointer doesn't drift away */
+		for (n = 0; n < nframes; n++) {
+			events[n * 2].type = EV_REL;
+			events[n * 2].code = REL_X;
+			events[n * 2].value = (i + n) % 2 ? 1 : -1;
+			events[n * 2 + 1].type = EV_SYN;
+			events[n * 2 + 1].code = SYN_REPORT;
+			events[n * 2 + 1].value = 0;
+		}
+
+		if (opts->interval)
+			usleep(opts->interval);
+
+		written = now();
+		rc = libevdev_uinput_write_events(uidev, events, nframes * 2);
+
+		for (n = 0; n < nframes && rc == 0; n++) {
+			struct input_event ev;
+			uint64_t read;
+
+			rc = read_frame(dev, mode == MODE_BLOCKING, &ev);
+			read = now();
+			samples[i + n].write_to_read = read - written;
+			samples[i + n].kernel_to_read = read - event_time(&ev);
+		}
+	}
+
+	free(events);
+
+	return rc;
+}
+
+static void
+print_percentiles(const char *mode, const char *what, uint64_t *values,
+		  unsigned int n)
+{
+	static const double percentiles[] = { 50, 90, 99, 99.9 };
+	unsigned int i;
+
+	qsort(values, n, sizeof(*values), cmp_u64);
+
+	printf("%-8s %-15s", mode, what);
+	for (i = 0; i < sizeof(percentiles)/sizeof(percentiles[0]); i++) {
+		unsigned int idx = (unsigned int)(n * percentiles[i] / 100);
+
+		if (idx >= n)
+			idx = n - 1;
+		printf(" %8.1f", values[idx] / 1000.0);
+	}
+	printf(" %8.1f\n", values[n - 1] / 1000.0);
+}
+
+static void
+print_results(enum mode mode, const struct sample *samples,
+	      const struct options *opts)
+{
+	uint64_t *values;
+	unsigned int i;
+
+	if (opts->csv) {
+		for (i = 0; i < opts->count; i++)
+			printf("%s,%u,%" PRIu64 ",%" PRIu64 "\n",
+			       mode_names[mode], i,
+			       samples[i].write_to_read,
+			       samples[i].kernel_to_read);
+		return;
+	}
+
+	values = calloc(opts->count, sizeof(*values));
+	if (!values)
+		return;
+
+	for (i = 0; i < opts->count; i++)
+		values[i] = samples[i].write_to_read;
+	print_percentiles(mode_names[mode], "write to read", values, opts->count);
+
+	for (i = 0; i < opts->count; i++)
+		values[i] = samples[i].kernel_to_read;
+	print_percentiles(mode_names[mode], "kernel to read", values, opts->count);
+
+	free(values);
+}
+
+int
+main(int argc, char **argv)
+{
+	struct options opts = {
+		.count = 10000,
+		.batch = 16,
+		.interval = 1000,
+		.csv = false,
+	};
+	bool modes[MODE_CNT] = { false };
+	bool any_mode = false;
+	struct libevdev *template, *dev = NULL;
+	struct libevdev_uinput *uidev = NULL;
+	const char *devnode;
+	struct sample *samples = NULL;
+	enum mode mode;
+	int fd = -1, rc = 1;
+
+	while (1) {
+		enum { OPT_COUNT, OPT_BATCH, OPT_INTERVAL, OPT_CSV, OPT_HELP };
+		static const struct option options[] = {
+			{ "count", 1, 0, OPT_COUNT },
+			{ "batch", 1, 0, OPT_BATCH },
+			{ "interval", 1, 0, OPT_INTERVAL },
+			{ "csv", 0, 0, OPT_CSV },
+			{ "help", 0, 0, OPT_HELP },
+			{ NULL, 0, 0, 0 },
+		};
+		bool valid = true;
+		int c;
+
+		c = getopt_long(argc, argv, "h", options, NULL);
+		if (c == -1)
+			break;
+
+		switch (c) {
+		case OPT_COUNT:
+			valid = parse_uint(optarg, &opts.count) && opts.count > 0;
+			break;
+		case OPT_BATCH:
+			valid = parse_uint(optarg, &opts.batch) && opts.batch > 0;
+			break;
+		case OPT_INTERVAL:
+			valid = parse_uint(optarg, &opts.interval);
+			break;
+		case OPT_CSV:
+			opts.csv = true;
+			break;
+		case 'h':
+		case OPT_HELP:
+			usage();
+			return 0;
+		default:
+			valid = false;
+			break;
+		}
+
+		if (!valid) {
+			usage();
+			return 1;
+		}
+	}
+
+	for (; optind < argc; optind++) {
+		for (mode = 0; mode < MODE_CNT; mode++) {
+			if (strcmp(argv[optind], mode_names[mode]) == 0)
+				break;
+		}
+		if (mode == MODE_CNT) {
+			usage();
+			return 1;
+		}
+		modes[mode] = true;
+		any_mode = true;
+	}
+
+	template = libevdev_new();
+	if (!template)
+		return 1;
+	libevdev_set_name(template, "libevdev latency test device");
+	libevdev_enable_event_code(template, EV_REL, REL_X, NULL);
+	libevdev_enable_event_code(template, EV_REL, REL_Y, NULL);
+	libevdev_enable_event_code(template, EV_KEY, BTN_LEFT, NULL);
+
+	rc = libevdev_uinput_create_from_device(template,
+						LIBEVDEV_UINPUT_OPEN_MANAGED,
+						&uidev);
+	libevdev_free(template);
+	if (rc < 0) {
+		fprintf(stderr, "Failed to create uinput device: %s\n",
+			strerror(-rc));
+		return 1;
+	}
+
+	rc = 1;
+	devnode = libevdev_uinput_get_devnode(uidev);
+	if (!devnode) {
+		fprintf(stderr, "Failed to find the uinput device node\n");
+		goto out;
+	}
+
+	fd = open(devnode, O_RDONLY);
+	if (fd < 0) {
+		fprintf(stderr, "Failed to open %s: %s\n",
+			devnode, strerror(errno));
+		goto out;
+	}
+
+	if (libevdev_new_from_fd(fd, &dev) < 0 ||
+	    libevdev_set_clock_id(dev, CLOCK_MONOTONIC) < 0) {
+		fprintf(stderr, "Failed to initialize the device\n");
+		goto out;
+	}
+
+	samples = calloc(opts.count, sizeof(*samples));
+	if (!samples)
+		goto out;
+
+	if (opts.csv)
+		printf("mode,sample,write_to_read_ns,kernel_to_read_ns\n");
+	else
+		printf("%u frames per mode, latency in us\n"
+		       "%-8s %-15s %8s %8s %8s %8s %8s\n",
+		       opts.count, "mode", "", "50%", "90%", "99%", "99.9%", "max");
+
+	for (mode = 0; mode < MODE_CNT; mode++) {
+		int err;
+
+		if (any_mode && !modes[mode])
+			continue;
+
+		err = measure(uidev, dev, mode, &opts, samples);
+		if (err < 0) {
+			fprintf(stderr, "Failed to measure %s mode: %s\n",
+				mode_names[mode], strerror(-err));
+			goto out;
+		}
+
+		print_results(mode, samples, &opts);
+	}
+
+	rc = 0;
+
+out:
+	free(samples);
+	libevdev_free(dev);
+	if (fd != -1)
+		close(fd);
+	libevdev_uinput_destroy(uidev);
+
+	return rc;
+}
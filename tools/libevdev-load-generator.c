@@ -0,0 +1,568 @@
+/*
+ * Copyright © 2026 The libevdev contributors
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of Red Hat
+ * not be used in advertising or publicity pertaining to distribution
+ * of the software without specific, written prior permission.  Red
+ * Hat makes no representations about the suitability of this software
+ * for any purpose.  It is provided "as is" without express or implied
+ * warranty.
+ *
+ * THE AUTHORS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS SOFTWARE,
+ * INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS, IN
+ * NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY SPECIAL, INDIRECT OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS
+ * OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Creates uinput devices and posts events on them at a fixed rate, to
+ * put a controlled load on the input stack. The events are derived from
+ * the device's capabilities: each frame moves every relative and
+ * absolute axis and every touch, and presses or releases one key.
+ */
+
+#define _GNU_SOURCE
+#include <config.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/input.h>
+
+#include "libevdev.h"
+#include "libevdev-uinput.h"
+
+#define max(a, b) (((a) > (b)) ? (a) : (b))
+
+/* frames before an axis is back at its start */
+#define AXIS_STEPS 256
+
+struct profile {
+	const char *name;
+	const char *description;
+	unsigned int rate; /**< frames per second */
+	void (*setup)(struct libevdev *dev);
+};
+
+struct generator {
+	struct libevdev *dev;
+	unsigned int nslots;
+	unsigned int keys[KEY_CNT]; /**< the keys that are toggled */
+	unsigned int nkeys;
+	unsigned int next_key;
+	bool key_down;
+	unsigned int key_interval; /**< frames between key events */
+	uint64_t frame;
+};
+
+static volatile sig_atomic_t stop;
+
+static void
+enable_abs(struct libevdev *dev, unsigned int code, int min, int max, int res)
+{
+	struct input_absinfo abs = {
+		.minimum = min,
+		.maximum = max,
+		.resolution = res,
+	};
+
+	libevdev_enable_event_code(dev, EV_ABS, code, &abs);
+}
+
+static void
+setup_keyboard(struct libevdev *dev)
+{
+	unsigned int code;
+	int delay = 500, period = 33;
+
+	libevdev_set_id_bustype(dev, BUS_USB);
+	for (code = KEY_ESC; code <= KEY_MICMUTE; code++)
+		libevdev_enable_event_code(dev, EV_KEY, code, NULL);
+	libevdev_enable_event_code(dev, EV_MSC, MSC_SCAN, NULL);
+	libevdev_enable_event_code(dev, EV_LED, LED_NUML, NULL);
+	libevdev_enable_event_code(dev, EV_LED, LED_CAPSL, NULL);
+	libevdev_enable_event_code(dev, EV_LED, LED_SCROLLL, NULL);
+	libevdev_enable_event_code(dev, EV_REP, REP_DELAY, &delay);
+	libevdev_enable_event_code(dev, EV_REP, REP_PERIOD, &period);
+}
+
+static void
+setup_mouse(struct libevdev *dev)
+{
+	libevdev_set_id_bustype(dev, BUS_USB);
+	libevdev_enable_event_code(dev, EV_REL, REL_X, NULL);
+	libevdev_enable_event_code(dev, EV_REL, REL_Y, NULL);
+	libevdev_enable_event_code(dev, EV_REL, REL_WHEEL, NULL);
+	libevdev_enable_event_code(dev, EV_KEY, BTN_LEFT, NULL);
+	libevdev_enable_event_code(dev, EV_KEY, BTN_RIGHT, NULL);
+	libevdev_enable_event_code(dev, EV_KEY, BTN_MIDDLE, NULL);
+}
+
+static void
+setup_touchscreen(struct libevdev *dev)
+{
+	libevdev_set_id_bustype(dev, BUS_I2C);
+	libevdev_enable_property(dev, INPUT_PROP_DIRECT);
+	libevdev_enable_event_code(dev, EV_KEY, BTN_TOUCH, NULL);
+	enable_abs(dev, ABS_X, 0, 4095, 16);
+	enable_abs(dev, ABS_Y, 0, 4095, 16);
+	enable_abs(dev, ABS_MT_SLOT, 0, 9, 0);
+	enable_abs(dev, ABS_MT_TRACKING_ID, 0, 65535, 0);
+	enable_abs(dev, ABS_MT_POSITION_X, 0, 4095, 16);
+	enable_abs(dev, ABS_MT_POSITION_Y, 0, 4095, 16);
+}
+
+static void
+setup_gamepad(struct libevdev *dev)
+{
+	unsigned int code;
+
+	libevdev_set_id_bustype(dev, BUS_USB);
+	for (code = BTN_SOUTH; code <= BTN_THUMBR; code++)
+		libevdev_enable_event_code(dev, EV_KEY, code, NULL);
+	enable_abs(dev, ABS_X, -32768, 32767, 0);
+	enable_abs(dev, ABS_Y, -32768, 32767, 0);
+	enable_abs(dev, ABS_RX, -32768, 32767, 0);
+	enable_abs(dev, ABS_RY, -32768, 32767, 0);
+	enable_abs(dev, ABS_Z, 0, 255, 0);
+	enable_abs(dev, ABS_RZ, 0, 255, 0);
+	enable_abs(dev, ABS_HAT0X, -1, 1, 0);
+	enable_abs(dev, ABS_HAT0Y, -1, 1, 0);
+}
+
+static const struct profile profiles[] = {
+	{ "keyboard", "a full keyboard, one key event per frame", 1000, setup_keyboard },
+	{ "mouse", "a 1 kHz mouse with a wheel", 1000, setup_mouse },
+	{ "touchscreen", "a touchscreen with 10 moving touches", 120, setup_touchscreen },
+	{ "gamepad", "a gamepad with two sticks, triggers and a hat", 250, setup_gamepad },
+};
+
+static void
+usage(void)
+{
+	unsigned int i;
+
+	printf("Usage: %s [options]\n"
+	       "\n"
+	       "Creates uinput devices and posts events on them at a fixed rate.\n"
+	       "\n"
+	       "Options:\n"
+	       "  --profile <name>      the device to create, default: mouse\n"
+	       "  --description <file>  create the device from a description written\n"
+	       "                        by libevdev_serialize_description() instead\n"
+	       "  --devices <n>         the number of devices, default: 1\n"
+	       "  --rate <n>            frames per second and device, 0 for as fast as\n"
+	       "                        possible, default: the profile's rate or 1000\n"
+	       "  --batch <n>           frames per write(), default: 1\n"
+	       "  --duration <s>        seconds to run, default: until interrupted\n"
+	       "\n"
+	       "Profiles:\n",
+	       program_invocation_short_name);
+	for (i = 0; i < sizeof(profiles)/sizeof(profiles[0]); i++)
+		printf("  %-12s %s, %u Hz\n", profiles[i].name,
+		       profiles[i].description, profiles[i].rate);
+}
+
+static uint64_t
+now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void
+sleep_until(uint64_t ns)
+{
+	struct timespec ts = {
+		.tv_sec = ns / 1000000000,
+		.tv_nsec = ns % 1000000000,
+	};
+
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR &&
+	       !stop)
+		;
+}
+
+static void
+handle_signal(int sig)
+{
+	stop = 1;
+}
+
+static struct libevdev *
+device_from_file(const char *path)
+{
+	struct libevdev *dev = NULL;
+	char *data = NULL;
+	size_t len = 0, size = 0;
+	ssize_t n;
+	int fd, rc;
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		fprintf(stderr, "Failed to open %s: %s\n", path, strerror(errno));
+		return NULL;
+	}
+
+	do {
+		if (len == size) {
+			size = max(size * 2, 4096);
+			data = realloc(data, size);
+			if (!data)
+				abort();
+		}
+		n = read(fd, data + len, size - len);
+		if (n > 0)
+			len += n;
+	} while (n > 0);
+	close(fd);
+
+	rc = libevdev_new_from_description(data, len, &dev);
+	if (rc < 0) {
+		fprintf(stderr, "Invalid description in %s: %s\n", path,
+			strerror(-rc));
+		dev = NULL;
+	}
+	free(data);
+
+	return dev;
+}
+
+static void
+generator_init(struct generator *gen, struct libevdev *dev)
+{
+	unsigned int code;
+	bool has_axes;
+
+	memset(gen, 0, sizeof(*gen));
+	gen->dev = dev;
+	/* the built-in profiles aren't kernel devices, they have no slots
+	   allocated */
+	if (libevdev_has_event_code(dev, EV_ABS, ABS_MT_SLOT))
+		gen->nslots = libevdev_get_abs_maximum(dev, ABS_MT_SLOT) + 1;
+
+	/* BTN_TOUCH and the tools follow the touches, not the pattern */
+	for (code = 0; code <= KEY_MAX; code++) {
+		if (code >= BTN_DIGI && code < BTN_WHEEL)
+			continue;
+		if (libevdev_has_event_code(dev, EV_KEY, code))
+			gen->keys[gen->nkeys++] = code;
+	}
+
+	has_axes = libevdev_has_event_type(dev, EV_REL) ||
+		   libevdev_has_event_type(dev, EV_ABS);
+	gen->key_interval = has_axes ? 100 : 1;
+}
+
+/**
+ * The largest number of events generate_frame() adds
+ */
+static unsigned int
+max_frame_size(const struct generator *gen)
+{
+	/* slot, tracking ID and position per touch, BTN_TOUCH, one key
+	   event with its scancode and the SYN_REPORT */
+	return REL_CNT + ABS_CNT + gen->nslots * 4 + 4;
+}
+
+static struct input_event *
+add_event(struct input_event *ev, unsigned int type, unsigned int code, int value)
+{
+	ev->type = type;
+	ev->code = code;
+	ev->value = value;
+
+	return ev + 1;
+}
+
+/**
+ * A value moving back and forth between the axis' minimum and maximum
+ */
+static int
+axis_value(const struct input_absinfo *abs, uint64_t frame, unsigned int phase)
+{
+	int64_t range = (int64_t)abs->maximum - abs->minimum;
+	int64_t step = max(range / AXIS_STEPS, 1);
+	int64_t pos = (int64_t)((frame * step + phase * range / 10) % (2 * range));
+
+	return pos <= range ? abs->minimum + pos : abs->maximum - (pos - range);
+}
+
+static bool
+is_mt_axis(unsigned int code)
+{
+	return code >= ABS_MT_SLOT && code <= ABS_MT_TOOL_Y;
+}
+
+static struct input_event *
+generate_frame(struct generator *gen, struct input_event *ev)
+{
+	struct libevdev *dev = gen->dev;
+	uint64_t frame = gen->frame++;
+	unsigned int code, slot;
+
+	for (code = 0; code <= REL_MAX; code++) {
+		if (libevdev_has_event_code(dev, EV_REL, code))
+			ev = add_event(ev, EV_REL, code, frame % 2 ? 1 : -1);
+	}
+
+	for (code = 0; code <= ABS_MAX; code++) {
+		const struct input_absinfo *abs = libevdev_get_abs_info(dev, code);
+
+		if (abs && !is_mt_axis(code) && abs->maximum > abs->minimum)
+			ev = add_event(ev, EV_ABS, code, axis_value(abs, frame, code));
+	}
+
+	for (slot = 0; slot < gen->nslots; slot++) {
+		ev = add_event(ev, EV_ABS, ABS_MT_SLOT, slot);
+		/* the touches start with the first frame and never end */
+		if (frame == 0)
+			ev = add_event(ev, EV_ABS, ABS_MT_TRACKING_ID, slot);
+		for (code = ABS_MT_POSITION_X; code <= ABS_MT_POSITION_Y; code++) {
+			const struct input_absinfo *abs = libevdev_get_abs_info(dev, code);
+
+			if (abs && abs->maximum > abs->minimum)
+				ev = add_event(ev, EV_ABS, code,
+					       axis_value(abs, frame, slot));
+		}
+	}
+	if (frame == 0 && gen->nslots > 0 &&
+	    libevdev_has_event_code(dev, EV_KEY, BTN_TOUCH))
+		ev = add_event(ev, EV_KEY, BTN_TOUCH, 1);
+
+	/* press a key, release it, then on to the next one */
+	if (gen->nkeys > 0 && frame % gen->key_interval == 0) {
+		code = gen->keys[gen->next_key];
+		if (libevdev_has_event_code(dev, EV_MSC, MSC_SCAN))
+			ev = add_event(ev, EV_MSC, MSC_SCAN, code);
+		gen->key_down = !gen->key_down;
+		ev = add_event(ev, EV_KEY, code, gen->key_down);
+		if (!gen->key_down)
+			gen->next_key = (gen->next_key + 1) % gen->nkeys;
+	}
+
+	return add_event(ev, EV_SYN, SYN_REPORT, 0);
+}
+
+static bool
+parse_uint(const char *str, unsigned int *val)
+{
+	char *endptr;
+	unsigned long v;
+
+	errno = 0;
+	v = strtoul(str, &endptr, 10);
+	if (errno != 0 || str == endptr || *endptr != '\0' || v > UINT_MAX ||
+	    *str == '-')
+		return false;
+
+	*val = v;
+	return true;
+}
+
+int
+main(int argc, char **argv)
+{
+	const struct profile *profile = &profiles[1];
+	const char *description = NULL;
+	unsigned int ndevices = 1, rate = 0, batch = 1, duration = 0;
+	bool rate_set = false;
+	struct libevdev *dev;
+	const struct libevdev **templates;
+	struct libevdev_uinput **uidevs;
+	struct generator gen;
+	struct input_event *events;
+	uint64_t start, interval_start, period, nevents = 0, nframes = 0,
+		 interval_events = 0;
+	unsigned int i;
+	int rc = 1;
+
+	while (1) {
+		enum { OPT_PROFILE, OPT_DESCRIPTION, OPT_DEVICES, OPT_RATE,
+		       OPT_BATCH, OPT_DURATION, OPT_HELP };
+		static const struct option opts[] = {
+			{ "profile", 1, 0, OPT_PROFILE },
+			{ "description", 1, 0, OPT_DESCRIPTION },
+			{ "devices", 1, 0, OPT_DEVICES },
+			{ "rate", 1, 0, OPT_RATE },
+			{ "batch", 1, 0, OPT_BATCH },
+			{ "duration", 1, 0, OPT_DURATION },
+			{ "help", 0, 0, OPT_HELP },
+			{ NULL, 0, 0, 0 },
+		};
+		bool valid = true;
+		int c;
+
+		c = getopt_long(argc, argv, "h", opts, NULL);
+		if (c == -1)
+			break;
+
+		switch (c) {
+		case OPT_PROFILE:
+			profile = NULL;
+			for (i = 0; i < sizeof(profiles)/sizeof(profiles[0]); i++) {
+				if (strcmp(optarg, profiles[i].name) == 0)
+					profile = &profiles[i];
+			}
+			valid = profile != NULL;
+			break;
+		case OPT_DESCRIPTION:
+			description = optarg;
+			break;
+		case OPT_DEVICES:
+			valid = parse_uint(optarg, &ndevices) && ndevices > 0;
+			break;
+		case OPT_RATE:
+			valid = parse_uint(optarg, &rate);
+			rate_set = true;
+			break;
+		case OPT_BATCH:
+			valid = parse_uint(optarg, &batch) && batch > 0;
+			break;
+		case OPT_DURATION:
+			valid = parse_uint(optarg, &duration);
+			break;
+		case 'h':
+		case OPT_HELP:
+			usage();
+			return 0;
+		default:
+			valid = false;
+			break;
+		}
+
+		if (!valid) {
+			usage();
+			return 1;
+		}
+	}
+
+	if (optind < argc) {
+		usage();
+		return 1;
+	}
+
+	if (description) {
+		dev = device_from_file(description);
+		if (!dev)
+			return 1;
+		if (!rate_set)
+			rate = 1000;
+	} else {
+		dev = libevdev_new();
+		if (!dev)
+			return 1;
+		libevdev_set_name(dev, "libevdev load generator");
+		profile->setup(dev);
+		if (!rate_set)
+			rate = profile->rate;
+	}
+
+	templates = calloc(ndevices, sizeof(*templates));
+	uidevs = calloc(ndevices, sizeof(*uidevs));
+	generator_init(&gen, dev);
+	events = calloc(batch * max_frame_size(&gen), sizeof(*events));
+	if (!templates || !uidevs || !events)
+		goto out;
+
+	for (i = 0; i < ndevices; i++)
+		templates[i] = dev;
+
+	rc = libevdev_uinput_create_from_devices(templates, ndevices, uidevs);
+	if (rc < 0) {
+		fprintf(stderr, "Failed to create uinput devices: %s\n",
+			strerror(-rc));
+		rc = 1;
+		goto out;
+	}
+
+	printf("%u device%s, %u frames/s", ndevices, ndevices > 1 ? "s" : "",
+	       rate);
+	if (rate == 0)
+		printf(" (unlimited)");
+	printf(", %u frame%s per write\n", batch, batch > 1 ? "s" : "");
+	for (i = 0; i < ndevices; i++) {
+		const char *devnode = libevdev_uinput_get_devnode(uidevs[i]);
+
+		printf("  %s\n", devnode ? devnode : "(device node not found)");
+	}
+
+	signal(SIGINT, handle_signal);
+	signal(SIGTERM, handle_signal);
+
+	period = rate ? 1000000000 / rate : 0;
+	start = now();
+	interval_start = start;
+
+	while (!stop) {
+		struct input_event *end = events;
+		uint64_t t;
+		unsigned int n;
+
+		if (period)
+			sleep_until(start + nframes * period);
+
+		for (n = 0; n < batch; n++)
+			end = generate_frame(&gen, end);
+
+		for (i = 0; i < ndevices; i++) {
+			rc = libevdev_uinput_write_events(uidevs[i], events,
+							  end - events);
+			if (rc < 0) {
+				fprintf(stderr, "Failed to write events: %s\n",
+					strerror(-rc));
+				stop = 1;
+				break;
+			}
+		}
+
+		nframes += batch;
+		nevents += (end - events) * ndevices;
+		interval_events += (end - events) * ndevices;
+
+		t = now();
+		if (t - interval_start >= 1000000000) {
+			printf("%.0f events/s\n",
+			       interval_events * 1e9 / (t - interval_start));
+			fflush(stdout);
+			interval_start = t;
+			interval_events = 0;
+		}
+
+		if (duration && t - start >= (uint64_t)duration * 1000000000)
+			break;
+	}
+
+	printf("%" PRIu64 " events in %" PRIu64 " frames per device, %.0f events/s\n",
+	       nevents, nframes, nevents * 1e9 / (now() - start));
+	/* a failed write ends the loop with rc set */
+	rc = rc < 0 ? 1 : 0;
+
+	for (i = 0; i < ndevices; i++)
+		libevdev_uinput_destroy(uidevs[i]);
+out:
+	free(events);
+	free(uidevs);
+	free(templates);
+	libevdev_free(dev);
+
+	return rc;
+}